@@ -31,6 +31,7 @@
 #include "array.h"
 
 #include "core/hashfuncs.h"
+#include "core/math/random_source.h"
 #include "core/object.h"
 #include "core/variant.h"
 #include "core/vector.h"
@@ -326,18 +327,57 @@ Array &Array::sort_custom(Object *p_obj, const StringName &p_function) {
 	return *this;
 }
 
-void Array::shuffle() {
+template <class R>
+static Array _sample(const Vector<Variant> &p_array, int p_count, R &p_rand) {
+	const int n = p_array.size();
+	Array result;
+	ERR_FAIL_COND_V_MSG(p_count < 0 || p_count > n, result, "Sample size must be between 0 and the array size.");
+	result.resize(p_count);
+	if (p_count == 0) {
+		return result;
+	}
+	Variant *dst = &result[0];
+	if (p_count * 4 >= n) {
+		// Dense sample: partially shuffle the indices, copying only the picked elements.
+		Vector<int> indices;
+		indices.resize(n);
+		int *w = indices.ptrw();
+		for (int i = 0; i < n; i++) {
+			w[i] = i;
+		}
+		Random::partial_shuffle(p_rand, w, n, p_count);
+		for (int i = 0; i < p_count; i++) {
+			dst[i] = p_array[w[i]];
+		}
+	} else {
+		Random::reservoir_sample(p_rand, p_array.ptr(), n, dst, p_count);
+		Random::shuffle(p_rand, dst, p_count);
+	}
+	return result;
+}
+
+void Array::shuffle(RandomNumberGenerator *p_rng) {
 	const int n = _p->array.size();
 	if (n < 2) {
 		return;
 	}
 	Variant *data = _p->array.ptrw();
-	for (int i = n - 1; i >= 1; i--) {
-		const int j = Math::rand() % (i + 1);
-		const Variant tmp = data[j];
-		data[j] = data[i];
-		data[i] = tmp;
+	if (p_rng) {
+		RandomSourceRNG source = { p_rng };
+		Random::shuffle(source, data, n);
+	} else {
+		RandomSourceGlobal source;
+		Random::shuffle(source, data, n);
+	}
+}
+
+Array Array::sample(int p_count, RandomNumberGenerator *p_rng) const {
+	if (p_rng) {
+		RandomSourceRNG source = { p_rng };
+		return _sample(_p->array, p_count, source);
 	}
+	RandomSourceGlobal source;
+	return _sample(_p->array, p_count, source);
 }
 
 template <typename Less>
@@ -36,6 +36,7 @@
 class Variant;
 class ArrayPrivate;
 class Object;
+class RandomNumberGenerator;
 class StringName;
 
 class Array {
@@ -76,7 +77,8 @@ public:
 
 	Array &sort();
 	Array &sort_custom(Object *p_obj, const StringName &p_function);
-	void shuffle();
+	void shuffle(RandomNumberGenerator *p_rng = nullptr); // The global generator when p_rng is null.
+	Array sample(int p_count, RandomNumberGenerator *p_rng = nullptr) const;
 	int bsearch(const Variant &p_value, bool p_before = true);
 	int bsearch_custom(const Variant &p_value, Object *p_obj, const StringName &p_function, bool p_before = true);
 	Array &invert();
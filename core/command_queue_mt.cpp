@@ -33,80 +33,95 @@
 #include "core/os/os.h"
 #include "core/project_settings.h"
 
-void CommandQueueMT::lock() {
-	mutex.lock();
+void CommandQueueMT::notify_waiters(bool p_sync) {
+	if (waiters.load(std::memory_order_seq_cst) == 0) {
+		return;
+	}
+	if (!p_sync && !(stalled.load(std::memory_order_seq_cst) && _is_past(read_pos, stall_pos.load(std::memory_order_relaxed)))) {
+		return;
+	}
+#if !defined(NO_THREADS)
+	// Taking the mutex orders this against a waiter about to sleep.
+	wait_mutex.lock();
+	wait_mutex.unlock();
+	wait_condition.notify_all();
+#endif
 }
 
-void CommandQueueMT::unlock() {
-	mutex.unlock();
-}
+void CommandQueueMT::wait_for_position(uint32_t p_pos) {
+	for (int i = 0; i < WAIT_SPIN_COUNT; i++) {
+		if (_is_past(consumed.load(std::memory_order_acquire), p_pos)) {
+			return;
+		}
+	}
 
-void CommandQueueMT::wait_for_flush() {
-	// wait one millisecond for a flush to happen
-	OS::get_singleton()->delay_usec(1000);
+#if defined(NO_THREADS)
+	// Nobody else can run the commands.
+	flush_all();
+#else
+	std::unique_lock<std::mutex> lock(wait_mutex);
+	waiters.fetch_add(1, std::memory_order_seq_cst);
+	while (!_is_past(consumed.load(std::memory_order_seq_cst), p_pos)) {
+		wait_condition.wait(lock);
+	}
+	waiters.fetch_sub(1, std::memory_order_relaxed);
+#endif
 }
 
-CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
-	int idx = -1;
-
-	while (true) {
-		lock();
-		for (int i = 0; i < SYNC_SEMAPHORES; i++) {
-			if (!sync_sems[i].in_use) {
-				sync_sems[i].in_use = true;
-				idx = i;
-				break;
-			}
-		}
-		unlock();
-
-		if (idx == -1) {
-			wait_for_flush();
-		} else {
-			break;
-		}
+void CommandQueueMT::wait_for_sync(uint32_t p_pos) {
+	sync_count.increment();
+	if (_is_past(consumed.load(std::memory_order_acquire), p_pos)) {
+		return;
 	}
 
-	return &sync_sems[idx];
+	const uint64_t from = OS::get_singleton()->get_ticks_usec();
+	wait_for_position(p_pos);
+	stall_usec.add(OS::get_singleton()->get_ticks_usec() - from);
 }
 
-bool CommandQueueMT::dealloc_one() {
-tryagain:
-	if (dealloc_ptr == (write_ptr_and_epoch >> 1)) {
-		// The queue is empty
-		return false;
-	}
+void CommandQueueMT::wait_for_space(uint32_t p_pos) {
+	const uint64_t from = OS::get_singleton()->get_ticks_usec();
 
-	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
+	stall_pos.store(p_pos, std::memory_order_relaxed);
+	stalled.store(true, std::memory_order_seq_cst);
+	wake_consumer();
+	wait_for_position(p_pos);
+	stalled.store(false, std::memory_order_relaxed);
 
-	if (size == 0) {
-		// End of command buffer wrap down
-		dealloc_ptr = 0;
-		goto tryagain;
-	}
+	stall_usec.add(OS::get_singleton()->get_ticks_usec() - from);
+}
 
-	if (size & 1) {
-		// Still used, nothing can be deallocated
-		return false;
+void CommandQueueMT::wait_and_flush_one() {
+	ERR_FAIL_COND(!sync);
+
+	if (!flush_one()) {
+		consumer_sleeping.store(true, std::memory_order_seq_cst);
+		if (read_pos == published.load(std::memory_order_seq_cst)) {
+			// A producer clears the flag and posts once it publishes something.
+			sync->wait();
+		}
+		consumer_sleeping.store(false, std::memory_order_relaxed);
 	}
 
-	dealloc_ptr += (size >> 1) + 8;
-	return true;
+	flush_all();
 }
 
 CommandQueueMT::CommandQueueMT(bool p_sync) {
-	read_ptr_and_epoch = 0;
-	write_ptr_and_epoch = 0;
-	dealloc_ptr = 0;
+	write_pos = 0;
+	read_pos = 0;
+	published.store(0);
+	consumed.store(0);
+	consumer_sleeping.store(false);
+	waiters.store(0);
+	stalled.store(false);
+	stall_pos.store(0);
 
 	command_mem_size = GLOBAL_DEF_RST("memory/limits/command_queue/multithreading_queue_size_kb", DEFAULT_COMMAND_MEM_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/command_queue/multithreading_queue_size_kb", PropertyInfo(Variant::INT, "memory/limits/command_queue/multithreading_queue_size_kb", PROPERTY_HINT_RANGE, "1,4096,1,or_greater"));
-	command_mem_size *= 1024;
+	// Positions are free running and wrap around the buffer with a mask.
+	command_mem_size = next_power_of_2(command_mem_size * 1024);
 	command_mem = (uint8_t *)memalloc(command_mem_size);
 
-	for (int i = 0; i < SYNC_SEMAPHORES; i++) {
-		sync_sems[i].in_use = false;
-	}
 	if (p_sync) {
 		sync = memnew(Semaphore);
 	} else {
@@ -34,9 +34,17 @@
 #include "core/os/memory.h"
 #include "core/os/mutex.h"
 #include "core/os/semaphore.h"
+#include "core/safe_refcount.h"
 #include "core/simple_type.h"
 #include "core/typedefs.h"
 
+#include <atomic>
+
+#if !defined(NO_THREADS)
+#include <condition_variable>
+#include <mutex>
+#endif
+
 #define COMMA(N) _COMMA_##N
 #define _COMMA_0
 #define _COMMA_1 ,
@@ -200,7 +208,7 @@
 
 #define DECL_CMD_RET(N)                                                         \
 	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R> \
-	struct CommandRet##N : public SyncCommand {                                 \
+	struct CommandRet##N : public CommandBase {                                 \
 		R *ret;                                                                 \
 		T *instance;                                                            \
 		M method;                                                               \
@@ -212,7 +220,7 @@
 
 #define DECL_CMD_SYNC(N)                                               \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)> \
-	struct CommandSync##N : public SyncCommand {                       \
+	struct CommandSync##N : public CommandBase {                       \
 		T *instance;                                                   \
 		M method;                                                      \
 		SEMIC_SEP_LIST(PARAM_DECL, N);                                 \
@@ -228,13 +236,12 @@
 #define DECL_PUSH(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>       \
 	void push(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
-		CMD_TYPE(N) *cmd = allocate_and_lock<CMD_TYPE(N)>();                 \
+		write_lock.lock();                                                   \
+		CMD_TYPE(N) *cmd = allocate<CMD_TYPE(N)>(false);                     \
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
-		if (sync)                                                            \
-			sync->post();                                                    \
+		publish_and_unlock();                                                \
 	}
 
 #define CMD_RET_TYPE(N) CommandRet##N<T, M, COMMA_SEP_LIST(TYPE_ARG, N) COMMA(N) R>
@@ -242,18 +249,13 @@
 #define DECL_PUSH_AND_RET(N)                                                                   \
 	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R>                \
 	void push_and_ret(T *p_instance, M p_method, COMMA_SEP_LIST(PARAM, N) COMMA(N) R *r_ret) { \
-		SyncSemaphore *ss = _alloc_sync_sem();                                                 \
-		CMD_RET_TYPE(N) *cmd = allocate_and_lock<CMD_RET_TYPE(N)>();                           \
+		write_lock.lock();                                                                     \
+		CMD_RET_TYPE(N) *cmd = allocate<CMD_RET_TYPE(N)>(true);                                \
 		cmd->instance = p_instance;                                                            \
 		cmd->method = p_method;                                                                \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
-		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
-		if (sync)                                                                              \
-			sync->post();                                                                      \
-		ss->sem.wait();                                                                        \
-		ss->in_use = false;                                                                    \
+		wait_for_sync(publish_and_unlock());                                                   \
 	}
 
 #define CMD_SYNC_TYPE(N) CommandSync##N<T, M COMMA(N) COMMA_SEP_LIST(TYPE_ARG, N)>
@@ -261,41 +263,35 @@
 #define DECL_PUSH_AND_SYNC(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>                \
 	void push_and_sync(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
-		SyncSemaphore *ss = _alloc_sync_sem();                                        \
-		CMD_SYNC_TYPE(N) *cmd = allocate_and_lock<CMD_SYNC_TYPE(N)>();                \
+		write_lock.lock();                                                            \
+		CMD_SYNC_TYPE(N) *cmd = allocate<CMD_SYNC_TYPE(N)>(true);                     \
 		cmd->instance = p_instance;                                                   \
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
-		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
-		if (sync)                                                                     \
-			sync->post();                                                             \
-		ss->sem.wait();                                                               \
-		ss->in_use = false;                                                           \
+		wait_for_sync(publish_and_unlock());                                          \
 	}
 
 #define MAX_CMD_PARAMS 13
 
+// Ring of commands executed in order by a single consumer thread.
+//
+// Producers and the consumer don't share a lock: producers publish the end
+// of what they wrote with a single atomic store and the consumer publishes
+// how far it has executed (and freed) the same way. Producers are serialized
+// among themselves by a mutex, which is never contended in the common case of
+// the main thread being the only one issuing calls. It is a blocking one since
+// a producer keeps it while waiting for the consumer to free space.
+//
+// The consumer is only woken up when it actually went to sleep, so a burst of
+// pushes costs at most one semaphore post. Commands that must be waited on
+// are flagged in their header; callers wait until the consumer has gone past
+// them instead of each grabbing a semaphore of its own.
 class CommandQueueMT {
-	struct SyncSemaphore {
-		Semaphore sem;
-		bool in_use;
-	};
-
 	struct CommandBase {
 		virtual void call() = 0;
-		virtual void post(){};
 		virtual ~CommandBase(){};
 	};
 
-	struct SyncCommand : public CommandBase {
-		SyncSemaphore *sync_sem;
-
-		virtual void post() {
-			sync_sem->sem.post();
-		}
-	};
-
 	DECL_CMD(0)
 	SPACE_SEP_LIST(DECL_CMD, 13)
 
@@ -311,153 +307,122 @@ class CommandQueueMT {
 
 	enum {
 		DEFAULT_COMMAND_MEM_SIZE_KB = 256,
-		SYNC_SEMAPHORES = 8
+		HEADER_SIZE = 8,
+		// Set in the header of commands someone waits on. Sizes are multiples of 8.
+		HEADER_SYNC_BIT = 1,
+		WAIT_SPIN_COUNT = 256,
 	};
 
 	uint8_t *command_mem;
-	uint32_t read_ptr_and_epoch;
-	uint32_t write_ptr_and_epoch;
-	uint32_t dealloc_ptr;
-	uint32_t command_mem_size;
-	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
-	Mutex mutex;
+	uint32_t command_mem_size; // Power of two, positions below wrap around it.
+
+	// Producer side, only touched with write_lock held.
+	Mutex write_lock;
+	uint32_t write_pos;
+
+	// Consumer side, only touched by the thread flushing.
+	uint32_t read_pos;
+
+	std::atomic<uint32_t> published;
+	std::atomic<uint32_t> consumed;
+
 	Semaphore *sync;
+	std::atomic<bool> consumer_sleeping;
+
+	// Callers waiting for the consumer to go past a position.
+	std::atomic<uint32_t> waiters;
+	std::atomic<bool> stalled;
+	std::atomic<uint32_t> stall_pos;
+#if !defined(NO_THREADS)
+	std::mutex wait_mutex;
+	std::condition_variable wait_condition;
+#endif
+
+	SafeNumeric<uint64_t> sync_count;
+	SafeNumeric<uint64_t> stall_usec;
+
+	_FORCE_INLINE_ static bool _is_past(uint32_t p_pos, uint32_t p_target) {
+		return int32_t(p_pos - p_target) >= 0;
+	}
 
 	template <class T>
-	T *allocate() {
-		// alloc size is size+T+safeguard
-		uint32_t alloc_size = ((sizeof(T) + 8 - 1) & ~(8 - 1)) + 8;
-
-		// Assert that the buffer is big enough to hold at least two messages.
-		ERR_FAIL_COND_V(alloc_size * 2 + sizeof(uint32_t) > command_mem_size, nullptr);
-
-	tryagain:
-		uint32_t write_ptr = write_ptr_and_epoch >> 1;
-
-		if (write_ptr < dealloc_ptr) {
-			// behind dealloc_ptr, check that there is room
-			if ((dealloc_ptr - write_ptr) <= alloc_size) {
-				// There is no more room, try to deallocate something
-				if (dealloc_one()) {
-					goto tryagain;
-				}
-				return nullptr;
-			}
-		} else {
-			// ahead of dealloc_ptr, check that there is room
-
-			if ((command_mem_size - write_ptr) < alloc_size + sizeof(uint32_t)) {
-				// no room at the end, wrap down;
-
-				if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
-
-					// There is no more room, try to deallocate something
-					if (dealloc_one()) {
-						goto tryagain;
-					}
-					return nullptr;
-				}
-
-				// if this happens, it's a bug
-				ERR_FAIL_COND_V((command_mem_size - write_ptr) < 8, nullptr);
-				// zero means, wrap to beginning
-
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-				*p = 1;
-				write_ptr_and_epoch = 0 | (1 & ~write_ptr_and_epoch); // Invert epoch.
-				// See if we can get the thread to run and clear up some more space while we wait.
-				// This is required if alloc_size * 2 + 4 > COMMAND_MEM_SIZE
-				if (sync) {
-					sync->post();
-				}
-				goto tryagain;
-			}
+	T *allocate(bool p_sync) {
+		const uint32_t alloc_size = ((sizeof(T) + 8 - 1) & ~(8 - 1)) + HEADER_SIZE;
+
+		// The buffer must be big enough to hold at least two messages.
+		CRASH_COND_MSG(alloc_size * 2 > command_mem_size, "Command queue is too small, increase 'memory/limits/command_queue/multithreading_queue_size_kb'.");
+
+		uint32_t offset = write_pos & (command_mem_size - 1);
+		const uint32_t to_end = command_mem_size - offset;
+		const uint32_t needed = alloc_size > to_end ? to_end + alloc_size : alloc_size;
+
+		if (write_pos + needed - consumed.load(std::memory_order_acquire) > command_mem_size) {
+			wait_for_space(write_pos + needed - command_mem_size);
 		}
-		// Allocate the size and the 'in use' bit.
-		// First bit used to mark if command is still in use (1)
-		// or if it has been destroyed and can be deallocated (0).
-		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
-		*p = (size << 1) | 1;
-		write_ptr += 8;
-		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += size;
-		write_ptr_and_epoch = (write_ptr << 1) | (write_ptr_and_epoch & 1);
-		return cmd;
-	}
 
-	template <class T>
-	T *allocate_and_lock() {
-		lock();
-		T *ret;
-
-		while ((ret = allocate<T>()) == nullptr) {
-			unlock();
-			// sleep a little until fetch happened and some room is made
-			wait_for_flush();
-			lock();
+		if (alloc_size > to_end) {
+			// Zero size means the rest of the buffer is skipped.
+			*(uint32_t *)&command_mem[offset] = 0;
+			write_pos += to_end;
+			offset = 0;
 		}
 
-		return ret;
+		*(uint32_t *)&command_mem[offset] = alloc_size | (p_sync ? HEADER_SYNC_BIT : 0);
+		T *cmd = memnew_placement(&command_mem[offset + HEADER_SIZE], T);
+		write_pos += alloc_size;
+		return cmd;
+	}
+
+	// Makes everything written so far visible to the consumer. Returns the
+	// position the consumer has to reach to have executed all of it.
+	_FORCE_INLINE_ uint32_t publish_and_unlock() {
+		const uint32_t pos = write_pos;
+		published.store(pos, std::memory_order_seq_cst);
+		write_lock.unlock();
+		wake_consumer();
+		return pos;
 	}
 
-	bool flush_one(bool p_lock = true) {
-		if (p_lock) {
-			lock();
+	_FORCE_INLINE_ void wake_consumer() {
+		if (sync && consumer_sleeping.load(std::memory_order_seq_cst) && consumer_sleeping.exchange(false)) {
+			sync->post();
 		}
-	tryagain:
+	}
 
-		// tried to read an empty queue
-		if (read_ptr_and_epoch == write_ptr_and_epoch) {
-			if (p_lock) {
-				unlock();
-			}
+	bool flush_one() {
+		if (read_pos == published.load(std::memory_order_acquire)) {
 			return false;
 		}
 
-		uint32_t read_ptr = read_ptr_and_epoch >> 1;
-		uint32_t size_ptr = read_ptr;
-		uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
+		uint32_t offset = read_pos & (command_mem_size - 1);
+		uint32_t header = *(uint32_t *)&command_mem[offset];
 
-		if (size == 0) {
-			*(uint32_t *)&command_mem[read_ptr] = 0; // clear in-use bit.
-			//end of ringbuffer, wrap
-			read_ptr_and_epoch = 0 | (1 & ~read_ptr_and_epoch); // Invert epoch.
-			goto tryagain;
+		if (header == 0) {
+			// End of ringbuffer, wrap. A command always follows.
+			read_pos += command_mem_size - offset;
+			offset = 0;
+			header = *(uint32_t *)&command_mem[0];
 		}
 
-		read_ptr += 8;
-
-		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr]);
-
-		read_ptr += size;
-
-		read_ptr_and_epoch = (read_ptr << 1) | (read_ptr_and_epoch & 1);
-
-		if (p_lock) {
-			unlock();
-		}
+		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[offset + HEADER_SIZE]);
 		cmd->call();
-		if (p_lock) {
-			lock();
-		}
-
-		cmd->post();
 		cmd->~CommandBase();
-		*(uint32_t *)&command_mem[size_ptr] &= ~1;
 
-		if (p_lock) {
-			unlock();
+		read_pos += header & ~uint32_t(HEADER_SYNC_BIT);
+		consumed.store(read_pos, std::memory_order_seq_cst);
+
+		// seq_cst pairs with wait_for_space(), which stores stalled and then loads consumed: one
+		// of the two sides must see the other's store, or the producer waits with nobody to notify it.
+		if ((header & HEADER_SYNC_BIT) || stalled.load(std::memory_order_seq_cst)) {
+			notify_waiters(header & HEADER_SYNC_BIT);
 		}
 		return true;
 	}
 
-	void lock();
-	void unlock();
-	void wait_for_flush();
-	SyncSemaphore *_alloc_sync_sem();
-	bool dealloc_one();
+	void notify_waiters(bool p_sync);
+	void wait_for_position(uint32_t p_pos);
+	void wait_for_sync(uint32_t p_pos);
+	void wait_for_space(uint32_t p_pos);
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -472,21 +437,22 @@ public:
 	DECL_PUSH_AND_SYNC(0)
 	SPACE_SEP_LIST(DECL_PUSH_AND_SYNC, 13)
 
-	void wait_and_flush_one() {
-		ERR_FAIL_COND(!sync);
-		sync->wait();
-		flush_one();
-	}
+	// Sleeps until commands are available, then flushes all of them.
+	void wait_and_flush_one();
 
 	void flush_all() {
-		//ERR_FAIL_COND(sync);
-		lock();
-		while (flush_one(false)) {
+		while (flush_one()) {
 			;
 		}
-		unlock();
 	}
 
+	// Bytes of commands pushed but not executed yet.
+	uint32_t get_pending_bytes() const { return published.load(std::memory_order_relaxed) - consumed.load(std::memory_order_relaxed); }
+	// Calls that waited for the consumer to execute them, since creation.
+	uint64_t get_sync_count() const { return sync_count.get(); }
+	// Microseconds callers spent blocked on return values or a full queue, since creation.
+	uint64_t get_stall_usec() const { return stall_usec.get(); }
+
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
 };
@@ -31,9 +31,54 @@
 #include "math_funcs.h"
 
 #include "core/error_macros.h"
+#include "core/math/random_profiler.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
 
 RandomPCG Math::default_rand(RandomPCG::DEFAULT_SEED, RandomPCG::DEFAULT_INC);
 
+static SafeFlag thread_local_rand;
+// Bumped by seed()/randomize(); per-thread generators reseed lazily when they see a new value.
+static SafeNumeric<uint32_t> rand_generation(1);
+static SafeNumeric<uint64_t> rand_seed(RandomPCG::DEFAULT_SEED);
+
+struct ThreadRand {
+	RandomPCG rand;
+	uint32_t generation = 0;
+};
+static thread_local ThreadRand thread_rand;
+
+RandomPCG &Math::_get_default_rand() {
+#ifdef DEBUG_ENABLED
+	RandomProfiler::record_global(RandomProfiler::EVENT_DRAW);
+#endif
+	if (likely(!thread_local_rand.is_set())) {
+		return default_rand;
+	}
+	const uint32_t index = Thread::get_caller_index();
+	if (index == 0) {
+		return default_rand;
+	}
+	const uint32_t generation = rand_generation.get();
+	if (unlikely(thread_rand.generation != generation)) {
+		// Thread i draws from PCG stream i (the main thread uses DEFAULT_INC). Caller indices are
+		// never recycled, so skipping ahead within one stream would wrap onto another thread's
+		// draws after 2^16 threads. Distinct streams never meet.
+		thread_rand.rand.inc(index);
+		thread_rand.rand.seed(rand_seed.get());
+		thread_rand.generation = generation;
+	}
+	return thread_rand.rand;
+}
+
+void Math::set_thread_local_rand(bool p_enabled) {
+	thread_local_rand.set_to(p_enabled);
+}
+
+bool Math::is_thread_local_rand() {
+	return thread_local_rand.is_set();
+}
+
 #define PHI 0x9e3779b9
 
 uint32_t Math::rand_from_seed(uint64_t *seed) {
@@ -44,15 +89,29 @@ uint32_t Math::rand_from_seed(uint64_t *seed) {
 }
 
 void Math::seed(uint64_t x) {
+#ifdef DEBUG_ENABLED
+	RandomProfiler::record_global(RandomProfiler::EVENT_RESEED);
+#endif
 	default_rand.seed(x);
+	rand_seed.set(x);
+	rand_generation.increment();
 }
 
 void Math::randomize() {
+#ifdef DEBUG_ENABLED
+	RandomProfiler::record_global(RandomProfiler::EVENT_RESEED);
+#endif
 	default_rand.randomize();
+	rand_seed.set(default_rand.get_seed());
+	rand_generation.increment();
 }
 
 uint32_t Math::rand() {
-	return default_rand.rand();
+	return _get_default_rand().rand();
+}
+
+uint32_t Math::rand_bounded(uint32_t p_bound) {
+	return Random::bounded(_get_default_rand(), p_bound);
 }
 
 int Math::step_decimals(double p_step) {
@@ -178,9 +237,13 @@ uint32_t Math::larger_prime(uint32_t p_val) {
 }
 
 double Math::random(double from, double to) {
-	return default_rand.random(from, to);
+	return _get_default_rand().random(from, to);
 }
 
 float Math::random(float from, float to) {
-	return default_rand.random(from, to);
+	return _get_default_rand().random(from, to);
+}
+
+int Math::random(int from, int to) {
+	return Random::bounded_range(_get_default_rand(), from, to);
 }
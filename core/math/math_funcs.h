@@ -43,6 +43,8 @@
 class Math {
 	static RandomPCG default_rand;
 
+	static RandomPCG &_get_default_rand();
+
 public:
 	Math() {} // useless to instance
 
@@ -292,13 +294,18 @@ public:
 	static void seed(uint64_t x);
 	static void randomize();
 	static uint32_t rand_from_seed(uint64_t *seed);
+	// Opt-in: threads other than the main one draw from their own generator, seeded from the
+	// global seed and Thread::get_caller_index(). seed() and randomize() reach all of them.
+	static void set_thread_local_rand(bool p_enabled);
+	static bool is_thread_local_rand();
 	static uint32_t rand();
+	static uint32_t rand_bounded(uint32_t p_bound); // Unbiased [0, p_bound), see Random::bounded().
 	static _ALWAYS_INLINE_ double randd() { return (double)rand() / (double)Math::RANDOM_32BIT_MAX; }
 	static _ALWAYS_INLINE_ float randf() { return (float)rand() / (float)Math::RANDOM_32BIT_MAX; }
 
 	static double random(double from, double to);
 	static float random(float from, float to);
-	static real_t random(int from, int to) { return (real_t)random((real_t)from, (real_t)to); }
+	static int random(int from, int to); // Unbiased integer in [from, to], both inclusive.
 
 	static _ALWAYS_INLINE_ bool is_equal_approx_ratio(real_t a, real_t b, real_t epsilon = CMP_EPSILON, real_t min_epsilon = CMP_EPSILON) {
 		// this is an approximate way to check that numbers are close, as a ratio of their average size
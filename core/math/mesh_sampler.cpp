@@ -0,0 +1,198 @@
+/*************************************************************************/
+/*  mesh_sampler.cpp                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "mesh_sampler.h"
+
+#include "core/hash_map.h"
+#include "core/math/random_profiler.h"
+#include "core/math/random_source.h"
+
+bool MeshSampler::set_faces(const PoolVector<Face3> &p_faces) {
+	const int count = p_faces.size();
+	faces.resize(count);
+	normals.resize(count);
+	LocalVector<real_t> areas;
+	areas.resize(count);
+	area = 0;
+
+	PoolVector<Face3>::Read r = p_faces.read();
+	for (int i = 0; i < count; i++) {
+		faces[i] = r[i];
+		normals[i] = r[i].get_plane().normal;
+		// Degenerate faces keep their index but are never picked.
+		areas[i] = r[i].get_area() < CMP_EPSILON ? 0 : r[i].get_area();
+		area += areas[i];
+	}
+
+	if (area <= 0) {
+		faces.clear();
+		normals.clear();
+		table.clear();
+		area = 0;
+		return false;
+	}
+	return table.build(areas.ptr(), count);
+}
+
+PoolVector<Face3> MeshSampler::get_faces() const {
+	PoolVector<Face3> result;
+	result.resize(faces.size());
+	PoolVector<Face3>::Write w = result.write();
+	for (uint32_t i = 0; i < faces.size(); i++) {
+		w[i] = faces[i];
+	}
+	return result;
+}
+
+int MeshSampler::get_face_count() const {
+	return faces.size();
+}
+
+real_t MeshSampler::get_area() const {
+	return area;
+}
+
+template <class T>
+int MeshSampler::_sample(T &p_rand, int p_count, real_t p_min_distance, Vector3 *r_points, Vector3 *r_normals, Vector3 *r_barycentrics, int *r_faces) const {
+	// Poisson-disk rejection uses a hash grid with cells small enough to hold one accepted point.
+	// Points sharing a cell (or a hash slot) are chained through next_in_cell.
+	const bool poisson = p_min_distance > 0;
+	const real_t cell_size = p_min_distance / Math::sqrt((real_t)3.0);
+	const real_t min_distance_squared = p_min_distance * p_min_distance;
+	HashMap<uint64_t, int> cell_heads;
+	LocalVector<int> next_in_cell;
+
+	int written = 0;
+	int64_t attempts = poisson ? (int64_t)p_count * POISSON_ATTEMPTS : p_count;
+	while (written < p_count && attempts-- > 0) {
+		const int face_index = table.sample(p_rand);
+		const Face3 &face = faces[face_index];
+
+		// Square-root warp of the unit square onto the triangle.
+		const real_t r1 = Math::sqrt(p_rand.rand() * (1.0 / 4294967296.0));
+		const real_t r2 = p_rand.rand() * (1.0 / 4294967296.0);
+		const Vector3 barycentric(1.0 - r1, r1 * (1.0 - r2), r1 * r2);
+		const Vector3 point = face.vertex[0] * barycentric.x + face.vertex[1] * barycentric.y + face.vertex[2] * barycentric.z;
+
+		if (poisson) {
+			const int64_t cx = (int64_t)Math::floor(point.x / cell_size);
+			const int64_t cy = (int64_t)Math::floor(point.y / cell_size);
+			const int64_t cz = (int64_t)Math::floor(point.z / cell_size);
+			bool rejected = false;
+			for (int64_t x = cx - 2; x <= cx + 2 && !rejected; x++) {
+				for (int64_t y = cy - 2; y <= cy + 2 && !rejected; y++) {
+					for (int64_t z = cz - 2; z <= cz + 2 && !rejected; z++) {
+						const int *head = cell_heads.getptr(((uint64_t)(x & 0x1FFFFF) << 42) | ((uint64_t)(y & 0x1FFFFF) << 21) | (uint64_t)(z & 0x1FFFFF));
+						for (int other = head ? *head : -1; other >= 0; other = next_in_cell[other]) {
+							if (r_points[other].distance_squared_to(point) < min_distance_squared) {
+								rejected = true;
+								break;
+							}
+						}
+					}
+				}
+			}
+			if (rejected) {
+				continue;
+			}
+			const uint64_t key = ((uint64_t)(cx & 0x1FFFFF) << 42) | ((uint64_t)(cy & 0x1FFFFF) << 21) | (uint64_t)(cz & 0x1FFFFF);
+			int *head = cell_heads.getptr(key);
+			next_in_cell.push_back(head ? *head : -1);
+			cell_heads.set(key, written);
+		}
+
+		r_points[written] = point;
+		if (r_normals) {
+			r_normals[written] = normals[face_index];
+		}
+		if (r_barycentrics) {
+			r_barycentrics[written] = barycentric;
+		}
+		if (r_faces) {
+			r_faces[written] = face_index;
+		}
+		written++;
+	}
+	return written;
+}
+
+int MeshSampler::sample(int p_count, Vector3 *r_points, Vector3 *r_normals, Vector3 *r_barycentrics, int *r_faces, real_t p_min_distance, RandomNumberGenerator *p_rng) const {
+	ERR_FAIL_COND_V(p_count < 0, 0);
+	ERR_FAIL_COND_V_MSG(table.empty(), 0, "MeshSampler has no faces to sample.");
+	RANDOM_PROFILE_SCOPE("MeshSampler");
+	if (p_rng) {
+		RandomSourceRNG source = { p_rng };
+		return _sample(source, p_count, p_min_distance, r_points, r_normals, r_barycentrics, r_faces);
+	}
+	RandomSourceGlobal source;
+	return _sample(source, p_count, p_min_distance, r_points, r_normals, r_barycentrics, r_faces);
+}
+
+Dictionary MeshSampler::sample_points(int p_count, real_t p_min_distance, const Ref<RandomNumberGenerator> &p_rng) const {
+	Dictionary result;
+	ERR_FAIL_COND_V(p_count < 0, result);
+	PoolVector3Array points;
+	PoolVector3Array point_normals;
+	PoolVector3Array barycentrics;
+	PoolIntArray face_indices;
+	points.resize(p_count);
+	point_normals.resize(p_count);
+	barycentrics.resize(p_count);
+	face_indices.resize(p_count);
+
+	int written;
+	{
+		PoolVector3Array::Write wp = points.write();
+		PoolVector3Array::Write wn = point_normals.write();
+		PoolVector3Array::Write wb = barycentrics.write();
+		PoolIntArray::Write wf = face_indices.write();
+		Ref<RandomNumberGenerator> rng = p_rng;
+		written = sample(p_count, wp.ptr(), wn.ptr(), wb.ptr(), wf.ptr(), p_min_distance, rng.ptr());
+	}
+	points.resize(written);
+	point_normals.resize(written);
+	barycentrics.resize(written);
+	face_indices.resize(written);
+
+	result["points"] = points;
+	result["normals"] = point_normals;
+	result["barycentrics"] = barycentrics;
+	result["faces"] = face_indices;
+	return result;
+}
+
+void MeshSampler::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_faces", "faces"), &MeshSampler::set_faces);
+	ClassDB::bind_method(D_METHOD("get_faces"), &MeshSampler::get_faces);
+	ClassDB::bind_method(D_METHOD("get_face_count"), &MeshSampler::get_face_count);
+	ClassDB::bind_method(D_METHOD("get_area"), &MeshSampler::get_area);
+	ClassDB::bind_method(D_METHOD("sample_points", "count", "min_distance", "rng"), &MeshSampler::sample_points, DEFVAL(0.0), DEFVAL(Variant()));
+}
@@ -0,0 +1,75 @@
+/*************************************************************************/
+/*  mesh_sampler.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef MESH_SAMPLER_H
+#define MESH_SAMPLER_H
+
+#include "core/local_vector.h"
+#include "core/math/face3.h"
+#include "core/math/random_alias_table.h"
+#include "core/math/random_number_generator.h"
+#include "core/reference.h"
+
+// Uniformly distributed points over a triangle soup (e.g. Mesh::get_faces()). Faces are picked
+// through an alias table weighted by area, so each point costs O(1) however many faces there are.
+class MeshSampler : public Reference {
+	GDCLASS(MeshSampler, Reference);
+
+	// Dart throwing gives up after this many rejected candidates per requested point.
+	static const int POISSON_ATTEMPTS = 30;
+
+	LocalVector<Face3> faces;
+	LocalVector<Vector3> normals;
+	RandomAliasTable table;
+	real_t area = 0;
+
+	template <class T>
+	int _sample(T &p_rand, int p_count, real_t p_min_distance, Vector3 *r_points, Vector3 *r_normals, Vector3 *r_barycentrics, int *r_faces) const;
+
+protected:
+	static void _bind_methods();
+
+public:
+	// Returns false, and leaves the sampler empty, if the faces have no area.
+	bool set_faces(const PoolVector<Face3> &p_faces);
+	PoolVector<Face3> get_faces() const;
+	int get_face_count() const;
+	real_t get_area() const;
+
+	// Writes up to p_count points, and optionally their face normals, barycentric coordinates
+	// (weights of the face's vertex 0, 1 and 2) and face indices. With p_min_distance > 0, no two
+	// points are closer than that, and fewer points are returned once the surface is full.
+	// Returns the number of points written. Draws from the global generator when p_rng is null.
+	int sample(int p_count, Vector3 *r_points, Vector3 *r_normals = nullptr, Vector3 *r_barycentrics = nullptr, int *r_faces = nullptr, real_t p_min_distance = 0, RandomNumberGenerator *p_rng = nullptr) const;
+	Dictionary sample_points(int p_count, real_t p_min_distance = 0, const Ref<RandomNumberGenerator> &p_rng = Ref<RandomNumberGenerator>()) const;
+};
+
+#endif // MESH_SAMPLER_H
@@ -40,8 +40,55 @@ Random::Random(uint64_t p_seed =DEFAULT_SEED, uint64_t p_inc=DEFAULT_INC) {
 	current_seed = p_seed;
 	current_inc = p_inc;
 };
+
+const double Random::ZIGGURAT_NORMAL_R = 3.6541528853610088;
+const double Random::ZIGGURAT_EXPONENTIAL_R = 7.69711747013104972;
+
+// Layers are built outwards-in from the tail edge R, each with the same area v.
+static void _build_ziggurat(Random::ZigguratTable &r_table, double p_r, double p_v, double (*p_density)(double), double (*p_inverse)(double)) {
+	r_table.x[0] = p_v / p_density(p_r);
+	r_table.x[1] = p_r;
+	for (int i = 2; i < 256; i++) {
+		r_table.x[i] = p_inverse(p_v / r_table.x[i - 1] + p_density(r_table.x[i - 1]));
+	}
+	r_table.x[256] = 0.0;
+	for (int i = 0; i <= 256; i++) {
+		r_table.f[i] = p_density(r_table.x[i]);
+	}
+}
+
+static double _normal_density(double p_x) {
+	return exp(-0.5 * p_x * p_x);
+}
+
+static double _normal_inverse(double p_y) {
+	return sqrt(-2.0 * log(p_y));
+}
+
+static double _exponential_density(double p_x) {
+	return exp(-p_x);
+}
+
+static double _exponential_inverse(double p_y) {
+	return -log(p_y);
+}
+
+Random::ZigguratTable Random::ziggurat_normal;
+Random::ZigguratTable Random::ziggurat_exponential;
+
+static struct ZigguratInit {
+	ZigguratInit() {
+		_build_ziggurat(Random::ziggurat_normal, Random::ZIGGURAT_NORMAL_R, 4.92867323399e-3, _normal_density, _normal_inverse);
+		_build_ziggurat(Random::ziggurat_exponential, Random::ZIGGURAT_EXPONENTIAL_R, 3.9496598225815571993e-3, _exponential_density, _exponential_inverse);
+	}
+} ziggurat_init;
+
+uint64_t Random::make_random_seed(uint64_t p_base) {
+	return (OS::get_singleton()->get_unix_time() + OS::get_singleton()->get_ticks_usec()) * p_base + PCG_DEFAULT_INC_64;
+}
+
 void Random::randomize() {
-	seed((OS::get_singleton()->get_unix_time() + OS::get_singleton()->get_ticks_usec()) * current_seed + PCG_DEFAULT_INC_64);
+	seed(make_random_seed(current_seed));
 }
 
 double Random::random(double p_from, double p_to) {
@@ -40,6 +40,7 @@
 
 #if defined(__GNUC__) || (_llvm_has_builtin(__builtin_clz))
 #define CLZ32(x) __builtin_clz(x)
+#define CLZ64(x) __builtin_clzll(x)
 #elif defined(_MSC_VER)
 #include "intrin.h"
 static int __bsr_clz32(uint32_t x) {
@@ -48,6 +49,14 @@ static int __bsr_clz32(uint32_t x) {
 	return 31 - index;
 }
 #define CLZ32(x) __bsr_clz32(x)
+#if defined(_M_X64) || defined(_M_ARM64)
+static int __bsr_clz64(uint64_t x) {
+	unsigned long index;
+	_BitScanReverse64(&index, x);
+	return 63 - index;
+}
+#define CLZ64(x) __bsr_clz64(x)
+#endif
 #else
 #endif
 
@@ -68,12 +77,14 @@ public:
 		PCG,
 		XORSHIFT128,
 		XOROSHIRO128,
-		SPLITMIX64
+		SPLITMIX64,
+		PHILOX
 	};
 	static const uint64_t DEFAULT_SEED = 12047754176567800795U;
 	static const uint64_t DEFAULT_INC = PCG_DEFAULT_INC_64;
 	Random(uint64_t p_seed, uint64_t p_inc);
 	Random();
+	virtual ~Random() {}
 
 protected:
 	uint64_t current_seed; // The seed the current generator state started from.
@@ -81,9 +92,7 @@ protected:
 
 public:
 
-	_FORCE_INLINE_ void seed(uint64_t p_seed) {
-		current_seed = p_seed;
-	};
+	virtual void seed(uint64_t p_seed) = 0;
 	_FORCE_INLINE_ uint64_t get_seed() {
 		return current_seed;
 	};
@@ -93,23 +102,396 @@ public:
 	_FORCE_INLINE_ uint64_t get_inc() {
 		return current_inc;
 	};
+	// Distance jump() skips for generators with a 2^64 period (PCG, SplitMix64, Philox),
+	// leaving room for 2^16 non-overlapping substreams.
+	static const uint64_t JUMP_DISTANCE_64 = 1ULL << 48;
+	// Distance long_jump() skips for the same generators: 2^8 jumps apart, so the period splits
+	// into 2^8 long jumped streams of 2^8 jump() substreams each.
+	static const uint64_t LONG_JUMP_DISTANCE_64 = 1ULL << 56;
+
 	_FORCE_INLINE_ virtual void set_state(uint64_t p_state) = 0;
+	// Skips ahead by a fixed, backend-specific number of draws (2^64 for the xorshift family,
+	// JUMP_DISTANCE_64 otherwise) in O(1) or O(log n), to carve out non-overlapping substreams.
+	virtual void jump() = 0;
+	// Skips far enough that the jump() substreams and bulk lanes of the result never meet this
+	// generator's: 2^96 draws for the xorshift family, whose bulk lanes sit on the jump() grid,
+	// LONG_JUMP_DISTANCE_64 for the others. Jumping 2^32 (resp. 2^8) times lands on the next
+	// long jump.
+	virtual void long_jump() = 0;
 	_FORCE_INLINE_ virtual uint64_t get_state() const = 0;
 
+	// Full generator state, seed included, for resuming a stream exactly where it was saved.
+	// get_state() only holds 64 bits. The layout is backend-specific, and only written and read
+	// back by the same backend: the seed, then up to two 64-bit words (unused words are zero).
+	static const int STATE_BYTES = 24;
+	virtual void write_state(uint8_t *r_bytes) const = 0;
+	virtual void read_state(const uint8_t *p_bytes) = 0;
+
+	// Time-based seed, mixed with p_base so that generators randomized in the same tick differ.
+	static uint64_t make_random_seed(uint64_t p_base);
 	void randomize();
 	_FORCE_INLINE_ virtual uint32_t rand() = 0;
 
+	// Mantissa fill: uniform [0, 1) from the high 53/24 bits of one raw output.
+	// One draw and a multiply, but values below 2^-53 / 2^-24 collapse onto that grid.
+	static _FORCE_INLINE_ double unit_double(uint64_t p_bits) {
+		return (double)(p_bits >> 11) * (1.0 / 9007199254740992.0); // 2^-53
+	}
+	static _FORCE_INLINE_ float unit_float(uint32_t p_bits) {
+		return (float)(p_bits >> 8) * (1.0f / 16777216.0f); // 2^-24
+	}
+
+	// CLZ/LDEXP conversion for backends with 64-bit output, see RandomPCG::randd() for the rationale.
+	// The exponent comes from the leading zeros of one draw, the significand from another.
+	// Callers must draw p_exponent_bits before p_significand_bits to stay deterministic.
+	static _FORCE_INLINE_ double clz_double(uint64_t p_exponent_bits, uint64_t p_significand_bits) {
+#if defined(CLZ64)
+		if (unlikely(p_exponent_bits == 0)) {
+			return 0;
+		}
+		return LDEXP((double)(p_significand_bits | 0x8000000000000001U), -64 - CLZ64(p_exponent_bits));
+#else
+		return unit_double(p_significand_bits);
+#endif
+	}
+	// Single-draw variant for floats: the high half picks the exponent, the low half the significand.
+	static _FORCE_INLINE_ float clz_float(uint64_t p_bits) {
+#if defined(CLZ32)
+		uint32_t proto_exp_offset = (uint32_t)(p_bits >> 32);
+		if (unlikely(proto_exp_offset == 0)) {
+			return 0;
+		}
+		return LDEXPF((float)((uint32_t)p_bits | 0x80000001), -32 - CLZ32(proto_exp_offset));
+#else
+		return unit_float((uint32_t)(p_bits >> 32));
+#endif
+	}
+
 	_FORCE_INLINE_ virtual double randd() = 0;
 	_FORCE_INLINE_ virtual float randf() = 0;
 
+	// Two 32-bit draws for callers going through the virtual interface; backends with native
+	// 64-bit output hide this with their own rand64().
+	_FORCE_INLINE_ uint64_t rand64() {
+		const uint64_t high = rand();
+		return (high << 32) | rand();
+	}
+
 	_FORCE_INLINE_ double randfn(double p_mean, double p_deviation) {
-		return p_mean + p_deviation * (cos(Math_TAU * randd()) * sqrt(-2.0 * log(randd())));
+		return p_mean + p_deviation * normal(*this);
 	};
 	_FORCE_INLINE_ float randfn(float p_mean, float p_deviation) {
-		return p_mean + p_deviation * (cos(Math_TAU * randf()) * sqrt(-2.0 * log(randf())));
+		return p_mean + p_deviation * (float)normal(*this);
 	};
 	double random(double p_from, double p_to);
 	float random(float p_from, float p_to);
-	real_t random(int p_from, int p_to) { return (real_t)random((real_t)p_from, (real_t)p_to); };
+	int random(int p_from, int p_to) { return bounded_range(*this, p_from, p_to); };
+
+	// 256-layer ziggurat (Marsaglia & Tsang) for the unnormalized densities exp(-x^2 / 2) and exp(-x).
+	// x[i] is the right edge of layer i (x[0] is the base strip's virtual width), f[i] the density there.
+	struct ZigguratTable {
+		double x[257];
+		double f[257];
+	};
+	static ZigguratTable ziggurat_normal; // Built during static initialization, see random.cpp.
+	static ZigguratTable ziggurat_exponential;
+	static const double ZIGGURAT_NORMAL_R;
+	static const double ZIGGURAT_EXPONENTIAL_R;
+
+	// Standard normal deviate. One 64-bit draw covers about 99% of calls: its low 8 bits pick the
+	// layer and its top 53 bits the position, so the two never share bits (Doornik's fix for the
+	// correlation in the original 32-bit scheme). Only the layer edges need exp(), the tail log().
+	template <class T>
+	static _FORCE_INLINE_ double normal(T &p_rand) {
+		const ZigguratTable &table = ziggurat_normal;
+		while (true) {
+			const uint64_t bits = p_rand.rand64();
+			const int i = bits & 0xFF;
+			const double u = 2.0 * unit_double(bits) - 1.0;
+			const double x = u * table.x[i];
+			if (likely(fabs(x) < table.x[i + 1])) {
+				return x;
+			}
+			if (unlikely(i == 0)) {
+				// Tail beyond R, Marsaglia's method.
+				double tx, ty;
+				do {
+					tx = -log(1.0 - unit_double(p_rand.rand64())) / ZIGGURAT_NORMAL_R;
+					ty = -log(1.0 - unit_double(p_rand.rand64()));
+				} while (ty + ty < tx * tx);
+				return u < 0.0 ? -(ZIGGURAT_NORMAL_R + tx) : ZIGGURAT_NORMAL_R + tx;
+			}
+			if (table.f[i + 1] + (table.f[i] - table.f[i + 1]) * unit_double(p_rand.rand64()) < exp(-0.5 * x * x)) {
+				return x;
+			}
+		}
+	}
+
+	// Exponential deviate with rate 1, same scheme with a one-sided table.
+	template <class T>
+	static _FORCE_INLINE_ double exponential(T &p_rand) {
+		const ZigguratTable &table = ziggurat_exponential;
+		while (true) {
+			const uint64_t bits = p_rand.rand64();
+			const int i = bits & 0xFF;
+			const double x = unit_double(bits) * table.x[i];
+			if (likely(x < table.x[i + 1])) {
+				return x;
+			}
+			if (unlikely(i == 0)) {
+				return ZIGGURAT_EXPONENTIAL_R - log(1.0 - unit_double(p_rand.rand64()));
+			}
+			if (table.f[i + 1] + (table.f[i] - table.f[i + 1]) * unit_double(p_rand.rand64()) < exp(-x)) {
+				return x;
+			}
+		}
+	}
+
+	// Gamma deviate with the given shape and scale 1 (Marsaglia & Tsang's squeeze method).
+	// Shapes below 1 are boosted: G(a) = G(a + 1) * U^(1 / a).
+	template <class T>
+	static double gamma(T &p_rand, double p_shape) {
+		if (p_shape <= 0.0) {
+			return 0.0;
+		}
+		if (p_shape < 1.0) {
+			const double u = 1.0 - unit_double(p_rand.rand64());
+			return gamma(p_rand, p_shape + 1.0) * pow(u, 1.0 / p_shape);
+		}
+		const double d = p_shape - 1.0 / 3.0;
+		const double c = 1.0 / sqrt(9.0 * d);
+		while (true) {
+			double x, v;
+			do {
+				x = normal(p_rand);
+				v = 1.0 + c * x;
+			} while (v <= 0.0);
+			v = v * v * v;
+			const double u = unit_double(p_rand.rand64());
+			const double x2 = x * x;
+			if (u < 1.0 - 0.0331 * x2 * x2 || log(u) < 0.5 * x2 + d * (1.0 - v + log(v))) {
+				return d * v;
+			}
+		}
+	}
+
+	// Poisson deviate: multiplication of uniforms for small means, Hormann's PTRS transformed
+	// rejection (constant expected cost) from a mean of 10 up.
+	template <class T>
+	static int poisson(T &p_rand, double p_mean) {
+		if (p_mean <= 0.0) {
+			return 0;
+		}
+		if (p_mean < 10.0) {
+			const double limit = exp(-p_mean);
+			double product = 1.0 - unit_double(p_rand.rand64());
+			int k = 0;
+			while (product > limit) {
+				k++;
+				product *= 1.0 - unit_double(p_rand.rand64());
+			}
+			return k;
+		}
+		const double sqrt_mean = sqrt(p_mean);
+		const double log_mean = log(p_mean);
+		const double b = 0.931 + 2.53 * sqrt_mean;
+		const double a = -0.059 + 0.02483 * b;
+		const double inv_alpha = 1.1239 + 1.1328 / (b - 3.4);
+		const double v_r = 0.9277 - 3.6224 / (b - 2.0);
+		while (true) {
+			const double u = unit_double(p_rand.rand64()) - 0.5;
+			const double v = unit_double(p_rand.rand64());
+			const double us = 0.5 - fabs(u);
+			if (unlikely(us <= 0.0)) {
+				continue;
+			}
+			const double k = floor((2.0 * a / us + b) * u + p_mean + 0.43);
+			if (us >= 0.07 && v <= v_r) {
+				return (int)k;
+			}
+			if (k < 0.0 || (us < 0.013 && v > us)) {
+				continue;
+			}
+			if (log(v) + log(inv_alpha) - log(a / (us * us) + b) <= -p_mean + k * log_mean - lgamma(k + 1.0)) {
+				return (int)k;
+			}
+		}
+	}
+
+	// Binomial deviate. Large cases are split with beta-distributed order statistics
+	// (Knuth, TAOCP 3.4.1 F) until at most ~30 successes are expected, then finished by inversion.
+	template <class T>
+	static int binomial(T &p_rand, int p_trials, double p_probability) {
+		if (p_trials <= 0 || p_probability <= 0.0) {
+			return 0;
+		}
+		if (p_probability >= 1.0) {
+			return p_trials;
+		}
+		int successes = 0;
+		int n = p_trials;
+		double p = p_probability;
+		while (n * MIN(p, 1.0 - p) > 30.0) {
+			// x is the a-th smallest of n uniforms; only the ones on p's side of it are still undecided.
+			const int a = 1 + n / 2;
+			const int b = n + 1 - a;
+			const double ga = gamma(p_rand, a);
+			const double x = ga / (ga + gamma(p_rand, b));
+			if (x >= p) {
+				n = a - 1;
+				p /= x;
+			} else {
+				successes += a;
+				n = b - 1;
+				p = (p - x) / (1.0 - x);
+			}
+		}
+
+		const bool flip = p > 0.5;
+		if (flip) {
+			p = 1.0 - p;
+		}
+		const double q = 1.0 - p;
+		const double s = p / q;
+		const double a = (n + 1) * s;
+		int x;
+		while (true) {
+			double r = pow(q, n);
+			double u = unit_double(p_rand.rand64());
+			x = 0;
+			while (u > r && x <= n) {
+				u -= r;
+				x++;
+				r *= a / x - s;
+			}
+			if (likely(x <= n)) {
+				break; // Otherwise rounding ran past the last term, draw again.
+			}
+		}
+		return successes + (flip ? n - x : x);
+	}
+
+	// Both outputs of one Box-Muller transform, for callers that need normals in pairs.
+	template <class T>
+	static _FORCE_INLINE_ void normal_pair(T &p_rand, double &r_first, double &r_second) {
+		// 1 - u maps [0, 1) to (0, 1], keeping log() finite.
+		const double radius = sqrt(-2.0 * log(1.0 - unit_double(p_rand.rand64())));
+		const double angle = Math_TAU * unit_double(p_rand.rand64());
+		r_first = radius * cos(angle);
+		r_second = radius * sin(angle);
+	}
+
+	// Unbiased integer in [0, p_bound) with Lemire's multiply-shift method: the high word of
+	// rand() * p_bound is the result, and the low word tells whether the draw fell into the
+	// small biased zone. Only then is the threshold computed (the sole division) and the draw
+	// rejected. Works with any backend; on final classes the rand() call is devirtualized.
+	template <class T>
+	static _FORCE_INLINE_ uint32_t bounded(T &p_rand, uint32_t p_bound) {
+		uint64_t product = (uint64_t)p_rand.rand() * p_bound;
+		uint32_t low = (uint32_t)product;
+		if (unlikely(low < p_bound)) {
+			const uint32_t threshold = (0U - p_bound) % p_bound;
+			while (low < threshold) {
+				product = (uint64_t)p_rand.rand() * p_bound;
+				low = (uint32_t)product;
+			}
+		}
+		return (uint32_t)(product >> 32);
+	}
+
+	// Two unbiased integers in [0, p_bound1) and [0, p_bound2) from a single rand(), for bounds
+	// whose product fits in 32 bits (Brackett-Rozinsky and Lemire's batched ranged integers).
+	// The low word left after the first multiply is reused for the second one, and the
+	// rejection test runs once on the final low word against the product of the bounds.
+	template <class T>
+	static _FORCE_INLINE_ void bounded_pair(T &p_rand, uint32_t p_bound1, uint32_t p_bound2, uint32_t &r_first, uint32_t &r_second) {
+		const uint32_t range = p_bound1 * p_bound2;
+		uint64_t first = (uint64_t)p_rand.rand() * p_bound1;
+		uint64_t second = (uint64_t)(uint32_t)first * p_bound2;
+		if (unlikely((uint32_t)second < range)) {
+			const uint32_t threshold = (0U - range) % range;
+			while ((uint32_t)second < threshold) {
+				first = (uint64_t)p_rand.rand() * p_bound1;
+				second = (uint64_t)(uint32_t)first * p_bound2;
+			}
+		}
+		r_first = (uint32_t)(first >> 32);
+		r_second = (uint32_t)(second >> 32);
+	}
+
+	// Uniform in-place permutation (Fisher-Yates). Once the remaining length is below 2^16,
+	// the swap positions are drawn two at a time with bounded_pair().
+	template <class T, class E>
+	static void shuffle(T &p_rand, E *p_data, int p_size) {
+		int i = p_size - 1;
+		for (; i >= 65536; i--) {
+			SWAP(p_data[i], p_data[bounded(p_rand, i + 1)]);
+		}
+		for (; i >= 2; i -= 2) {
+			uint32_t first, second;
+			bounded_pair(p_rand, i + 1, i, first, second);
+			SWAP(p_data[i], p_data[first]);
+			SWAP(p_data[i - 1], p_data[second]);
+		}
+		if (i == 1) {
+			SWAP(p_data[1], p_data[p_rand.rand() & 1]);
+		}
+	}
+
+	// Moves a uniform random sample of p_count elements to the front of p_data, in random
+	// order (partial Fisher-Yates). The rest of the array is left in unspecified order.
+	template <class T, class E>
+	static void partial_shuffle(T &p_rand, E *p_data, int p_size, int p_count) {
+		int i = 0;
+		for (; i < p_count && p_size - i > 65536; i++) {
+			SWAP(p_data[i], p_data[i + bounded(p_rand, p_size - i)]);
+		}
+		for (; i + 1 < p_count; i += 2) {
+			uint32_t first, second;
+			bounded_pair(p_rand, p_size - i, p_size - i - 1, first, second);
+			SWAP(p_data[i], p_data[i + first]);
+			SWAP(p_data[i + 1], p_data[i + 1 + second]);
+		}
+		if (i < p_count) {
+			SWAP(p_data[i], p_data[i + bounded(p_rand, p_size - i)]);
+		}
+	}
+
+	// Copies a uniform random sample of p_count elements of p_src into r_dst without touching
+	// p_src (reservoir sampling, Li's algorithm L). Only O(p_count * (1 + log(p_size / p_count)))
+	// draws are made, as the elements that won't enter the reservoir are skipped over in one
+	// step. The sample comes out in source order, shuffle() it if order matters.
+	template <class T, class E>
+	static void reservoir_sample(T &p_rand, const E *p_src, int p_size, E *r_dst, int p_count) {
+		if (p_count <= 0) {
+			return;
+		}
+		for (int i = 0; i < p_count; i++) {
+			r_dst[i] = p_src[i];
+		}
+		// 1 - u maps [0, 1) to (0, 1], keeping log() finite.
+		double w = exp(log(1.0 - unit_double(p_rand.rand64())) / p_count);
+		int i = p_count - 1;
+		while (true) {
+			const double skip = floor(log(1.0 - unit_double(p_rand.rand64())) / log(1.0 - w));
+			if (!(skip < double(p_size - 1 - i))) { // Also catches NaN when w rounds to 1.
+				break;
+			}
+			i += int(skip) + 1;
+			r_dst[bounded(p_rand, p_count)] = p_src[i];
+			w *= exp(log(1.0 - unit_double(p_rand.rand64())) / p_count);
+		}
+	}
+
+	// Unbiased integer in [p_from, p_to], both inclusive and in either order.
+	template <class T>
+	static _FORCE_INLINE_ int bounded_range(T &p_rand, int p_from, int p_to) {
+		if (p_to < p_from) {
+			SWAP(p_from, p_to);
+		}
+		const uint32_t span = (uint32_t)p_to - (uint32_t)p_from + 1; // Wraps to 0 for the full 32-bit range.
+		const uint32_t offset = likely(span != 0) ? bounded(p_rand, span) : p_rand.rand();
+		return (int)((uint32_t)p_from + offset);
+	}
 };
 #endif
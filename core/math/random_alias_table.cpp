@@ -0,0 +1,81 @@
+/*************************************************************************/
+/*  random_alias_table.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "random_alias_table.h"
+
+bool RandomAliasTable::build(const real_t *p_weights, int p_count) {
+	columns.clear();
+	double total = 0.0;
+	for (int i = 0; i < p_count; i++) {
+		ERR_FAIL_COND_V_MSG(p_weights[i] < 0, false, "Weights can't be negative.");
+		total += p_weights[i];
+	}
+	ERR_FAIL_COND_V_MSG(total <= 0.0, false, "At least one weight must be positive.");
+
+	// Probabilities scaled so the average column holds exactly 1.
+	LocalVector<double> scaled;
+	scaled.resize(p_count);
+	LocalVector<uint32_t> small;
+	LocalVector<uint32_t> large;
+	for (int i = 0; i < p_count; i++) {
+		scaled[i] = p_weights[i] * p_count / total;
+		if (scaled[i] < 1.0) {
+			small.push_back(i);
+		} else {
+			large.push_back(i);
+		}
+	}
+
+	columns.resize(p_count);
+	while (small.size() && large.size()) {
+		const uint32_t s = small[small.size() - 1];
+		small.resize(small.size() - 1);
+		const uint32_t l = large[large.size() - 1];
+		// The small column is topped up from the large one, which keeps the remainder.
+		columns[s].threshold = (uint64_t)(scaled[s] * 4294967296.0);
+		columns[s].alias = l;
+		scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+		if (scaled[l] < 1.0) {
+			large.resize(large.size() - 1);
+			small.push_back(l);
+		}
+	}
+	// Whatever is left holds 1 up to rounding error.
+	for (uint32_t i = 0; i < large.size(); i++) {
+		columns[large[i]].threshold = 4294967296ULL;
+		columns[large[i]].alias = large[i];
+	}
+	for (uint32_t i = 0; i < small.size(); i++) {
+		columns[small[i]].threshold = 4294967296ULL;
+		columns[small[i]].alias = small[i];
+	}
+	return true;
+}
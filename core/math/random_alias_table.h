@@ -0,0 +1,68 @@
+/*************************************************************************/
+/*  random_alias_table.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_ALIAS_TABLE_H
+#define RANDOM_ALIAS_TABLE_H
+
+#include "core/local_vector.h"
+#include "core/math/random.h"
+
+// Walker's alias method, built with Vose's stable variant: O(n) to build, then each weighted
+// pick is one bounded draw for the column and one coin draw, whatever the number of entries.
+class RandomAliasTable {
+	struct Column {
+		uint64_t threshold; // Coin values below this keep the column, scaled to [0, 2^32].
+		uint32_t alias;
+	};
+	LocalVector<Column> columns;
+
+public:
+	// Returns false, leaving the table empty, if no weight is positive or any weight is negative.
+	bool build(const real_t *p_weights, int p_count);
+	void clear() { columns.clear(); }
+
+	_FORCE_INLINE_ int size() const { return columns.size(); }
+	_FORCE_INLINE_ bool empty() const { return columns.size() == 0; }
+
+	// p_column must be uniform in [0, size()), p_coin uniform over 32 bits.
+	_FORCE_INLINE_ int pick(uint32_t p_column, uint32_t p_coin) const {
+		const Column &column = columns[p_column];
+		return p_coin < column.threshold ? (int)p_column : (int)column.alias;
+	}
+
+	template <class T>
+	_FORCE_INLINE_ int sample(T &p_rand) const {
+		const uint32_t column = Random::bounded(p_rand, columns.size());
+		return pick(column, p_rand.rand());
+	}
+};
+
+#endif // RANDOM_ALIAS_TABLE_H
@@ -0,0 +1,54 @@
+/*************************************************************************/
+/*  random_combined.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "random_combined.h"
+
+#include "core/io/marshalls.h"
+
+void RandomCombined::set_members(Random *const *p_members, const RandomEngineFunctions *const *p_engines, int p_count) {
+	ERR_FAIL_COND(p_count < 1 || p_count > MAX_MEMBERS);
+	for (int i = 0; i < p_count; i++) {
+		members[i] = p_members[i];
+		engines[i] = p_engines[i];
+	}
+	member_count = p_count;
+	current_seed = members[0]->get_seed();
+}
+
+void RandomCombined::write_state(uint8_t *r_bytes) const {
+	encode_uint64(current_seed, r_bytes);
+	encode_uint64(0, r_bytes + 8);
+	encode_uint64(0, r_bytes + 16);
+}
+
+void RandomCombined::read_state(const uint8_t *p_bytes) {
+	current_seed = decode_uint64(p_bytes);
+}
@@ -0,0 +1,154 @@
+/*************************************************************************/
+/*  random_combined.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_COMBINED_H
+#define RANDOM_COMBINED_H
+
+#include "core/math/random_engine.h"
+
+// Combined generator behind RandomNumberGenerator's cycling mode. Every member backend
+// advances in lockstep, one step per draw, and their outputs are XORed: the result is at
+// least as uniform as the best member, with a period of (at least) the largest member period.
+// Members are owned by the RandomNumberGenerator and reached through their engine tables,
+// so a step costs one engine call per member and no state is ever copied.
+class RandomCombined final : public Random {
+public:
+	static const int MAX_MEMBERS = 5;
+
+private:
+	Random *members[MAX_MEMBERS] = {};
+	const RandomEngineFunctions *engines[MAX_MEMBERS] = {};
+	int member_count = 0;
+
+public:
+	// p_engines[i] is the engine table of p_members[i]'s backend. The first member provides
+	// the seed and the 64-bit state.
+	void set_members(Random *const *p_members, const RandomEngineFunctions *const *p_engines, int p_count);
+	_FORCE_INLINE_ int get_member_count() const { return member_count; }
+	// Picks up a seed applied to the members directly.
+	_FORCE_INLINE_ void refresh_seed() { current_seed = members[0]->get_seed(); }
+
+	virtual void seed(uint64_t p_seed) {
+		current_seed = p_seed;
+		for (int i = 0; i < member_count; i++) {
+			engines[i]->seed(members[i], p_seed);
+		}
+	}
+	virtual void set_state(uint64_t p_state) {
+		for (int i = 0; i < member_count; i++) {
+			engines[i]->set_state(members[i], p_state);
+		}
+	}
+	virtual uint64_t get_state() const {
+		return engines[0]->get_state(members[0]);
+	}
+	virtual void jump() {
+		for (int i = 0; i < member_count; i++) {
+			members[i]->jump();
+		}
+	}
+	virtual void long_jump() {
+		for (int i = 0; i < member_count; i++) {
+			members[i]->long_jump();
+		}
+	}
+	// Only the seed: the members are saved and restored by their owner.
+	virtual void write_state(uint8_t *r_bytes) const;
+	virtual void read_state(const uint8_t *p_bytes);
+
+	_FORCE_INLINE_ virtual uint32_t rand() {
+		uint32_t result = engines[0]->rand(members[0]);
+		for (int i = 1; i < member_count; i++) {
+			result ^= engines[i]->rand(members[i]);
+		}
+		return result;
+	}
+	_FORCE_INLINE_ uint64_t rand64() {
+		uint64_t result = engines[0]->rand64(members[0]);
+		for (int i = 1; i < member_count; i++) {
+			result ^= engines[i]->rand64(members[i]);
+		}
+		return result;
+	}
+
+	_FORCE_INLINE_ virtual double randd() {
+		const uint64_t exponent_bits = rand64();
+		return clz_double(exponent_bits, rand64());
+	}
+	_FORCE_INLINE_ virtual float randf() {
+		return clz_float(rand64());
+	}
+
+	friend class RandomBulkSource<RandomCombined>;
+};
+
+// Bulk path: every member fills the block through its own bulk source (lanes included),
+// kept alive for the whole fill, and the blocks are XORed together.
+template <>
+class RandomBulkSource<RandomCombined> {
+	RandomCombined *rand;
+	RandomBulkSourceStorage sources[RandomCombined::MAX_MEMBERS];
+
+public:
+	_FORCE_INLINE_ void fill(uint64_t *p_dst, int p_count) {
+		rand->engines[0]->bulk_fill(&sources[0], p_dst, p_count);
+		uint64_t block[RANDOM_BULK_BLOCK];
+		for (int i = 1; i < rand->member_count; i++) {
+			rand->engines[i]->bulk_fill(&sources[i], block, p_count);
+			for (int j = 0; j < p_count; j++) {
+				p_dst[j] ^= block[j];
+			}
+		}
+	}
+
+	RandomBulkSource(RandomCombined *p_rand, int p_words) :
+			rand(p_rand) {
+		for (int i = 0; i < rand->member_count; i++) {
+			rand->engines[i]->bulk_begin(rand->members[i], p_words, &sources[i]);
+		}
+	}
+
+	~RandomBulkSource() {
+		for (int i = 0; i < rand->member_count; i++) {
+			rand->engines[i]->bulk_end(&sources[i]);
+		}
+	}
+};
+
+// Combined generators are never members of another one.
+template <>
+struct RandomBulkErasure<RandomCombined> {
+	static void begin(Random *p_rand, int p_words, void *r_source) { CRASH_NOW_MSG("RandomCombined can't be combined."); }
+	static void fill(void *p_source, uint64_t *p_dst, int p_count) {}
+	static void end(void *p_source) {}
+};
+
+#endif // RANDOM_COMBINED_H
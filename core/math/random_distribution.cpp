@@ -0,0 +1,225 @@
+/*************************************************************************/
+/*  random_distribution.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "random_distribution.h"
+
+#include "core/math/random_source.h"
+
+template <class T>
+Variant RandomDistribution::_sample(T &p_rand) const {
+	switch (type) {
+		case TYPE_WEIGHTED: {
+			ERR_FAIL_COND_V_MSG(table.empty(), -1, "RandomDistribution has no positive weights to sample from.");
+			return table.sample(p_rand);
+		}
+		case TYPE_POISSON:
+			return Random::poisson(p_rand, mean);
+		case TYPE_BINOMIAL:
+			return Random::binomial(p_rand, trials, probability);
+		case TYPE_EXPONENTIAL:
+			return (real_t)(Random::exponential(p_rand) / rate);
+		case TYPE_GAMMA:
+			return (real_t)(Random::gamma(p_rand, shape) * scale);
+		default:
+			ERR_FAIL_V(Variant());
+	}
+}
+
+Variant RandomDistribution::sample(const Ref<RandomNumberGenerator> &p_rng) {
+	Ref<RandomNumberGenerator> rng = p_rng;
+	if (rng.is_valid()) {
+		RandomSourceRNG source = { rng.ptr() };
+		return _sample(source);
+	}
+	RandomSourceGlobal source;
+	return _sample(source);
+}
+
+Array RandomDistribution::sample_many(int p_count, const Ref<RandomNumberGenerator> &p_rng) {
+	ERR_FAIL_COND_V(p_count < 0, Array());
+	Array result;
+	result.resize(p_count);
+	Ref<RandomNumberGenerator> rng = p_rng;
+	if (rng.is_valid()) {
+		RandomSourceRNG source = { rng.ptr() };
+		for (int i = 0; i < p_count; i++) {
+			result[i] = _sample(source);
+		}
+	} else {
+		RandomSourceGlobal source;
+		for (int i = 0; i < p_count; i++) {
+			result[i] = _sample(source);
+		}
+	}
+	return result;
+}
+
+void RandomDistribution::set_type(Type p_type) {
+	ERR_FAIL_INDEX(p_type, TYPE_MAX);
+	type = p_type;
+	_change_notify();
+	emit_changed();
+}
+
+RandomDistribution::Type RandomDistribution::get_type() const {
+	return type;
+}
+
+void RandomDistribution::set_weights(const PoolRealArray &p_weights) {
+	weights = p_weights;
+	if (weights.size()) {
+		PoolRealArray::Read r = weights.read();
+		table.build(r.ptr(), weights.size());
+	} else {
+		table.clear();
+	}
+	emit_changed();
+}
+
+PoolRealArray RandomDistribution::get_weights() const {
+	return weights;
+}
+
+void RandomDistribution::set_mean(real_t p_mean) {
+	ERR_FAIL_COND_MSG(p_mean < 0, "Poisson mean can't be negative.");
+	mean = p_mean;
+	emit_changed();
+}
+
+real_t RandomDistribution::get_mean() const {
+	return mean;
+}
+
+void RandomDistribution::set_trials(int p_trials) {
+	ERR_FAIL_COND_MSG(p_trials < 0, "Binomial trial count can't be negative.");
+	trials = p_trials;
+	emit_changed();
+}
+
+int RandomDistribution::get_trials() const {
+	return trials;
+}
+
+void RandomDistribution::set_probability(real_t p_probability) {
+	ERR_FAIL_COND_MSG(p_probability < 0 || p_probability > 1, "Binomial probability must be between 0 and 1.");
+	probability = p_probability;
+	emit_changed();
+}
+
+real_t RandomDistribution::get_probability() const {
+	return probability;
+}
+
+void RandomDistribution::set_rate(real_t p_rate) {
+	ERR_FAIL_COND_MSG(p_rate <= 0, "Exponential rate must be positive.");
+	rate = p_rate;
+	emit_changed();
+}
+
+real_t RandomDistribution::get_rate() const {
+	return rate;
+}
+
+void RandomDistribution::set_shape(real_t p_shape) {
+	ERR_FAIL_COND_MSG(p_shape <= 0, "Gamma shape must be positive.");
+	shape = p_shape;
+	emit_changed();
+}
+
+real_t RandomDistribution::get_shape() const {
+	return shape;
+}
+
+void RandomDistribution::set_scale(real_t p_scale) {
+	ERR_FAIL_COND_MSG(p_scale <= 0, "Gamma scale must be positive.");
+	scale = p_scale;
+	emit_changed();
+}
+
+real_t RandomDistribution::get_scale() const {
+	return scale;
+}
+
+void RandomDistribution::_validate_property(PropertyInfo &property) const {
+	bool used = true;
+	if (property.name == "weights") {
+		used = type == TYPE_WEIGHTED;
+	} else if (property.name == "mean") {
+		used = type == TYPE_POISSON;
+	} else if (property.name == "trials" || property.name == "probability") {
+		used = type == TYPE_BINOMIAL;
+	} else if (property.name == "rate") {
+		used = type == TYPE_EXPONENTIAL;
+	} else if (property.name == "shape" || property.name == "scale") {
+		used = type == TYPE_GAMMA;
+	}
+	if (!used) {
+		property.usage = PROPERTY_USAGE_NOEDITOR;
+	}
+}
+
+void RandomDistribution::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_type", "type"), &RandomDistribution::set_type);
+	ClassDB::bind_method(D_METHOD("get_type"), &RandomDistribution::get_type);
+	ClassDB::bind_method(D_METHOD("set_weights", "weights"), &RandomDistribution::set_weights);
+	ClassDB::bind_method(D_METHOD("get_weights"), &RandomDistribution::get_weights);
+	ClassDB::bind_method(D_METHOD("set_mean", "mean"), &RandomDistribution::set_mean);
+	ClassDB::bind_method(D_METHOD("get_mean"), &RandomDistribution::get_mean);
+	ClassDB::bind_method(D_METHOD("set_trials", "trials"), &RandomDistribution::set_trials);
+	ClassDB::bind_method(D_METHOD("get_trials"), &RandomDistribution::get_trials);
+	ClassDB::bind_method(D_METHOD("set_probability", "probability"), &RandomDistribution::set_probability);
+	ClassDB::bind_method(D_METHOD("get_probability"), &RandomDistribution::get_probability);
+	ClassDB::bind_method(D_METHOD("set_rate", "rate"), &RandomDistribution::set_rate);
+	ClassDB::bind_method(D_METHOD("get_rate"), &RandomDistribution::get_rate);
+	ClassDB::bind_method(D_METHOD("set_shape", "shape"), &RandomDistribution::set_shape);
+	ClassDB::bind_method(D_METHOD("get_shape"), &RandomDistribution::get_shape);
+	ClassDB::bind_method(D_METHOD("set_scale", "scale"), &RandomDistribution::set_scale);
+	ClassDB::bind_method(D_METHOD("get_scale"), &RandomDistribution::get_scale);
+
+	ClassDB::bind_method(D_METHOD("sample", "rng"), &RandomDistribution::sample, DEFVAL(Variant()));
+	ClassDB::bind_method(D_METHOD("sample_many", "count", "rng"), &RandomDistribution::sample_many, DEFVAL(Variant()));
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "type", PROPERTY_HINT_ENUM, "Weighted,Poisson,Binomial,Exponential,Gamma"), "set_type", "get_type");
+	ADD_PROPERTY(PropertyInfo(Variant::POOL_REAL_ARRAY, "weights"), "set_weights", "get_weights");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "mean", PROPERTY_HINT_RANGE, "0,1000,0.01,or_greater"), "set_mean", "get_mean");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "trials", PROPERTY_HINT_RANGE, "0,1000,1,or_greater"), "set_trials", "get_trials");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "probability", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_probability", "get_probability");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "rate", PROPERTY_HINT_RANGE, "0.001,100,0.001,or_greater"), "set_rate", "get_rate");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "shape", PROPERTY_HINT_RANGE, "0.001,100,0.001,or_greater"), "set_shape", "get_shape");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "scale", PROPERTY_HINT_RANGE, "0.001,100,0.001,or_greater"), "set_scale", "get_scale");
+
+	BIND_ENUM_CONSTANT(TYPE_WEIGHTED);
+	BIND_ENUM_CONSTANT(TYPE_POISSON);
+	BIND_ENUM_CONSTANT(TYPE_BINOMIAL);
+	BIND_ENUM_CONSTANT(TYPE_EXPONENTIAL);
+	BIND_ENUM_CONSTANT(TYPE_GAMMA);
+	BIND_ENUM_CONSTANT(TYPE_MAX);
+}
@@ -0,0 +1,103 @@
+/*************************************************************************/
+/*  random_distribution.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_DISTRIBUTION_H
+#define RANDOM_DISTRIBUTION_H
+
+#include "core/math/random_alias_table.h"
+#include "core/math/random_number_generator.h"
+#include "core/resource.h"
+
+class RandomDistribution : public Resource {
+	GDCLASS(RandomDistribution, Resource);
+
+public:
+	enum Type {
+		TYPE_WEIGHTED,
+		TYPE_POISSON,
+		TYPE_BINOMIAL,
+		TYPE_EXPONENTIAL,
+		TYPE_GAMMA,
+		TYPE_MAX
+	};
+
+private:
+	Type type = TYPE_WEIGHTED;
+	PoolRealArray weights;
+	RandomAliasTable table; // Rebuilt whenever the weights change.
+	real_t mean = 1.0;
+	int trials = 1;
+	real_t probability = 0.5;
+	real_t rate = 1.0;
+	real_t shape = 1.0;
+	real_t scale = 1.0;
+
+	template <class T>
+	Variant _sample(T &p_rand) const;
+
+protected:
+	static void _bind_methods();
+	void _validate_property(PropertyInfo &property) const;
+
+public:
+	void set_type(Type p_type);
+	Type get_type() const;
+
+	void set_weights(const PoolRealArray &p_weights);
+	PoolRealArray get_weights() const;
+
+	void set_mean(real_t p_mean);
+	real_t get_mean() const;
+
+	void set_trials(int p_trials);
+	int get_trials() const;
+
+	void set_probability(real_t p_probability);
+	real_t get_probability() const;
+
+	void set_rate(real_t p_rate);
+	real_t get_rate() const;
+
+	void set_shape(real_t p_shape);
+	real_t get_shape() const;
+
+	void set_scale(real_t p_scale);
+	real_t get_scale() const;
+
+	// Draws from p_rng, or from the global generator (Math::rand()) when p_rng is null.
+	// Weighted, Poisson and binomial draws are ints, exponential and gamma draws are floats.
+	Variant sample(const Ref<RandomNumberGenerator> &p_rng = Ref<RandomNumberGenerator>());
+	Array sample_many(int p_count, const Ref<RandomNumberGenerator> &p_rng = Ref<RandomNumberGenerator>());
+};
+
+VARIANT_ENUM_CAST(RandomDistribution::Type);
+
+#endif // RANDOM_DISTRIBUTION_H
@@ -0,0 +1,329 @@
+/*************************************************************************/
+/*  random_engine.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_ENGINE_H
+#define RANDOM_ENGINE_H
+
+#include "core/math/random.h"
+
+// Non-virtual entry points into one concrete Random backend.
+// RandomNumberGenerator resolves one of these tables when the algorithm is selected,
+// so every draw afterwards is a single indirect call into a fully inlined generator.
+struct RandomEngineFunctions {
+	void (*seed)(Random *p_rand, uint64_t p_seed);
+	void (*randomize)(Random *p_rand);
+	void (*set_state)(Random *p_rand, uint64_t p_state);
+	uint64_t (*get_state)(const Random *p_rand);
+	uint32_t (*rand)(Random *p_rand);
+	uint64_t (*rand64)(Random *p_rand);
+	uint32_t (*rand_bounded)(Random *p_rand, uint32_t p_bound);
+	int (*rand_range)(Random *p_rand, int p_from, int p_to);
+	float (*randf)(Random *p_rand);
+	double (*randd)(Random *p_rand);
+	real_t (*randfn)(Random *p_rand, real_t p_mean, real_t p_deviation);
+	void (*randfn_pair)(Random *p_rand, real_t p_mean, real_t p_deviation, real_t &r_first, real_t &r_second);
+	real_t (*randexp)(Random *p_rand, real_t p_rate);
+	real_t (*random)(Random *p_rand, real_t p_from, real_t p_to);
+	// Double precision regardless of real_t.
+	double (*randdn)(Random *p_rand, double p_mean, double p_deviation);
+	double (*random_double)(Random *p_rand, double p_from, double p_to);
+
+	void (*fill_randi)(Random *p_rand, int *p_dst, int p_count);
+	void (*fill_randf)(Random *p_rand, real_t *p_dst, int p_count, real_t p_from, real_t p_to);
+	void (*fill_randfn)(Random *p_rand, real_t *p_dst, int p_count, real_t p_mean, real_t p_deviation);
+	void (*fill_bytes)(Random *p_rand, uint8_t *p_dst, int p_count);
+	// Type-erased RandomBulkSource<T>, constructed in caller-provided storage, for generators
+	// combining several backends.
+	void (*bulk_begin)(Random *p_rand, int p_words, void *r_source);
+	void (*bulk_fill)(void *p_source, uint64_t *p_dst, int p_count);
+	void (*bulk_end)(void *p_source);
+};
+
+// Number of 64-bit words the bulk paths generate per block.
+#define RANDOM_BULK_BLOCK 256
+
+// Source of raw 64-bit output for the bulk paths. The default draws from the scalar backend;
+// backends with a multi-lane generator specialize it (see random_lanes.h).
+// p_words is the total number of words the caller will request, so a specialization can decide
+// whether setting up its lanes is worth it.
+template <class T>
+class RandomBulkSource {
+	T *rand;
+
+public:
+	_FORCE_INLINE_ void fill(uint64_t *p_dst, int p_count) {
+		for (int i = 0; i < p_count; i++) {
+			p_dst[i] = rand->T::rand64();
+		}
+	}
+
+	RandomBulkSource(T *p_rand, int p_words) :
+			rand(p_rand) {}
+};
+
+// Storage for a type-erased bulk source (see RandomEngineFunctions::bulk_begin).
+struct RandomBulkSourceStorage {
+	alignas(16) uint8_t data[256];
+};
+
+// Type erasure of RandomBulkSource<T>, behind RandomEngineFunctions::bulk_begin/fill/end.
+template <class T>
+struct RandomBulkErasure {
+	static void begin(Random *p_rand, int p_words, void *r_source) {
+		static_assert(sizeof(RandomBulkSource<T>) <= sizeof(RandomBulkSourceStorage), "RandomBulkSourceStorage is too small.");
+		memnew_placement(r_source, RandomBulkSource<T>(static_cast<T *>(p_rand), p_words));
+	}
+	static void fill(void *p_source, uint64_t *p_dst, int p_count) {
+		static_cast<RandomBulkSource<T> *>(p_source)->fill(p_dst, p_count);
+	}
+	static void end(void *p_source) {
+		static_cast<RandomBulkSource<T> *>(p_source)->~RandomBulkSource<T>();
+	}
+};
+
+// Float conversion policies for RandomEngine.
+// Exact uses the backend's own randf()/randd(), uniform down to 2^-64 (floats) / 2^-96 (doubles).
+struct RandomConversionExact {
+	template <class T>
+	static _FORCE_INLINE_ float randf(T *p_rand) { return p_rand->T::randf(); }
+	template <class T>
+	static _FORCE_INLINE_ double randd(T *p_rand) { return p_rand->T::randd(); }
+
+	// Bulk conversion of raw 64-bit words: one word per float, two per double, consumed the way
+	// the backends' randf()/randd() consume rand64(). Off the lanes, a fill then matches as many
+	// single draws (except doubles from PCG, whose randd() takes a 32-bit exponent draw).
+	enum {
+		FLOAT_VALUES = 1,
+		FLOAT_WORDS = 1,
+		DOUBLE_VALUES = 1,
+		DOUBLE_WORDS = 2,
+	};
+	static _FORCE_INLINE_ float bulk_float(const uint64_t *p_block, int p_index) { return Random::clz_float(p_block[p_index]); }
+	static _FORCE_INLINE_ double bulk_double(const uint64_t *p_block, int p_index) { return Random::clz_double(p_block[p_index * 2], p_block[p_index * 2 + 1]); }
+};
+
+// Mantissa fills the 24/53 bit mantissa from a single draw: cheaper, coarser near zero.
+struct RandomConversionMantissa {
+	template <class T>
+	static _FORCE_INLINE_ float randf(T *p_rand) { return Random::unit_float(p_rand->T::rand()); }
+	template <class T>
+	static _FORCE_INLINE_ double randd(T *p_rand) { return Random::unit_double(p_rand->T::rand64()); }
+
+	// Two floats per word in bulk, where randf() takes one rand(): same grid, different values.
+	enum {
+		FLOAT_VALUES = 2,
+		FLOAT_WORDS = 1,
+		DOUBLE_VALUES = 1,
+		DOUBLE_WORDS = 1,
+	};
+	static _FORCE_INLINE_ float bulk_float(const uint64_t *p_block, int p_index) { return Random::unit_float((uint32_t)(p_block[p_index >> 1] >> ((p_index & 1) * 32))); }
+	static _FORCE_INLINE_ double bulk_double(const uint64_t *p_block, int p_index) { return Random::unit_double(p_block[p_index]); }
+};
+
+// Policy-based engine: T is one of the final Random backends (RandomPCG, RandomXSH128, ...),
+// C one of the float conversion policies above.
+// All calls are qualified with T::, which suppresses virtual dispatch and lets the compiler
+// inline the generator into the table entry.
+template <class T, class C = RandomConversionExact>
+class RandomEngine {
+	static _FORCE_INLINE_ T *cast(Random *p_rand) { return static_cast<T *>(p_rand); }
+	static _FORCE_INLINE_ const T *cast(const Random *p_rand) { return static_cast<const T *>(p_rand); }
+
+	static _FORCE_INLINE_ real_t _randr(T *p_rand) {
+#ifdef REAL_T_IS_DOUBLE
+		return C::randd(p_rand);
+#else
+		return C::randf(p_rand);
+#endif
+	}
+
+public:
+	static void seed(Random *p_rand, uint64_t p_seed) { cast(p_rand)->T::seed(p_seed); }
+	static void randomize(Random *p_rand) { cast(p_rand)->T::seed(Random::make_random_seed(p_rand->get_seed())); }
+	static void set_state(Random *p_rand, uint64_t p_state) { cast(p_rand)->T::set_state(p_state); }
+	static uint64_t get_state(const Random *p_rand) { return cast(p_rand)->T::get_state(); }
+
+	static uint32_t rand(Random *p_rand) { return cast(p_rand)->T::rand(); }
+	static uint64_t rand64(Random *p_rand) { return cast(p_rand)->T::rand64(); }
+	static uint32_t rand_bounded(Random *p_rand, uint32_t p_bound) { return Random::bounded(*cast(p_rand), p_bound); }
+	static int rand_range(Random *p_rand, int p_from, int p_to) { return Random::bounded_range(*cast(p_rand), p_from, p_to); }
+	static float randf(Random *p_rand) { return C::randf(cast(p_rand)); }
+	static double randd(Random *p_rand) { return C::randd(cast(p_rand)); }
+
+	static real_t randfn(Random *p_rand, real_t p_mean, real_t p_deviation) {
+		return p_mean + p_deviation * Random::normal(*cast(p_rand));
+	}
+	static void randfn_pair(Random *p_rand, real_t p_mean, real_t p_deviation, real_t &r_first, real_t &r_second) {
+		double first, second;
+		Random::normal_pair(*cast(p_rand), first, second);
+		r_first = p_mean + p_deviation * first;
+		r_second = p_mean + p_deviation * second;
+	}
+	static real_t randexp(Random *p_rand, real_t p_rate) {
+		return Random::exponential(*cast(p_rand)) / p_rate;
+	}
+	static real_t random(Random *p_rand, real_t p_from, real_t p_to) {
+		return _randr(cast(p_rand)) * (p_to - p_from) + p_from;
+	}
+	static double randdn(Random *p_rand, double p_mean, double p_deviation) {
+		return p_mean + p_deviation * Random::normal(*cast(p_rand));
+	}
+	static double random_double(Random *p_rand, double p_from, double p_to) {
+		return C::randd(cast(p_rand)) * (p_to - p_from) + p_from;
+	}
+
+	// Bulk paths pull the backend's native 64-bit output through RandomBulkSource in blocks,
+	// splitting each word across as many values as it has bits for.
+	static void fill_randi(Random *p_rand, int *p_dst, int p_count) {
+		const int words = (p_count + 1) / 2;
+		RandomBulkSource<T> source(cast(p_rand), words);
+		uint64_t block[RANDOM_BULK_BLOCK];
+		for (int w = 0; w < words; w += RANDOM_BULK_BLOCK) {
+			const int n = MIN(RANDOM_BULK_BLOCK, words - w);
+			source.fill(block, n);
+			int *dst = p_dst + w * 2;
+			const int values = MIN(n * 2, p_count - w * 2);
+			for (int i = 0; i < values; i++) {
+				dst[i] = (int)(uint32_t)(block[i >> 1] >> ((i & 1) * 32));
+			}
+		}
+	}
+
+	// Converts through the policy (C::bulk_float()/bulk_double()), so fills follow set_float_conversion().
+	static void fill_randf(Random *p_rand, real_t *p_dst, int p_count, real_t p_from, real_t p_to) {
+		const real_t span = p_to - p_from;
+#ifdef REAL_T_IS_DOUBLE
+		const int group_values = C::DOUBLE_VALUES;
+		const int group_words = C::DOUBLE_WORDS;
+#else
+		const int group_values = C::FLOAT_VALUES;
+		const int group_words = C::FLOAT_WORDS;
+#endif
+		const int words = (p_count + group_values - 1) / group_values * group_words;
+		RandomBulkSource<T> source(cast(p_rand), words);
+		uint64_t block[RANDOM_BULK_BLOCK];
+		for (int w = 0; w < words; w += RANDOM_BULK_BLOCK) {
+			// RANDOM_BULK_BLOCK is a multiple of group_words, so groups never straddle blocks.
+			const int n = MIN(RANDOM_BULK_BLOCK, words - w);
+			source.fill(block, n);
+			const int first = w / group_words * group_values;
+			real_t *dst = p_dst + first;
+			const int values = MIN(n / group_words * group_values, p_count - first);
+			for (int i = 0; i < values; i++) {
+#ifdef REAL_T_IS_DOUBLE
+				dst[i] = C::bulk_double(block, i) * span + p_from;
+#else
+				dst[i] = C::bulk_float(block, i) * span + p_from;
+#endif
+			}
+		}
+	}
+
+	// Box-Muller, keeping both outputs of each transform.
+	static void fill_randfn(Random *p_rand, real_t *p_dst, int p_count, real_t p_mean, real_t p_deviation) {
+#ifdef REAL_T_IS_DOUBLE
+		const int words_per_pair = 2;
+#else
+		const int words_per_pair = 1;
+#endif
+		const int pairs = (p_count + 1) / 2;
+		const int words = pairs * words_per_pair;
+		RandomBulkSource<T> source(cast(p_rand), words);
+		uint64_t block[RANDOM_BULK_BLOCK];
+		for (int w = 0; w < words; w += RANDOM_BULK_BLOCK) {
+			const int n = MIN(RANDOM_BULK_BLOCK, words - w);
+			source.fill(block, n);
+			for (int k = 0; k < n; k += words_per_pair) {
+#ifdef REAL_T_IS_DOUBLE
+				// 1 - u maps [0, 1) to (0, 1], keeping log() finite.
+				double u1 = 1.0 - Random::unit_double(block[k]);
+				double u2 = Random::unit_double(block[k + 1]);
+#else
+				float u1 = 1.0f - Random::unit_float((uint32_t)block[k]);
+				float u2 = Random::unit_float((uint32_t)(block[k] >> 32));
+#endif
+				real_t radius = p_deviation * sqrt(-2.0 * log(u1));
+				real_t angle = Math_TAU * u2;
+				const int i = (w + k) / words_per_pair * 2;
+				p_dst[i] = p_mean + radius * cos(angle);
+				if (i + 1 < p_count) {
+					p_dst[i + 1] = p_mean + radius * sin(angle);
+				}
+			}
+		}
+	}
+
+	static void fill_bytes(Random *p_rand, uint8_t *p_dst, int p_count) {
+		const int words = (p_count + 7) / 8;
+		RandomBulkSource<T> source(cast(p_rand), words);
+		uint64_t block[RANDOM_BULK_BLOCK];
+		for (int w = 0; w < words; w += RANDOM_BULK_BLOCK) {
+			const int n = MIN(RANDOM_BULK_BLOCK, words - w);
+			source.fill(block, n);
+			uint8_t *dst = p_dst + w * 8;
+			const int bytes = MIN(n * 8, p_count - w * 8);
+			for (int i = 0; i < bytes; i++) {
+				dst[i] = (uint8_t)(block[i >> 3] >> ((i & 7) * 8));
+			}
+		}
+	}
+
+	static const RandomEngineFunctions functions;
+};
+
+template <class T, class C>
+const RandomEngineFunctions RandomEngine<T, C>::functions = {
+	&RandomEngine<T, C>::seed,
+	&RandomEngine<T, C>::randomize,
+	&RandomEngine<T, C>::set_state,
+	&RandomEngine<T, C>::get_state,
+	&RandomEngine<T, C>::rand,
+	&RandomEngine<T, C>::rand64,
+	&RandomEngine<T, C>::rand_bounded,
+	&RandomEngine<T, C>::rand_range,
+	&RandomEngine<T, C>::randf,
+	&RandomEngine<T, C>::randd,
+	&RandomEngine<T, C>::randfn,
+	&RandomEngine<T, C>::randfn_pair,
+	&RandomEngine<T, C>::randexp,
+	&RandomEngine<T, C>::random,
+	&RandomEngine<T, C>::randdn,
+	&RandomEngine<T, C>::random_double,
+	&RandomEngine<T, C>::fill_randi,
+	&RandomEngine<T, C>::fill_randf,
+	&RandomEngine<T, C>::fill_randfn,
+	&RandomEngine<T, C>::fill_bytes,
+	&RandomBulkErasure<T>::begin,
+	&RandomBulkErasure<T>::fill,
+	&RandomBulkErasure<T>::end,
+};
+
+#endif // RANDOM_ENGINE_H
@@ -0,0 +1,267 @@
+/*************************************************************************/
+/*  random_lanes.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_LANES_H
+#define RANDOM_LANES_H
+
+#include "core/typedefs.h"
+
+#include <thirdparty/randomization/xorshift/xorshift.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Multi-lane xoroshiro128+ / xorshift128+ for batch generation.
+// State is kept as structure-of-arrays so one step advances every lane with a handful of
+// vector ops. Lane i is the scalar generator jumped i times (2^64 draws apart), so the
+// streams never overlap and lane 0 continues the scalar sequence exactly.
+// Lanes share the grid of Random::jump(). Streams spawned by RandomNumberGenerator are
+// 2^96 draws apart instead (Random::long_jump()), so no stream replays another one's lanes.
+
+// Jumps r_generator by the distance whose polynomial (x^distance modulo the characteristic
+// polynomial, lowest coefficient first) is p_polynomial, as the generators' own Jump() does.
+template <class G>
+void random_lanes_jump(G &r_generator, const uint64_t (&p_polynomial)[2]) {
+	std::array<uint64_t, 2> state = { { 0, 0 } };
+	for (int i = 0; i < 2; i++) {
+		for (int b = 0; b < 64; b++) {
+			if (p_polynomial[i] & (1ULL << b)) {
+				state[0] ^= r_generator.GetState()[0];
+				state[1] ^= r_generator.GetState()[1];
+			}
+			r_generator.Next();
+		}
+	}
+	r_generator = G(state);
+}
+
+struct RandomLaneOpsScalar {
+	typedef uint64_t V;
+	enum { WIDTH = 1 };
+
+	static _FORCE_INLINE_ V load(const uint64_t *p_src) { return *p_src; }
+	static _FORCE_INLINE_ void store(uint64_t *p_dst, V p_v) { *p_dst = p_v; }
+	static _FORCE_INLINE_ V add(V p_a, V p_b) { return p_a + p_b; }
+	static _FORCE_INLINE_ V bxor(V p_a, V p_b) { return p_a ^ p_b; }
+	template <int K>
+	static _FORCE_INLINE_ V shl(V p_v) { return p_v << K; }
+	template <int K>
+	static _FORCE_INLINE_ V shr(V p_v) { return p_v >> K; }
+	template <int K>
+	static _FORCE_INLINE_ V rotl(V p_v) { return (p_v << K) | (p_v >> (64 - K)); }
+};
+
+#if defined(__AVX2__)
+struct RandomLaneOpsSIMD {
+	typedef __m256i V;
+	enum { WIDTH = 4 };
+
+	static _FORCE_INLINE_ V load(const uint64_t *p_src) { return _mm256_loadu_si256((const __m256i *)p_src); }
+	static _FORCE_INLINE_ void store(uint64_t *p_dst, V p_v) { _mm256_storeu_si256((__m256i *)p_dst, p_v); }
+	static _FORCE_INLINE_ V add(V p_a, V p_b) { return _mm256_add_epi64(p_a, p_b); }
+	static _FORCE_INLINE_ V bxor(V p_a, V p_b) { return _mm256_xor_si256(p_a, p_b); }
+	template <int K>
+	static _FORCE_INLINE_ V shl(V p_v) { return _mm256_slli_epi64(p_v, K); }
+	template <int K>
+	static _FORCE_INLINE_ V shr(V p_v) { return _mm256_srli_epi64(p_v, K); }
+	template <int K>
+	static _FORCE_INLINE_ V rotl(V p_v) { return _mm256_or_si256(_mm256_slli_epi64(p_v, K), _mm256_srli_epi64(p_v, 64 - K)); }
+};
+#elif defined(__SSE2__)
+struct RandomLaneOpsSIMD {
+	typedef __m128i V;
+	enum { WIDTH = 2 };
+
+	static _FORCE_INLINE_ V load(const uint64_t *p_src) { return _mm_loadu_si128((const __m128i *)p_src); }
+	static _FORCE_INLINE_ void store(uint64_t *p_dst, V p_v) { _mm_storeu_si128((__m128i *)p_dst, p_v); }
+	static _FORCE_INLINE_ V add(V p_a, V p_b) { return _mm_add_epi64(p_a, p_b); }
+	static _FORCE_INLINE_ V bxor(V p_a, V p_b) { return _mm_xor_si128(p_a, p_b); }
+	template <int K>
+	static _FORCE_INLINE_ V shl(V p_v) { return _mm_slli_epi64(p_v, K); }
+	template <int K>
+	static _FORCE_INLINE_ V shr(V p_v) { return _mm_srli_epi64(p_v, K); }
+	template <int K>
+	static _FORCE_INLINE_ V rotl(V p_v) { return _mm_or_si128(_mm_slli_epi64(p_v, K), _mm_srli_epi64(p_v, 64 - K)); }
+};
+#else
+typedef RandomLaneOpsScalar RandomLaneOpsSIMD;
+#endif
+
+// One step of the scalar algorithm, written against a lane ops policy.
+template <class G>
+struct RandomLaneStep;
+
+template <>
+struct RandomLaneStep<Xoroshiro128> {
+	template <class O>
+	static _FORCE_INLINE_ typename O::V step(typename O::V &r_s0, typename O::V &r_s1) {
+		typename O::V s0 = r_s0;
+		typename O::V s1 = r_s1;
+		typename O::V result = O::add(s0, s1);
+		s1 = O::bxor(s1, s0);
+		r_s0 = O::bxor(O::bxor(O::template rotl<55>(s0), s1), O::template shl<14>(s1));
+		r_s1 = O::template rotl<36>(s1);
+		return result;
+	}
+};
+
+template <>
+struct RandomLaneStep<Xorshift128> {
+	template <class O>
+	static _FORCE_INLINE_ typename O::V step(typename O::V &r_s0, typename O::V &r_s1) {
+		typename O::V s1 = r_s0;
+		typename O::V s0 = r_s1;
+		typename O::V result = O::add(s0, s1);
+		r_s0 = s0;
+		s1 = O::bxor(s1, O::template shl<23>(s1));
+		r_s1 = O::bxor(O::bxor(s1, s0), O::bxor(O::template shr<18>(s1), O::template shr<5>(s0)));
+		return result;
+	}
+};
+
+// Steps K vectors of lanes. Unrolled at compile time so the state arrays get scalarized into
+// registers regardless of the optimization level.
+template <int K>
+struct RandomLaneUnroll {
+	template <class G, class O>
+	static _FORCE_INLINE_ void step(typename O::V *r_s0, typename O::V *r_s1, uint64_t *r_out) {
+		RandomLaneUnroll<K - 1>::template step<G, O>(r_s0, r_s1, r_out);
+		O::store(r_out + (K - 1) * O::WIDTH, RandomLaneStep<G>::template step<O>(r_s0[K - 1], r_s1[K - 1]));
+	}
+};
+
+template <>
+struct RandomLaneUnroll<0> {
+	template <class G, class O>
+	static _FORCE_INLINE_ void step(typename O::V *r_s0, typename O::V *r_s1, uint64_t *r_out) {}
+};
+
+template <class G, class O = RandomLaneOpsSIMD>
+class RandomLanes {
+public:
+	enum { LANES = 8 };
+
+private:
+	enum { VECTORS = LANES / O::WIDTH };
+
+	uint64_t s0[LANES];
+	uint64_t s1[LANES];
+
+public:
+	void seed(const G &p_generator) {
+		G gen = p_generator;
+		for (int i = 0; i < LANES; i++) {
+			const std::array<uint64_t, 2> &state = gen.GetState();
+			s0[i] = state[0];
+			s1[i] = state[1];
+			gen.Jump();
+		}
+	}
+
+	G get_lane(int p_lane) const {
+		std::array<uint64_t, 2> state = { { s0[p_lane], s1[p_lane] } };
+		return G(state);
+	}
+
+	// Writes p_count outputs, interleaved by lane (word i comes from lane i % LANES).
+	// The state stays in registers for the whole batch.
+	void fill(uint64_t *p_dst, int p_count) {
+		typename O::V v0[VECTORS];
+		typename O::V v1[VECTORS];
+		for (int k = 0; k < VECTORS; k++) {
+			v0[k] = O::load(s0 + k * O::WIDTH);
+			v1[k] = O::load(s1 + k * O::WIDTH);
+		}
+
+		int i = 0;
+		for (; i + LANES <= p_count; i += LANES) {
+			RandomLaneUnroll<VECTORS>::template step<G, O>(v0, v1, p_dst + i);
+		}
+		if (i < p_count) {
+			uint64_t tail[LANES];
+			RandomLaneUnroll<VECTORS>::template step<G, O>(v0, v1, tail);
+			for (int j = 0; j < p_count - i; j++) {
+				p_dst[i + j] = tail[j];
+			}
+		}
+
+		for (int k = 0; k < VECTORS; k++) {
+			O::store(s0 + k * O::WIDTH, v0[k]);
+			O::store(s1 + k * O::WIDTH, v1[k]);
+		}
+	}
+
+	RandomLanes() {}
+	RandomLanes(const G &p_generator) { seed(p_generator); }
+};
+
+// Below this many words, jumping the extra lanes into place costs more than it saves.
+#define RANDOM_LANES_MIN_WORDS 1024
+
+// Bulk source for backends wrapping a lane-capable generator (exposed via T::get_generator()).
+// Lane 0 starts from the backend's state and is written back when done, so scalar draws resume
+// right after the lane 0 portion of the batch.
+template <class T, class G>
+class RandomLaneBulkSource {
+	T *rand;
+	RandomLanes<G> lanes;
+	bool use_lanes;
+
+public:
+	_FORCE_INLINE_ void fill(uint64_t *p_dst, int p_count) {
+		if (use_lanes) {
+			lanes.fill(p_dst, p_count);
+		} else {
+			for (int i = 0; i < p_count; i++) {
+				p_dst[i] = rand->T::rand64();
+			}
+		}
+	}
+
+	RandomLaneBulkSource(T *p_rand, int p_words) :
+			rand(p_rand),
+			use_lanes(p_words >= RANDOM_LANES_MIN_WORDS) {
+		if (use_lanes) {
+			lanes.seed(rand->get_generator());
+		}
+	}
+
+	~RandomLaneBulkSource() {
+		if (use_lanes) {
+			rand->get_generator() = lanes.get_lane(0);
+		}
+	}
+};
+
+#endif // RANDOM_LANES_H
@@ -29,42 +29,392 @@
 /*************************************************************************/
 
 #include "random_number_generator.h"
+
+#include "core/io/marshalls.h"
 #include <core/print_string.h>
 
 RandomNumberGenerator::RandomNumberGenerator() {
+#ifdef DEBUG_ENABLED
+	profile_counters.owner = get_instance_id();
+#endif
+	cycling.chosen_algorithm = 0;
 	set_algo(PCG);
 }
 RandomNumberGenerator::RandomNumberGenerator(uint8_t algo) {
+#ifdef DEBUG_ENABLED
+	profile_counters.owner = get_instance_id();
+#endif
+	cycling.chosen_algorithm = 0;
 	set_algo(algo);
+	if (!randbase) {
+		set_algo(PCG);
+	}
 }
 RandomNumberGenerator::RandomNumberGenerator(const RandomNumberGenerator& p_rng) {
-	*this = p_rng;
+#ifdef DEBUG_ENABLED
+	profile_counters.owner = get_instance_id();
+#endif
+	_copy_state_from(p_rng);
 }
 
+RandomNumberGenerator::~RandomNumberGenerator() {
+#ifdef DEBUG_ENABLED
+	RandomProfiler::unregister(profile_counters);
+#endif
+	for (int i = 0; i < algorithm_size; i++) {
+		if (backends[i]) {
+			backends[i]->~Random();
+		}
+	}
+}
 
-void RandomNumberGenerator::set_algo(uint8_t algo) {
-	cycling.chosen_algorithm &= 0b11111100;
-	cycling.chosen_algorithm |=  algo;
-	switch (algo) {
+Random *RandomNumberGenerator::_materialize(uint8_t p_algo) {
+	if (backends[p_algo]) {
+		return backends[p_algo];
+	}
+	switch (p_algo) {
 		case PCG:
-			print_line("Chosen: PCG");
-			randbase = *p_randbase_pcg;
+			backends[p_algo] = memnew_placement(storage_pcg, RandomPCG(seed_value));
 			break;
 		case XORSHIFT128:
-			print_line("Chosen: XSH128");
-			randbase = *p_randbase_xsh128;
+			backends[p_algo] = memnew_placement(storage_xsh128, RandomXSH128(seed_value));
 			break;
 		case XOROSHIRO128:
-			print_line("Chosen: XOSH128");
-			randbase = *p_randbase_xosh128;
+			backends[p_algo] = memnew_placement(storage_xosh128, RandomXOSH128(seed_value));
 			break;
 		case SPLITMIX64:
-			print_line("Chosen: SPLIT64");
-			randbase = *p_randbase_split64;
+			backends[p_algo] = memnew_placement(storage_split64, RandomSPLIT64(seed_value));
+			break;
+		case PHILOX:
+			backends[p_algo] = memnew_placement(storage_philox, RandomPhilox(seed_value));
 			break;
 	}
+	// Keep late backends on the same substream as the ones already jumped.
+	for (uint32_t i = 0; i < jump_count; i++) {
+		backends[p_algo]->jump();
+	}
+	for (uint32_t i = 0; i < stream_depth; i++) {
+		backends[p_algo]->long_jump();
+	}
+	return backends[p_algo];
+}
+
+void RandomNumberGenerator::_copy_state_from(const RandomNumberGenerator &p_rng) {
+	for (int i = 0; i < algorithm_size; i++) {
+		if (backends[i]) {
+			backends[i]->~Random();
+			backends[i] = nullptr;
+		}
+	}
+	cycling = p_rng.cycling;
+	seed_value = p_rng.seed_value;
+	jump_count = p_rng.jump_count;
+	stream_depth = p_rng.stream_depth;
+	float_conversion = p_rng.float_conversion;
+	if (p_rng.backends[PCG]) {
+		backends[PCG] = memnew_placement(storage_pcg, RandomPCG(*static_cast<const RandomPCG *>(p_rng.backends[PCG])));
+	}
+	if (p_rng.backends[XORSHIFT128]) {
+		backends[XORSHIFT128] = memnew_placement(storage_xsh128, RandomXSH128(*static_cast<const RandomXSH128 *>(p_rng.backends[XORSHIFT128])));
+	}
+	if (p_rng.backends[XOROSHIRO128]) {
+		backends[XOROSHIRO128] = memnew_placement(storage_xosh128, RandomXOSH128(*static_cast<const RandomXOSH128 *>(p_rng.backends[XOROSHIRO128])));
+	}
+	if (p_rng.backends[SPLITMIX64]) {
+		backends[SPLITMIX64] = memnew_placement(storage_split64, RandomSPLIT64(*static_cast<const RandomSPLIT64 *>(p_rng.backends[SPLITMIX64])));
+	}
+	if (p_rng.backends[PHILOX]) {
+		backends[PHILOX] = memnew_placement(storage_philox, RandomPhilox(*static_cast<const RandomPhilox *>(p_rng.backends[PHILOX])));
+	}
+	_update_engine();
+}
+
+const RandomEngineFunctions *RandomNumberGenerator::_get_engine(uint8_t p_algo, bool p_mantissa) {
+	switch (p_algo) {
+		case PCG:
+			return p_mantissa ? &RandomEngine<RandomPCG, RandomConversionMantissa>::functions : &RandomEngine<RandomPCG>::functions;
+		case XORSHIFT128:
+			return p_mantissa ? &RandomEngine<RandomXSH128, RandomConversionMantissa>::functions : &RandomEngine<RandomXSH128>::functions;
+		case XOROSHIRO128:
+			return p_mantissa ? &RandomEngine<RandomXOSH128, RandomConversionMantissa>::functions : &RandomEngine<RandomXOSH128>::functions;
+		case SPLITMIX64:
+			return p_mantissa ? &RandomEngine<RandomSPLIT64, RandomConversionMantissa>::functions : &RandomEngine<RandomSPLIT64>::functions;
+		case PHILOX:
+			return p_mantissa ? &RandomEngine<RandomPhilox, RandomConversionMantissa>::functions : &RandomEngine<RandomPhilox>::functions;
+	}
+	return nullptr;
+}
+
+void RandomNumberGenerator::_update_engine() {
+	const bool mantissa = float_conversion == FLOAT_CONVERSION_MANTISSA;
+	const uint8_t algo = get_chosen_algorithm();
+	const uint8_t steps = get_cycling_steps();
+	if (!is_cycling() || steps == 0) {
+		randbase = _materialize(algo);
+		engine = _get_engine(algo, mantissa);
+		return;
+	}
+
+	// Walk the orbit once; the members then advance together, so draws never switch backends.
+	Random *members[RandomCombined::MAX_MEMBERS];
+	const RandomEngineFunctions *member_engines[RandomCombined::MAX_MEMBERS];
+	int count = 0;
+	uint8_t member = algo;
+	do {
+		members[count] = _materialize(member);
+		member_engines[count] = _get_engine(member, false);
+		count++;
+		member = (member + steps) % algorithm_size;
+	} while (member != algo);
+	combined.set_members(members, member_engines, count);
+	randbase = &combined;
+	engine = mantissa ? &RandomEngine<RandomCombined, RandomConversionMantissa>::functions : &RandomEngine<RandomCombined>::functions;
 }
 
+void RandomNumberGenerator::set_algo(uint8_t algo) {
+	ERR_FAIL_INDEX(algo, algorithm_size);
+	if (randbase && algo != get_chosen_algorithm()) {
+		_profile(RandomProfiler::EVENT_ALGORITHM_SWITCH);
+	}
+	cycling.chosen_algorithm &= 0b11111000;
+	cycling.chosen_algorithm |= algo;
+	_update_engine();
+}
+
+void RandomNumberGenerator::set_cycling(bool p_cycling) {
+	cycling.is_cycling &= 0b01111111;
+	cycling.is_cycling |= p_cycling << 7;
+	_update_engine();
+}
+
+void RandomNumberGenerator::set_cycling_steps(uint8_t p_steps) {
+	cycling.cycling_steps &= 0b10000111;
+	cycling.cycling_steps |= 0b01111000 & ((p_steps % algorithm_size) << 3);
+	_update_engine();
+}
+
+void RandomNumberGenerator::set_float_conversion(FloatConversion p_conversion) {
+	ERR_FAIL_INDEX(p_conversion, FLOAT_CONVERSION_MAX);
+	float_conversion = p_conversion;
+	_update_engine();
+}
+
+RandomNumberGenerator::FloatConversion RandomNumberGenerator::get_float_conversion() const {
+	return float_conversion;
+}
+
+void RandomNumberGenerator::set_seed(uint64_t p_seed) {
+	// Every materialized backend shares the seed, so switching between them stays reproducible.
+	// The others pick it up when first selected.
+	seed_value = p_seed;
+	jump_count = 0;
+	stream_depth = 0;
+	_profile(RandomProfiler::EVENT_RESEED);
+	if (backends[PCG]) {
+		RandomEngine<RandomPCG>::seed(backends[PCG], p_seed);
+	}
+	if (backends[XORSHIFT128]) {
+		RandomEngine<RandomXSH128>::seed(backends[XORSHIFT128], p_seed);
+	}
+	if (backends[XOROSHIRO128]) {
+		RandomEngine<RandomXOSH128>::seed(backends[XOROSHIRO128], p_seed);
+	}
+	if (backends[SPLITMIX64]) {
+		RandomEngine<RandomSPLIT64>::seed(backends[SPLITMIX64], p_seed);
+	}
+	if (backends[PHILOX]) {
+		RandomEngine<RandomPhilox>::seed(backends[PHILOX], p_seed);
+	}
+	if (randbase == &combined) {
+		combined.refresh_seed();
+	}
+}
+
+void RandomNumberGenerator::fill_randi(PoolIntArray &p_array) {
+	PoolIntArray::Write w = p_array.write();
+	engine->fill_randi(randbase, w.ptr(), p_array.size());
+	_profile(RandomProfiler::EVENT_DRAW, p_array.size());
+}
+
+void RandomNumberGenerator::fill_randf(PoolRealArray &p_array, real_t p_from, real_t p_to) {
+	PoolRealArray::Write w = p_array.write();
+	engine->fill_randf(randbase, w.ptr(), p_array.size(), p_from, p_to);
+	_profile(RandomProfiler::EVENT_DRAW, p_array.size());
+}
+
+void RandomNumberGenerator::fill_randfn(PoolRealArray &p_array, real_t p_mean, real_t p_deviation) {
+	PoolRealArray::Write w = p_array.write();
+	engine->fill_randfn(randbase, w.ptr(), p_array.size(), p_mean, p_deviation);
+	_profile(RandomProfiler::EVENT_DRAW, p_array.size());
+}
+
+void RandomNumberGenerator::fill_bytes(PoolByteArray &p_array) {
+	PoolByteArray::Write w = p_array.write();
+	engine->fill_bytes(randbase, w.ptr(), p_array.size());
+	_profile(RandomProfiler::EVENT_DRAW, p_array.size());
+}
+
+void RandomNumberGenerator::jump(int p_times) {
+	ERR_FAIL_COND(p_times < 0);
+	jump_count += p_times;
+	for (int i = 0; i < algorithm_size; i++) {
+		if (backends[i]) {
+			for (int j = 0; j < p_times; j++) {
+				backends[i]->jump();
+			}
+		}
+	}
+}
+
+void RandomNumberGenerator::_long_jump(int p_times) {
+	stream_depth += p_times;
+	for (int i = 0; i < algorithm_size; i++) {
+		if (backends[i]) {
+			for (int j = 0; j < p_times; j++) {
+				backends[i]->long_jump();
+			}
+		}
+	}
+}
+
+void RandomNumberGenerator::make_stream(int p_index, RandomNumberGenerator &r_stream) const {
+	ERR_FAIL_COND(p_index < 0);
+	r_stream._copy_state_from(*this);
+	r_stream._long_jump(p_index + 1);
+}
+
+Ref<RandomNumberGenerator> RandomNumberGenerator::spawn_stream(int p_index) const {
+	ERR_FAIL_COND_V(p_index < 0, Ref<RandomNumberGenerator>());
+	Ref<RandomNumberGenerator> stream;
+	stream.instance();
+	make_stream(p_index, *stream.ptr());
+	return stream;
+}
+
+Array RandomNumberGenerator::split(int p_count) const {
+	Array streams;
+	ERR_FAIL_COND_V(p_count < 0, streams);
+	streams.resize(p_count);
+	// Each stream is the previous one long jumped once more, so the whole split costs p_count long jumps.
+	const RandomNumberGenerator *previous = this;
+	for (int i = 0; i < p_count; i++) {
+		Ref<RandomNumberGenerator> stream;
+		stream.instance();
+		stream->_copy_state_from(*previous);
+		stream->_long_jump(1);
+		streams[i] = stream;
+		previous = stream.ptr();
+	}
+	return streams;
+}
+
+// Header: format version, cycling byte, float conversion, mask of materialized backends,
+// jump count (32 bits), seed (64 bits) and stream depth (32 bits), followed by each
+// materialized backend in order.
+#define RNG_STATE_FORMAT 2
+
+int RandomNumberGenerator::write_state_bytes(uint8_t *r_bytes) const {
+	uint8_t mask = 0;
+	int size = STATE_BYTES_HEADER;
+	for (int i = 0; i < algorithm_size; i++) {
+		if (backends[i]) {
+			mask |= 1 << i;
+			backends[i]->write_state(r_bytes + size);
+			size += Random::STATE_BYTES;
+		}
+	}
+	r_bytes[0] = RNG_STATE_FORMAT;
+	r_bytes[1] = cycling.is_cycling;
+	r_bytes[2] = float_conversion;
+	r_bytes[3] = mask;
+	encode_uint32(jump_count, r_bytes + 4);
+	encode_uint64(seed_value, r_bytes + 8);
+	encode_uint32(stream_depth, r_bytes + 16);
+	return size;
+}
+
+bool RandomNumberGenerator::read_state_bytes(const uint8_t *p_bytes, int p_size) {
+	ERR_FAIL_COND_V_MSG(p_size < STATE_BYTES_HEADER || p_bytes[0] != RNG_STATE_FORMAT, false, "Invalid RandomNumberGenerator state.");
+	const uint8_t mask = p_bytes[3];
+	const uint8_t algo = p_bytes[1] & 0b00000111;
+	int size = STATE_BYTES_HEADER;
+	for (int i = 0; i < algorithm_size; i++) {
+		if (mask & (1 << i)) {
+			size += Random::STATE_BYTES;
+		}
+	}
+	ERR_FAIL_COND_V_MSG(size != p_size || mask >= (1 << algorithm_size) || algo >= algorithm_size || !(mask & (1 << algo)) || p_bytes[2] >= FLOAT_CONVERSION_MAX, false, "Invalid RandomNumberGenerator state.");
+
+	// Materialize with no jumps to replay, the saved state overwrites the generator anyway.
+	seed_value = decode_uint64(p_bytes + 8);
+	jump_count = 0;
+	stream_depth = 0;
+	int offset = STATE_BYTES_HEADER;
+	for (int i = 0; i < algorithm_size; i++) {
+		if (mask & (1 << i)) {
+			_materialize(i)->read_state(p_bytes + offset);
+			offset += Random::STATE_BYTES;
+		} else if (backends[i]) {
+			backends[i]->~Random();
+			backends[i] = nullptr;
+		}
+	}
+	jump_count = decode_uint32(p_bytes + 4);
+	stream_depth = decode_uint32(p_bytes + 16);
+	cycling.is_cycling = p_bytes[1];
+	float_conversion = (FloatConversion)p_bytes[2];
+	_update_engine();
+	return true;
+}
+
+PoolByteArray RandomNumberGenerator::get_state_bytes() const {
+	uint8_t bytes[STATE_BYTES_MAX];
+	const int size = write_state_bytes(bytes);
+	PoolByteArray result;
+	result.resize(size);
+	PoolByteArray::Write w = result.write();
+	memcpy(w.ptr(), bytes, size);
+	return result;
+}
+
+void RandomNumberGenerator::set_state_bytes(const PoolByteArray &p_bytes) {
+	PoolByteArray::Read r = p_bytes.read();
+	read_state_bytes(r.ptr(), p_bytes.size());
+}
+
+void RandomNumberGenerator::copy_state_from(const Ref<RandomNumberGenerator> &p_from) {
+	ERR_FAIL_COND(p_from.is_null());
+	if (p_from.ptr() != this) {
+		_copy_state_from(*p_from.ptr());
+	}
+}
+
+Ref<RandomNumberGenerator> RandomNumberGenerator::duplicate_state() const {
+	Ref<RandomNumberGenerator> copy;
+	copy.instance();
+	copy->_copy_state_from(*this);
+	return copy;
+}
+
+PoolIntArray RandomNumberGenerator::_fill_randi(PoolIntArray p_array) {
+	fill_randi(p_array);
+	return p_array;
+}
+
+PoolRealArray RandomNumberGenerator::_fill_randf(PoolRealArray p_array, real_t p_from, real_t p_to) {
+	fill_randf(p_array, p_from, p_to);
+	return p_array;
+}
+
+PoolRealArray RandomNumberGenerator::_fill_randfn(PoolRealArray p_array, real_t p_mean, real_t p_deviation) {
+	fill_randfn(p_array, p_mean, p_deviation);
+	return p_array;
+}
+
+PoolByteArray RandomNumberGenerator::_fill_bytes(PoolByteArray p_array) {
+	fill_bytes(p_array);
+	return p_array;
+}
 
 void RandomNumberGenerator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_seed", "seed"), &RandomNumberGenerator::set_seed);
@@ -76,17 +426,44 @@ void RandomNumberGenerator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("randi"), &RandomNumberGenerator::randi);
 	ClassDB::bind_method(D_METHOD("randf"), &RandomNumberGenerator::randf);
 	ClassDB::bind_method(D_METHOD("randfn", "mean", "deviation"), &RandomNumberGenerator::randfn, DEFVAL(0.0), DEFVAL(1.0));
+	ClassDB::bind_method(D_METHOD("randfn_pair", "mean", "deviation"), &RandomNumberGenerator::randfn_pair, DEFVAL(0.0), DEFVAL(1.0));
+	ClassDB::bind_method(D_METHOD("randexp", "rate"), &RandomNumberGenerator::randexp, DEFVAL(1.0));
 	ClassDB::bind_method(D_METHOD("randf_range", "from", "to"), &RandomNumberGenerator::randf_range);
 	ClassDB::bind_method(D_METHOD("randi_range", "from", "to"), &RandomNumberGenerator::randi_range);
+	ClassDB::bind_method(D_METHOD("randd"), &RandomNumberGenerator::randd);
+	ClassDB::bind_method(D_METHOD("randd_range", "from", "to"), &RandomNumberGenerator::randd_range);
+	ClassDB::bind_method(D_METHOD("randdn", "mean", "deviation"), &RandomNumberGenerator::randdn, DEFVAL(0.0), DEFVAL(1.0));
 	ClassDB::bind_method(D_METHOD("randomize"), &RandomNumberGenerator::randomize);
 
+	ClassDB::bind_method(D_METHOD("fill_randi", "array"), &RandomNumberGenerator::_fill_randi);
+	ClassDB::bind_method(D_METHOD("fill_randf", "array", "from", "to"), &RandomNumberGenerator::_fill_randf, DEFVAL(0.0), DEFVAL(1.0));
+	ClassDB::bind_method(D_METHOD("fill_randfn", "array", "mean", "deviation"), &RandomNumberGenerator::_fill_randfn, DEFVAL(0.0), DEFVAL(1.0));
+	ClassDB::bind_method(D_METHOD("fill_bytes", "array"), &RandomNumberGenerator::_fill_bytes);
+
+	ClassDB::bind_method(D_METHOD("jump", "times"), &RandomNumberGenerator::jump, DEFVAL(1));
+	ClassDB::bind_method(D_METHOD("spawn_stream", "index"), &RandomNumberGenerator::spawn_stream);
+	ClassDB::bind_method(D_METHOD("split", "count"), &RandomNumberGenerator::split);
+
+	ClassDB::bind_method(D_METHOD("at", "key", "counter"), &RandomNumberGenerator::at);
+
+	ClassDB::bind_method(D_METHOD("get_state_bytes"), &RandomNumberGenerator::get_state_bytes);
+	ClassDB::bind_method(D_METHOD("set_state_bytes", "bytes"), &RandomNumberGenerator::set_state_bytes);
+	ClassDB::bind_method(D_METHOD("copy_state_from", "from"), &RandomNumberGenerator::copy_state_from);
+	ClassDB::bind_method(D_METHOD("duplicate_state"), &RandomNumberGenerator::duplicate_state);
+
 	ClassDB::bind_method(D_METHOD("set_algo", "algorithm"), &RandomNumberGenerator::set_algo);
 	ClassDB::bind_method(D_METHOD("set_cycling", "is_cycling"), &RandomNumberGenerator::set_cycling);
 	ClassDB::bind_method(D_METHOD("set_cycling_steps", "cycling_steps"), &RandomNumberGenerator::set_cycling_steps);
+	ClassDB::bind_method(D_METHOD("set_float_conversion", "conversion"), &RandomNumberGenerator::set_float_conversion);
+	ClassDB::bind_method(D_METHOD("get_float_conversion"), &RandomNumberGenerator::get_float_conversion);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "state"), "set_state", "get_state");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "float_conversion", PROPERTY_HINT_ENUM, "Exact,Mantissa"), "set_float_conversion", "get_float_conversion");
 	// Default values are non-deterministic, override for doc generation purposes.
 	ADD_PROPERTY_DEFAULT("seed", 0);
 	ADD_PROPERTY_DEFAULT("state", 0);
+
+	BIND_ENUM_CONSTANT(FLOAT_CONVERSION_EXACT);
+	BIND_ENUM_CONSTANT(FLOAT_CONVERSION_MANTISSA);
 }
@@ -33,21 +33,41 @@
 
 #include "core/math/random_pcg.h"
 #include "core/math/random.h"
+#include "core/math/random_combined.h"
+#include "core/math/random_engine.h"
 #include "core/math/random_xsh128.h"
 #include "core/math/random_xosh128.h"
+#include "core/math/random_philox.h"
+#include "core/math/random_profiler.h"
 #include "core/math/random_split64.h"
 #include "core/reference.h"
 
 class RandomNumberGenerator : public Reference {
 	GDCLASS(RandomNumberGenerator, Reference);
 
-private:
+public:
+	enum ALGORITHMS {
+		PCG,
+		XORSHIFT128,
+		XOROSHIRO128,
+		SPLITMIX64,
+		PHILOX,
+		ALGORITHM_MAX
+	};
 
-	RandomPCG *p_randbase_pcg = memnew(RandomPCG);
-	RandomXOSH128* p_randbase_xosh128 = memnew(RandomXOSH128);
-	RandomXSH128* p_randbase_xsh128 = memnew(RandomXSH128);
-	RandomSPLIT64* p_randbase_split64 = memnew(RandomSPLIT64);
-	uint8_t const algorithm_size = 4;
+private:
+	// Backends are stored inline and only constructed once selected, so creating and
+	// reseeding a generator never touches the allocator.
+	alignas(RandomPCG) uint8_t storage_pcg[sizeof(RandomPCG)];
+	alignas(RandomXSH128) uint8_t storage_xsh128[sizeof(RandomXSH128)];
+	alignas(RandomXOSH128) uint8_t storage_xosh128[sizeof(RandomXOSH128)];
+	alignas(RandomSPLIT64) uint8_t storage_split64[sizeof(RandomSPLIT64)];
+	alignas(RandomPhilox) uint8_t storage_philox[sizeof(RandomPhilox)];
+	Random *backends[ALGORITHM_MAX] = {};
+	uint64_t seed_value = Random::DEFAULT_SEED; // Applied to backends materialized later.
+	uint32_t jump_count = 0; // Jumps since the last set_seed(), replayed on backends materialized later.
+	uint32_t stream_depth = 0; // Likewise for long jumps, one per stream derivation.
+	uint8_t const algorithm_size = ALGORITHM_MAX;
 
 	union {
 		uint8_t chosen_algorithm;
@@ -55,173 +75,190 @@ private:
 		uint8_t is_cycling;
 	} cycling;
 
-	Random &randbase = *p_randbase_pcg;
+	// Lockstep mix of every backend on the cycling orbit, selected while cycling is enabled.
+	RandomCombined combined;
+
+	// Selected backend (or the combined generator) and its engine table, both resolved in _update_engine().
+	Random *randbase = nullptr;
+	const RandomEngineFunctions *engine = nullptr;
+
+	Random *_materialize(uint8_t p_algo);
+	static const RandomEngineFunctions *_get_engine(uint8_t p_algo, bool p_mantissa);
+	void _update_engine();
+	void _copy_state_from(const RandomNumberGenerator &p_rng);
+	void _long_jump(int p_times);
+
+#ifdef DEBUG_ENABLED
+	RandomProfiler::Counters profile_counters;
+	_FORCE_INLINE_ void _profile(RandomProfiler::Event p_event, uint64_t p_count = 1) { RandomProfiler::record(profile_counters, p_event, p_count); }
+#else
+	_FORCE_INLINE_ void _profile(RandomProfiler::Event p_event, uint64_t p_count = 1) {}
+#endif
 
 protected:
 
 	static void _bind_methods();
 
+	PoolIntArray _fill_randi(PoolIntArray p_array);
+	PoolRealArray _fill_randf(PoolRealArray p_array, real_t p_from, real_t p_to);
+	PoolRealArray _fill_randfn(PoolRealArray p_array, real_t p_mean, real_t p_deviation);
+	PoolByteArray _fill_bytes(PoolByteArray p_array);
+
 public:
-	enum ALGORITHMS {
-		PCG,
-		XORSHIFT128,
-		XOROSHIRO128,
-		SPLITMIX64
+	enum FloatConversion {
+		FLOAT_CONVERSION_EXACT, // CLZ/LDEXP, uniform down to 2^-64 (see Random::clz_double()).
+		FLOAT_CONVERSION_MANTISSA, // 24/53 bit mantissa fill from a single draw.
+		FLOAT_CONVERSION_MAX
 	};
-	_FORCE_INLINE_ void set_seed(uint64_t seed) { randbase.seed(seed); }
 
-	_FORCE_INLINE_ uint64_t get_seed() { return randbase.get_seed(); }
+private:
+	FloatConversion float_conversion = FLOAT_CONVERSION_EXACT;
 
-	_FORCE_INLINE_ void set_state(uint64_t p_state) { randbase.set_state(p_state); }
+public:
+	void set_seed(uint64_t p_seed);
 
-	_FORCE_INLINE_ uint64_t get_state() const { return randbase.get_state(); }
+	_FORCE_INLINE_ uint64_t get_seed() { return randbase->get_seed(); }
+
+	_FORCE_INLINE_ void set_state(uint64_t p_state) {
+		engine->set_state(randbase, p_state);
+		_profile(RandomProfiler::EVENT_RESEED);
+	}
+
+	_FORCE_INLINE_ uint64_t get_state() const { return engine->get_state(randbase); }
 
 	_FORCE_INLINE_ void randomize() {
-		//randbase.randomize();
-		switch (get_chosen_algorithm()) {
-			case PCG:
-				p_randbase_pcg->randomize();
-				break;
-			case XORSHIFT128:
-				p_randbase_xsh128->randomize();
-				break;
-			case XOROSHIRO128:
-				p_randbase_xosh128->randomize();
-				break;
-			case SPLITMIX64:
-				p_randbase_split64->randomize();
-				break;
-		}
-		cycle();
+		engine->randomize(randbase);
+		_profile(RandomProfiler::EVENT_RESEED);
 	}
 
 	_FORCE_INLINE_ uint32_t randi() {
-		//real_t result = randbase.rand();
-		real_t result;
-		switch (get_chosen_algorithm()) {
-			case PCG:
-				result = p_randbase_pcg->rand();
-				break;
-			case XORSHIFT128:
-				result = p_randbase_xsh128->rand();
-				break;
-			case XOROSHIRO128:
-				result = p_randbase_xosh128->rand();
-				break;
-			case SPLITMIX64:
-				result = p_randbase_split64->rand();
-				break;
-		}
-		cycle();
+		uint32_t result = engine->rand(randbase);
+		_profile(RandomProfiler::EVENT_DRAW);
 		return result;
 	}
 
 	_FORCE_INLINE_ real_t randf() {
-		//real_t result = randbase.randf();
-		real_t result;
-		switch (get_chosen_algorithm()) {
-			case PCG:
-				result = p_randbase_pcg->randf();
-				break;
-			case XORSHIFT128:
-				result = p_randbase_xsh128->randf();
-				break;
-			case XOROSHIRO128:
-				result = p_randbase_xosh128->randf();
-				break;
-			case SPLITMIX64:
-				result = p_randbase_split64->randf();
-				break;
-		}
-		cycle();
+		real_t result = engine->randf(randbase);
+		_profile(RandomProfiler::EVENT_DRAW);
 		return result;
 	}
 
 	_FORCE_INLINE_ real_t randf_range(real_t from, real_t to) {
-		//real_t result = randbase.random(from, to);
-		real_t result;
-		switch (get_chosen_algorithm()) {
-			case PCG:
-				result = p_randbase_pcg->random(from,to);
-				break;
-			case XORSHIFT128:
-				result = p_randbase_xsh128->random(from, to);
-				break;
-			case XOROSHIRO128:
-				result = p_randbase_xosh128->random(from, to);
-				break;
-			case SPLITMIX64:
-				result = p_randbase_split64->random(from, to);
-				break;
-		}
-		cycle();
+		real_t result = engine->random(randbase, from, to);
+		_profile(RandomProfiler::EVENT_DRAW);
 		return result;
 	}
 
 	_FORCE_INLINE_ real_t randfn(real_t mean = 0.0, real_t deviation = 1.0) {
-		//real_t result = randbase.randfn(mean, deviation);
-		real_t result;
-		switch (get_chosen_algorithm()) {
-			case PCG:
-				result = p_randbase_pcg->randfn(mean, deviation);
-				break;
-			case XORSHIFT128:
-				result = p_randbase_xsh128->randfn(mean, deviation);
-				break;
-			case XOROSHIRO128:
-				result = p_randbase_xosh128->randfn(mean, deviation);
-				break;
-			case SPLITMIX64:
-				result = p_randbase_split64->randfn(mean, deviation);
-				break;
-		}
-		cycle();
+		real_t result = engine->randfn(randbase, mean, deviation);
+		_profile(RandomProfiler::EVENT_DRAW);
 		return result;
 	}
 
-	_FORCE_INLINE_ void cycle() {
-		if (is_cycling()) {
-			set_algo((get_chosen_algorithm() + get_cycling_steps()) % algorithm_size);
-		}
+	// Double precision variants, 53 bits or more whatever real_t is. They go through the same
+	// float conversion as randf() (see set_float_conversion()).
+	_FORCE_INLINE_ double randd() {
+		double result = engine->randd(randbase);
+		_profile(RandomProfiler::EVENT_DRAW);
+		return result;
 	}
-	_FORCE_INLINE_ bool is_cycling(){
-		return (cycling.is_cycling & 0b10000000) == 0b10000000;
-	};
-	_FORCE_INLINE_ void set_cycling(bool is_cycling) {
-		this->cycling.is_cycling &= 0b10000000;
-		this->cycling.is_cycling |= is_cycling << 7;
+
+	_FORCE_INLINE_ double randd_range(double p_from, double p_to) {
+		double result = engine->random_double(randbase, p_from, p_to);
+		_profile(RandomProfiler::EVENT_DRAW);
+		return result;
+	}
+
+	_FORCE_INLINE_ double randdn(double p_mean = 0.0, double p_deviation = 1.0) {
+		double result = engine->randdn(randbase, p_mean, p_deviation);
+		_profile(RandomProfiler::EVENT_DRAW);
+		return result;
 	}
-	_FORCE_INLINE_ void set_cycling_steps(uint8_t cycling_steps) {
-		this->cycling.cycling_steps &= 0b10000011;
-		this->cycling.cycling_steps |= 0b01111100 & (cycling_steps << 2);
+
+	// Both normals of one Box-Muller transform, for 2D spreads and other paired uses.
+	_FORCE_INLINE_ Vector2 randfn_pair(real_t p_mean = 0.0, real_t p_deviation = 1.0) {
+		Vector2 result;
+		engine->randfn_pair(randbase, p_mean, p_deviation, result.x, result.y);
+		_profile(RandomProfiler::EVENT_DRAW);
+		return result;
+	}
+
+	_FORCE_INLINE_ real_t randexp(real_t p_rate = 1.0) {
+		real_t result = engine->randexp(randbase, p_rate);
+		_profile(RandomProfiler::EVENT_DRAW);
+		return result;
 	}
-	_FORCE_INLINE_ uint8_t get_cycling_steps() {
-		return (cycling.cycling_steps & 0b01111100) >> 2;
+
+	// Bulk fills lock the array once and pay the dispatch once per call.
+	void fill_randi(PoolIntArray &p_array);
+	void fill_randf(PoolRealArray &p_array, real_t p_from = 0.0, real_t p_to = 1.0);
+	void fill_randfn(PoolRealArray &p_array, real_t p_mean = 0.0, real_t p_deviation = 1.0);
+	void fill_bytes(PoolByteArray &p_array);
+
+	// Substreams: each jump() skips 2^64 draws (2^48 for 64-bit state backends). Stream i is
+	// the parent long jumped i + 1 times (Random::long_jump(): 2^96 draws for the xorshift
+	// family, 2^56 for the others), past the jump() substreams and bulk fill lanes of the parent.
+	// So stream i doesn't overlap the parent, its fills or its first jumps (2^32 of them, 2^8 for
+	// 64-bit state backends), nor stream j. Results depend only on the index, not on how work
+	// is spread over threads.
+	void jump(int p_times = 1);
+	void make_stream(int p_index, RandomNumberGenerator &r_stream) const;
+	Ref<RandomNumberGenerator> spawn_stream(int p_index) const;
+	Array split(int p_count) const;
+
+	// Exact snapshots for rollback and replays: every materialized backend's full state plus
+	// the seed, jumps, cycling and float conversion. A header of STATE_BYTES_HEADER bytes is
+	// followed by Random::STATE_BYTES per materialized backend, so sizes vary up to STATE_BYTES_MAX.
+	static const int STATE_BYTES_HEADER = 20;
+	static const int STATE_BYTES_MAX = STATE_BYTES_HEADER + ALGORITHM_MAX * Random::STATE_BYTES;
+	int write_state_bytes(uint8_t *r_bytes) const;
+	bool read_state_bytes(const uint8_t *p_bytes, int p_size);
+	PoolByteArray get_state_bytes() const;
+	void set_state_bytes(const PoolByteArray &p_bytes);
+
+	// In-place copy of another generator's complete state. Backends live in inline storage,
+	// so this never allocates.
+	void copy_state_from(const Ref<RandomNumberGenerator> &p_from);
+	Ref<RandomNumberGenerator> duplicate_state() const;
+
+	// Random access into the PHILOX stream keyed by p_key, independent of this generator's
+	// state: at(k, n) is the n-th randi() after set_seed(k) with the PHILOX algorithm.
+	_FORCE_INLINE_ uint32_t at(uint64_t p_key, uint64_t p_counter) const { return RandomPhilox::at(p_key, p_counter); }
+
+	// Cycling mixes the chosen backend with the ones reached by repeatedly adding the steps
+	// (modulo the algorithm count), all advancing together on every draw.
+	_FORCE_INLINE_ bool is_cycling() const {
+		return (cycling.is_cycling & 0b10000000) == 0b10000000;
+	};
+	void set_cycling(bool p_cycling);
+	// Steps only matter modulo the algorithm count, which keeps them within their 4 bits.
+	void set_cycling_steps(uint8_t p_steps);
+	_FORCE_INLINE_ uint8_t get_cycling_steps() const {
+		return (cycling.cycling_steps & 0b01111000) >> 3;
 	}
 
-	_FORCE_INLINE_ uint8_t get_chosen_algorithm() {
-		return (cycling.cycling_steps & 0b00000011);
+	_FORCE_INLINE_ uint8_t get_chosen_algorithm() const {
+		return (cycling.cycling_steps & 0b00000111);
 	}
 
 	_FORCE_INLINE_ int randi_range(int from, int to) {
-		unsigned int ret = randbase.rand();
-		int result;
-		
-		if (to < from) {
-			result = ret % (from - to + 1) + to;
-		} else {
-			result = ret % (to - from + 1) + from;
-		}
-
-		cycle();
+		int result = engine->rand_range(randbase, from, to);
+		_profile(RandomProfiler::EVENT_DRAW);
 		return result;
 	};
 	
 void set_algo(uint8_t algo);
+
+void set_float_conversion(FloatConversion p_conversion);
+FloatConversion get_float_conversion() const;
+
 //void operator=(const RandomNumberGenerator p_rng);
 RandomNumberGenerator();
 RandomNumberGenerator(uint8_t algo);
 RandomNumberGenerator(const RandomNumberGenerator &rng);
+~RandomNumberGenerator();
 };
 
+VARIANT_ENUM_CAST(RandomNumberGenerator::FloatConversion);
+
 #endif // RANDOM_NUMBER_GENERATOR_H
@@ -30,6 +30,7 @@
 
 #include "random_pcg.h"
 
+#include "core/io/marshalls.h"
 #include "core/os/os.h"
 
 RandomPCG::RandomPCG(uint64_t p_seed, uint64_t p_inc) :
@@ -37,3 +38,16 @@ RandomPCG::RandomPCG(uint64_t p_seed, uint64_t p_inc) :
 	current_inc = p_inc;
 	seed(p_seed);
 };
+
+void RandomPCG::write_state(uint8_t *r_bytes) const {
+	encode_uint64(current_seed, r_bytes);
+	encode_uint64(pcg.state, r_bytes + 8);
+	encode_uint64(pcg.inc, r_bytes + 16);
+}
+
+void RandomPCG::read_state(const uint8_t *p_bytes) {
+	current_seed = decode_uint64(p_bytes);
+	pcg.state = decode_uint64(p_bytes + 8);
+	pcg.inc = decode_uint64(p_bytes + 16);
+	current_inc = pcg.inc >> 1;
+}
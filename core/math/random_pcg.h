@@ -35,7 +35,7 @@
 #include <core/math/random.h>
 #include <core/print_string.h>
 
-class RandomPCG : public virtual Random {
+class RandomPCG final : public Random {
 	pcg32_random_t pcg;
 	
 
@@ -50,6 +50,11 @@ public:
 
 	_FORCE_INLINE_ void set_state(uint64_t p_state) { pcg.state = p_state; };
 	_FORCE_INLINE_ uint64_t get_state() const { return pcg.state; };
+	virtual void write_state(uint8_t *r_bytes) const;
+	virtual void read_state(const uint8_t *p_bytes);
+	_FORCE_INLINE_ void advance(uint64_t p_delta) { pcg32_advance_r(&pcg, p_delta); };
+	virtual void jump() { advance(JUMP_DISTANCE_64); };
+	virtual void long_jump() { advance(LONG_JUMP_DISTANCE_64); };
 
 
 	
@@ -58,6 +63,11 @@ public:
 		current_seed = pcg.state;
 		return pcg32_random_r(&pcg);
 	};
+	_FORCE_INLINE_ uint64_t rand64() {
+		// Two statements, the order of calls inside one expression is unspecified.
+		const uint64_t high = rand();
+		return (high << 32) | rand();
+	};
 
 	// Obtaining floating point numbers in [0, 1] range with "good enough" uniformity.
 	// These functions sample the output of rand() as the fraction part of an infinite binary number,
@@ -98,10 +108,10 @@ public:
 	};
 
 	_FORCE_INLINE_ double randfn(double p_mean, double p_deviation) {
-		return p_mean + p_deviation * (cos(Math_TAU * randd()) * sqrt(-2.0 * log(randd()))); // Box-Muller transform
+		return p_mean + p_deviation * normal(*this); // Ziggurat, see Random::normal().
 	};
 	_FORCE_INLINE_ float randfn(float p_mean, float p_deviation) {
-		return p_mean + p_deviation * (cos(Math_TAU * randf()) * sqrt(-2.0 * log(randf()))); // Box-Muller transform
+		return p_mean + p_deviation * (float)normal(*this);
 	};
 
 };
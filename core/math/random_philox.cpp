@@ -0,0 +1,116 @@
+/*************************************************************************/
+/*  random_philox.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "random_philox.h"
+
+#include "core/io/marshalls.h"
+
+// Blocks processed together by generate(). Each round is written over the whole batch,
+// so the 32x32->64 multiplies map onto vector lanes.
+#define PHILOX_BATCH 8
+
+RandomPhilox::RandomPhilox(uint64_t p_seed, uint64_t p_inc) {
+	current_inc = p_inc;
+	seed(p_seed);
+}
+
+void RandomPhilox::generate(uint64_t p_key, uint64_t p_counter, uint32_t *p_dst, int p_count) {
+	uint32_t words[4];
+
+	// Leading words up to the next block boundary.
+	while (p_count > 0 && (p_counter & 3) != 0) {
+		block(p_key, p_counter >> 2, words);
+		const int n = MIN(p_count, 4 - (int)(p_counter & 3));
+		for (int i = 0; i < n; i++) {
+			p_dst[i] = words[(p_counter & 3) + i];
+		}
+		p_dst += n;
+		p_counter += n;
+		p_count -= n;
+	}
+
+	uint64_t first = p_counter >> 2;
+	while (p_count >= PHILOX_BATCH * 4) {
+		uint32_t x0[PHILOX_BATCH], x1[PHILOX_BATCH], x2[PHILOX_BATCH], x3[PHILOX_BATCH];
+		for (int b = 0; b < PHILOX_BATCH; b++) {
+			x0[b] = (uint32_t)(first + b);
+			x1[b] = (uint32_t)((first + b) >> 32);
+			x2[b] = 0;
+			x3[b] = 0;
+		}
+		uint32_t k0 = (uint32_t)p_key;
+		uint32_t k1 = (uint32_t)(p_key >> 32);
+		for (int r = 0; r < ROUNDS; r++) {
+			for (int b = 0; b < PHILOX_BATCH; b++) {
+				const uint64_t p0 = (uint64_t)MULTIPLIER_0 * x0[b];
+				const uint64_t p1 = (uint64_t)MULTIPLIER_1 * x2[b];
+				x0[b] = (uint32_t)(p1 >> 32) ^ x1[b] ^ k0;
+				x1[b] = (uint32_t)p1;
+				x2[b] = (uint32_t)(p0 >> 32) ^ x3[b] ^ k1;
+				x3[b] = (uint32_t)p0;
+			}
+			k0 += WEYL_0;
+			k1 += WEYL_1;
+		}
+		for (int b = 0; b < PHILOX_BATCH; b++) {
+			p_dst[b * 4 + 0] = x0[b];
+			p_dst[b * 4 + 1] = x1[b];
+			p_dst[b * 4 + 2] = x2[b];
+			p_dst[b * 4 + 3] = x3[b];
+		}
+		p_dst += PHILOX_BATCH * 4;
+		first += PHILOX_BATCH;
+		p_count -= PHILOX_BATCH * 4;
+	}
+
+	// Trailing blocks, the last one possibly partial.
+	while (p_count > 0) {
+		block(p_key, first++, words);
+		const int n = MIN(p_count, 4);
+		for (int i = 0; i < n; i++) {
+			p_dst[i] = words[i];
+		}
+		p_dst += n;
+		p_count -= n;
+	}
+}
+
+void RandomPhilox::write_state(uint8_t *r_bytes) const {
+	encode_uint64(current_seed, r_bytes);
+	encode_uint64(counter, r_bytes + 8);
+	encode_uint64(0, r_bytes + 16);
+}
+
+void RandomPhilox::read_state(const uint8_t *p_bytes) {
+	current_seed = decode_uint64(p_bytes);
+	counter = decode_uint64(p_bytes + 8);
+	cached_block = ~0ULL; // Keyed by the old seed.
+}
@@ -0,0 +1,158 @@
+/*************************************************************************/
+/*  random_philox.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_PHILOX_H
+#define RANDOM_PHILOX_H
+
+#include "core/math/random.h"
+#include "core/math/random_engine.h"
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// A counter-based generator: word n of the stream keyed by k is a pure function of (k, n),
+// so any position can be read in O(1) and no state has to be shared between threads or peers.
+// Each block of 4 words is ten rounds of multiply/xor over the block index, with no dependency
+// between blocks, which lets the batch path below vectorize across counters.
+class RandomPhilox final : public Random {
+	uint64_t counter = 0; // Index of the next 32-bit word.
+	uint64_t cached_block = ~0ULL; // Block whose words are in cached_words, never a valid index.
+	uint32_t cached_words[4];
+
+public:
+	static const uint32_t MULTIPLIER_0 = 0xD2511F53;
+	static const uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+	static const uint32_t WEYL_0 = 0x9E3779B9;
+	static const uint32_t WEYL_1 = 0xBB67AE85;
+	static const int ROUNDS = 10;
+
+	static _FORCE_INLINE_ void block(uint64_t p_key, uint64_t p_block, uint32_t r_words[4]) {
+		uint32_t k0 = (uint32_t)p_key;
+		uint32_t k1 = (uint32_t)(p_key >> 32);
+		uint32_t x0 = (uint32_t)p_block;
+		uint32_t x1 = (uint32_t)(p_block >> 32);
+		uint32_t x2 = 0;
+		uint32_t x3 = 0;
+		for (int r = 0; r < ROUNDS; r++) {
+			const uint64_t p0 = (uint64_t)MULTIPLIER_0 * x0;
+			const uint64_t p1 = (uint64_t)MULTIPLIER_1 * x2;
+			x0 = (uint32_t)(p1 >> 32) ^ x1 ^ k0;
+			x1 = (uint32_t)p1;
+			x2 = (uint32_t)(p0 >> 32) ^ x3 ^ k1;
+			x3 = (uint32_t)p0;
+			k0 += WEYL_0;
+			k1 += WEYL_1;
+		}
+		r_words[0] = x0;
+		r_words[1] = x1;
+		r_words[2] = x2;
+		r_words[3] = x3;
+	}
+
+	// Word p_counter of the stream keyed by p_key, equal to the p_counter-th rand() after seed(p_key).
+	static _FORCE_INLINE_ uint32_t at(uint64_t p_key, uint64_t p_counter) {
+		uint32_t words[4];
+		block(p_key, p_counter >> 2, words);
+		return words[p_counter & 3];
+	}
+
+	// Writes words [p_counter, p_counter + p_count) of the stream keyed by p_key.
+	static void generate(uint64_t p_key, uint64_t p_counter, uint32_t *p_dst, int p_count);
+
+	RandomPhilox(uint64_t p_seed = DEFAULT_SEED, uint64_t p_inc = DEFAULT_INC);
+
+	// The seed is the key, the state is the counter.
+	_FORCE_INLINE_ virtual void seed(uint64_t p_seed) {
+		current_seed = p_seed;
+		counter = 0;
+		cached_block = ~0ULL;
+	};
+	_FORCE_INLINE_ virtual void set_state(uint64_t p_state) {
+		counter = p_state;
+	};
+	_FORCE_INLINE_ virtual uint64_t get_state() const {
+		return counter;
+	};
+	virtual void write_state(uint8_t *r_bytes) const;
+	virtual void read_state(const uint8_t *p_bytes);
+	virtual void jump() {
+		counter += JUMP_DISTANCE_64;
+	};
+	virtual void long_jump() {
+		counter += LONG_JUMP_DISTANCE_64;
+	};
+
+	_FORCE_INLINE_ virtual uint32_t rand() {
+		const uint64_t index = counter >> 2;
+		if (index != cached_block) {
+			block(current_seed, index, cached_words);
+			cached_block = index;
+		}
+		return cached_words[counter++ & 3];
+	};
+	_FORCE_INLINE_ uint64_t rand64() {
+		const uint64_t low = rand();
+		return low | ((uint64_t)rand() << 32);
+	};
+
+	// Same word order as rand(), without touching the block cache.
+	_FORCE_INLINE_ void fill(uint32_t *p_dst, int p_count) {
+		generate(current_seed, counter, p_dst, p_count);
+		counter += p_count;
+	}
+
+	// [0, 1] with the same CLZ/LDEXP technique as RandomPCG.
+	_FORCE_INLINE_ virtual double randd() {
+		uint64_t exponent_bits = rand64();
+		return clz_double(exponent_bits, rand64());
+	};
+	_FORCE_INLINE_ virtual float randf() {
+		return clz_float(rand64());
+	};
+};
+
+// Bulk fills run the batched block function instead of stepping the word cache.
+template <>
+class RandomBulkSource<RandomPhilox> {
+	RandomPhilox *rand;
+
+public:
+	_FORCE_INLINE_ void fill(uint64_t *p_dst, int p_count) {
+		uint32_t words[RANDOM_BULK_BLOCK * 2];
+		rand->fill(words, p_count * 2);
+		for (int i = 0; i < p_count; i++) {
+			p_dst[i] = words[i * 2] | ((uint64_t)words[i * 2 + 1] << 32);
+		}
+	}
+
+	RandomBulkSource(RandomPhilox *p_rand, int p_words) :
+			rand(p_rand) {}
+};
+
+#endif // RANDOM_PHILOX_H
@@ -0,0 +1,77 @@
+/*************************************************************************/
+/*  random_pool_vector.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef RANDOM_POOL_VECTOR_H
+#define RANDOM_POOL_VECTOR_H
+
+#include "core/math/random.h"
+#include "core/pool_vector.h"
+
+// Seeded shuffle() and sample() of the pool arrays, kept out of pool_vector.h so the RNG
+// headers only reach the few places that use them. p_rand is a random source with rand()
+// and rand64(), see core/math/random_source.h.
+
+template <class T, class R>
+void random_shuffle(PoolVector<T> &r_array, R &p_rand) {
+	int len = r_array.size();
+	if (len < 2) {
+		return;
+	}
+
+	typename PoolVector<T>::Write w = r_array.write();
+	Random::shuffle(p_rand, w.ptr(), len);
+}
+
+// p_count distinct elements of p_array in random order, p_array is left untouched.
+template <class T, class R>
+PoolVector<T> random_sample(const PoolVector<T> &p_array, int p_count, R &p_rand) {
+	int len = p_array.size();
+	ERR_FAIL_COND_V_MSG(p_count < 0 || p_count > len, PoolVector<T>(), "Sample size must be between 0 and the array size.");
+
+	PoolVector<T> result;
+	if (p_count * 4 >= len) {
+		// Dense sample, shuffling the front of a copy is cheapest.
+		result = p_array;
+		{
+			typename PoolVector<T>::Write w = result.write();
+			Random::partial_shuffle(p_rand, w.ptr(), len, p_count);
+		}
+		result.resize(p_count);
+	} else {
+		result.resize(p_count);
+		typename PoolVector<T>::Read r = p_array.read();
+		typename PoolVector<T>::Write w = result.write();
+		Random::reservoir_sample(p_rand, r.ptr(), len, w.ptr(), p_count);
+		Random::shuffle(p_rand, w.ptr(), p_count);
+	}
+	return result;
+}
+
+#endif // RANDOM_POOL_VECTOR_H
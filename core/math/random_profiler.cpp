@@ -0,0 +1,226 @@
+/*************************************************************************/
+/*  random_profiler.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "random_profiler.h"
+
+#include "core/array.h"
+#include "core/hash_map.h"
+#include "core/local_vector.h"
+#include "core/os/mutex.h"
+#include "core/os/thread.h"
+#include "core/script_language.h"
+#include "core/sort_array.h"
+
+// Entries sent to the script debugger each frame, hottest first.
+#define RANDOM_PROFILER_MAX_ENTRIES 32
+
+SafeFlag RandomProfiler::active;
+uint64_t RandomProfiler::frame_totals[RandomProfiler::EVENT_MAX] = {};
+
+static Mutex profiler_mutex;
+static LocalVector<RandomProfiler::Counters *> profiler_generators;
+static RandomProfiler::Site *profiler_sites = nullptr;
+static HashMap<String, uint64_t> profiler_script_draws; // Since the previous end_frame().
+static RandomProfiler::Counters profiler_global;
+static thread_local RandomProfiler::Site *current_site = nullptr;
+
+struct RandomProfilerEntry {
+	String name;
+	uint64_t draws;
+};
+
+struct RandomProfilerEntrySort {
+	_FORCE_INLINE_ bool operator()(const RandomProfilerEntry &p_a, const RandomProfilerEntry &p_b) const {
+		return p_a.draws > p_b.draws;
+	}
+};
+
+static LocalVector<RandomProfilerEntry> profiler_report; // Previous frame, hottest first.
+
+RandomProfiler::SiteScope::SiteScope(Site *p_site) {
+	if (likely(!is_active())) {
+		return;
+	}
+	if (unlikely(!p_site->registered.is_set())) {
+		MutexLock lock(profiler_mutex);
+		if (!p_site->registered.is_set()) {
+			p_site->next = profiler_sites;
+			profiler_sites = p_site;
+			p_site->registered.set();
+		}
+	}
+	previous = current_site;
+	current_site = p_site;
+	entered = true;
+}
+
+RandomProfiler::SiteScope::~SiteScope() {
+	if (entered) {
+		current_site = previous;
+	}
+}
+
+void RandomProfiler::set_active(bool p_active) {
+	active.set_to(p_active);
+}
+
+void RandomProfiler::_record(Counters &p_counters, Event p_event, uint64_t p_count) {
+	if (unlikely(!p_counters.registered.is_set())) {
+		MutexLock lock(profiler_mutex);
+		if (!p_counters.registered.is_set()) {
+			profiler_generators.push_back(&p_counters);
+			p_counters.registered.set();
+		}
+	}
+	p_counters.events[p_event].add(p_count);
+
+	if (p_event != EVENT_DRAW) {
+		return;
+	}
+	if (current_site) {
+		current_site->draws.add(p_count);
+		return;
+	}
+	// Script call stacks are only tracked on the main thread, and only under the debugger.
+	if (!ScriptDebugger::get_singleton() || Thread::get_caller_id() != Thread::get_main_id()) {
+		return;
+	}
+	for (int i = 0; i < ScriptServer::get_language_count(); i++) {
+		ScriptLanguage *language = ScriptServer::get_language(i);
+		if (language->debug_get_stack_level_count() > 0) {
+			const String key = language->debug_get_stack_level_source(0) + ":" + itos(language->debug_get_stack_level_line(0));
+			MutexLock lock(profiler_mutex);
+			uint64_t *draws = profiler_script_draws.getptr(key);
+			if (draws) {
+				*draws += p_count;
+			} else {
+				profiler_script_draws.set(key, p_count);
+			}
+			return;
+		}
+	}
+}
+
+void RandomProfiler::_record_global(Event p_event, uint64_t p_count) {
+	_record(profiler_global, p_event, p_count);
+}
+
+void RandomProfiler::unregister(Counters &p_counters) {
+	if (!p_counters.registered.is_set()) {
+		return;
+	}
+	MutexLock lock(profiler_mutex);
+	for (uint32_t i = 0; i < profiler_generators.size(); i++) {
+		if (profiler_generators[i] == &p_counters) {
+			profiler_generators.remove_unordered(i);
+			break;
+		}
+	}
+	p_counters.registered.clear();
+}
+
+void RandomProfiler::end_frame() {
+	if (likely(!is_active())) {
+		if (frame_totals[EVENT_DRAW] || frame_totals[EVENT_RESEED] || frame_totals[EVENT_ALGORITHM_SWITCH]) {
+			for (int i = 0; i < EVENT_MAX; i++) {
+				frame_totals[i] = 0;
+			}
+			profiler_report.clear();
+		}
+		return;
+	}
+
+	LocalVector<RandomProfilerEntry> &entries = profiler_report;
+	entries.clear();
+	{
+		MutexLock lock(profiler_mutex);
+		for (int i = 0; i < EVENT_MAX; i++) {
+			frame_totals[i] = 0;
+		}
+		for (uint32_t i = 0; i < profiler_generators.size(); i++) {
+			Counters &counters = *profiler_generators[i];
+			for (int j = 0; j < EVENT_MAX; j++) {
+				const uint64_t value = counters.events[j].get();
+				frame_totals[j] += value - counters.last_frame[j];
+				if (j == EVENT_DRAW && value != counters.last_frame[j]) {
+					RandomProfilerEntry entry;
+					entry.name = counters.owner ? "RandomNumberGenerator #" + itos(counters.owner) : String("Math::rand()");
+					entry.draws = value - counters.last_frame[j];
+					entries.push_back(entry);
+				}
+				counters.last_frame[j] = value;
+			}
+		}
+		for (Site *site = profiler_sites; site; site = site->next) {
+			const uint64_t value = site->draws.get();
+			if (value != site->last_frame) {
+				RandomProfilerEntry entry;
+				entry.name = String(site->file) + ":" + itos(site->line) + " (" + site->name + ")";
+				entry.draws = value - site->last_frame;
+				entries.push_back(entry);
+				site->last_frame = value;
+			}
+		}
+		const String *key = nullptr;
+		while ((key = profiler_script_draws.next(key))) {
+			RandomProfilerEntry entry;
+			entry.name = *key;
+			entry.draws = profiler_script_draws[*key];
+			entries.push_back(entry);
+		}
+		profiler_script_draws.clear();
+	}
+
+	SortArray<RandomProfilerEntry, RandomProfilerEntrySort> sorter;
+	sorter.sort(entries.ptr(), entries.size());
+	if (entries.size() > RANDOM_PROFILER_MAX_ENTRIES) {
+		entries.resize(RANDOM_PROFILER_MAX_ENTRIES);
+	}
+
+	if (ScriptDebugger::get_singleton() && ScriptDebugger::get_singleton()->is_profiling()) {
+		ScriptDebugger::get_singleton()->add_profiling_frame_data("random_draws", get_frame_report());
+	}
+}
+
+uint64_t RandomProfiler::get_frame_total(Event p_event) {
+	ERR_FAIL_INDEX_V(p_event, EVENT_MAX, 0);
+	return frame_totals[p_event];
+}
+
+Array RandomProfiler::get_frame_report() {
+	Array report;
+	report.resize(profiler_report.size() * 2);
+	for (uint32_t i = 0; i < profiler_report.size(); i++) {
+		report[i * 2 + 0] = profiler_report[i].name;
+		report[i * 2 + 1] = profiler_report[i].draws; // Integers are shown as counts rather than times.
+	}
+	return report;
+}
@@ -0,0 +1,129 @@
+/*************************************************************************/
+/*  random_profiler.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_PROFILER_H
+#define RANDOM_PROFILER_H
+
+#include "core/object_id.h"
+#include "core/safe_refcount.h"
+#include "core/typedefs.h"
+
+class Array;
+
+// Opt-in accounting of random number use: draws, reseeds and algorithm switches, per
+// RandomNumberGenerator, for the global Math::rand() generator, and per call site. Draws are
+// charged to the innermost RANDOM_PROFILE_SCOPE() on the calling thread, or else to the
+// script line making them (when the script debugger tracks the call stack).
+// While inactive, every hook is a single flag test. Counters are only compiled in with
+// DEBUG_ENABLED.
+class RandomProfiler {
+public:
+	enum Event {
+		EVENT_DRAW,
+		EVENT_RESEED,
+		EVENT_ALGORITHM_SWITCH,
+		EVENT_MAX
+	};
+
+	// Embedded in each generator; registered with the profiler on its first recorded event.
+	struct Counters {
+		SafeNumeric<uint64_t> events[EVENT_MAX];
+		uint64_t last_frame[EVENT_MAX] = {}; // Values at the previous end_frame().
+		ObjectID owner = 0; // 0 for the global generator.
+		// Tested without profiler_mutex by the recording thread, set under it.
+		SafeFlag registered;
+	};
+
+	struct Site {
+		const char *file;
+		int line;
+		const char *name;
+		SafeNumeric<uint64_t> draws;
+		uint64_t last_frame = 0;
+		Site *next = nullptr;
+		SafeFlag registered; // Same as Counters::registered.
+
+		Site(const char *p_file, int p_line, const char *p_name) :
+				file(p_file),
+				line(p_line),
+				name(p_name) {}
+	};
+
+	class SiteScope {
+		Site *previous = nullptr;
+		bool entered = false;
+
+	public:
+		SiteScope(Site *p_site);
+		~SiteScope();
+	};
+
+private:
+	static SafeFlag active;
+	static uint64_t frame_totals[EVENT_MAX];
+
+	static void _record(Counters &p_counters, Event p_event, uint64_t p_count);
+	static void _record_global(Event p_event, uint64_t p_count);
+
+public:
+	static _FORCE_INLINE_ bool is_active() { return active.is_set(); }
+	static void set_active(bool p_active);
+
+	static _FORCE_INLINE_ void record(Counters &p_counters, Event p_event, uint64_t p_count = 1) {
+		if (unlikely(is_active())) {
+			_record(p_counters, p_event, p_count);
+		}
+	}
+	// Math::rand() and the other global functions.
+	static _FORCE_INLINE_ void record_global(Event p_event, uint64_t p_count = 1) {
+		if (unlikely(is_active())) {
+			_record_global(p_event, p_count);
+		}
+	}
+	static void unregister(Counters &p_counters);
+
+	// Called once per frame by the main loop: computes the frame totals and, while the script
+	// debugger profiles, sends the hottest generators and call sites to it.
+	static void end_frame();
+	static uint64_t get_frame_total(Event p_event);
+	static Array get_frame_report();
+};
+
+#ifdef DEBUG_ENABLED
+// Charges the random draws made until the end of the enclosing block, on this thread, to this line.
+#define RANDOM_PROFILE_SCOPE(m_name)                                              \
+	static RandomProfiler::Site _random_profile_site(__FILE__, __LINE__, m_name); \
+	RandomProfiler::SiteScope _random_profile_scope(&_random_profile_site)
+#else
+#define RANDOM_PROFILE_SCOPE(m_name)
+#endif
+
+#endif // RANDOM_PROFILER_H
@@ -0,0 +1,170 @@
+/*************************************************************************/
+/*  random_sequence.h                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_SEQUENCE_H
+#define RANDOM_SEQUENCE_H
+
+#include "core/math/vector2.h"
+#include "core/typedefs.h"
+
+// Low-discrepancy sample patterns for Monte Carlo integration (e.g. lightmap baking).
+// Unlike the Random backends these are not independent streams: the point of a sequence is
+// that its first n points cover [0, 1)^2 evenly, so estimates converge faster than with white
+// noise. Points are addressed by sample index and by dimension pair, so each bounce or light
+// of a path gets its own 2D pattern. The seed scrambles the pattern (one seed per texel keeps
+// neighbouring texels from sharing error), except for SEQUENCE_BLUE_NOISE, which offsets each
+// pixel by an R2 dither mask so the remaining error is spread as high-frequency noise.
+class RandomSequence {
+public:
+	enum Type {
+		SEQUENCE_RANDOM, // Hashed white noise, for reference.
+		SEQUENCE_SOBOL, // Sobol (0, 2)-sequence with Owen scrambling and per-pair index shuffling.
+		SEQUENCE_HALTON, // Halton bases 2 and 3 with a Cranley-Patterson rotation.
+		SEQUENCE_R2, // Roberts' additive recurrence on the plastic number, rotated.
+		SEQUENCE_BLUE_NOISE, // R2 offset per pixel by an R2 dither mask.
+		SEQUENCE_MAX
+	};
+
+private:
+	// 2^32 / plastic number and 2^32 / plastic number^2.
+	static const uint32_t R2_ALPHA_X = 0xC13FA9A9;
+	static const uint32_t R2_ALPHA_Y = 0x91E10DA6;
+
+	Type type = SEQUENCE_SOBOL;
+	uint32_t seed = 0;
+	uint32_t pixel_shift_x = 0;
+	uint32_t pixel_shift_y = 0;
+
+	static _FORCE_INLINE_ uint32_t _hash(uint32_t p_value) {
+		p_value ^= p_value >> 16;
+		p_value *= 0x7FEB352D;
+		p_value ^= p_value >> 15;
+		p_value *= 0x846CA68B;
+		p_value ^= p_value >> 16;
+		return p_value;
+	}
+
+	static _FORCE_INLINE_ uint32_t _reverse_bits(uint32_t p_value) {
+		p_value = ((p_value >> 1) & 0x55555555) | ((p_value & 0x55555555) << 1);
+		p_value = ((p_value >> 2) & 0x33333333) | ((p_value & 0x33333333) << 2);
+		p_value = ((p_value >> 4) & 0x0F0F0F0F) | ((p_value & 0x0F0F0F0F) << 4);
+		return BSWAP32(p_value);
+	}
+
+	// Laine and Karras' hash, as refined by Burley: an Owen scramble of the bit-reversed value,
+	// i.e. each bit is flipped depending only on the bits above it.
+	static _FORCE_INLINE_ uint32_t _owen_scramble(uint32_t p_value, uint32_t p_seed) {
+		uint32_t x = _reverse_bits(p_value);
+		x += p_seed;
+		x ^= x * 0x6C50B47C;
+		x ^= x * 0xB82F1E52;
+		x ^= x * 0xC7AFE638;
+		x ^= x * 0x8D22F6E6;
+		return _reverse_bits(x);
+	}
+
+	// Second Sobol dimension; the first is the bit-reversed index.
+	static _FORCE_INLINE_ uint32_t _sobol_1(uint32_t p_index) {
+		uint32_t result = 0;
+		for (uint32_t v = 1u << 31; p_index; p_index >>= 1, v ^= v >> 1) {
+			if (p_index & 1) {
+				result ^= v;
+			}
+		}
+		return result;
+	}
+
+	static _FORCE_INLINE_ uint32_t _radical_inverse_3(uint32_t p_index) {
+		// 3^20 fits 32 bits, so 20 digits give full float precision.
+		uint32_t reversed = 0;
+		for (int i = 0; i < 20; i++) {
+			reversed = reversed * 3 + p_index % 3;
+			p_index /= 3;
+		}
+		return (uint32_t)(reversed * (4294967296.0 / 3486784401.0));
+	}
+
+	static _FORCE_INLINE_ float _to_unit(uint32_t p_value) {
+		return (p_value >> 8) * (1.0f / 16777216.0f);
+	}
+
+public:
+	_FORCE_INLINE_ void set_type(Type p_type) { type = p_type; }
+	_FORCE_INLINE_ Type get_type() const { return type; }
+
+	_FORCE_INLINE_ void set_seed(uint32_t p_seed) { seed = _hash(p_seed); }
+
+	_FORCE_INLINE_ void set_pixel(int p_x, int p_y) {
+		pixel_shift_x = p_x * R2_ALPHA_X + p_y * R2_ALPHA_Y;
+		pixel_shift_y = p_x * R2_ALPHA_Y + p_y * R2_ALPHA_X + 0x80000000;
+	}
+
+	// Point p_index of pattern p_pair, in [0, 1)^2.
+	Vector2 get_2d(uint32_t p_index, uint32_t p_pair) const {
+		const uint32_t pair_seed = _hash(seed ^ (p_pair * 0x9E3779B9));
+		uint32_t x;
+		uint32_t y;
+		switch (type) {
+			case SEQUENCE_SOBOL: {
+				// Shuffling the index per pair decorrelates the pairs from each other.
+				const uint32_t index = _owen_scramble(p_index, pair_seed);
+				x = _owen_scramble(_reverse_bits(index), _hash(pair_seed + 1));
+				y = _owen_scramble(_sobol_1(index), _hash(pair_seed + 2));
+			} break;
+			case SEQUENCE_HALTON: {
+				x = _reverse_bits(p_index) + _hash(pair_seed + 1);
+				y = _radical_inverse_3(p_index) + _hash(pair_seed + 2);
+			} break;
+			case SEQUENCE_R2: {
+				x = p_index * R2_ALPHA_X + _hash(pair_seed + 1);
+				y = p_index * R2_ALPHA_Y + _hash(pair_seed + 2);
+			} break;
+			case SEQUENCE_BLUE_NOISE: {
+				// Only the pair (not the seed) rotates the pattern, so neighbouring pixels stay
+				// correlated through the dither mask.
+				const uint32_t rotation = _hash(p_pair * 0x9E3779B9);
+				x = p_index * R2_ALPHA_X + pixel_shift_x + rotation;
+				y = p_index * R2_ALPHA_Y + pixel_shift_y + _hash(rotation);
+			} break;
+			default: {
+				x = _hash(pair_seed ^ _hash(p_index));
+				y = _hash(x + p_index);
+			} break;
+		}
+		return Vector2(_to_unit(x), _to_unit(y));
+	}
+
+	_FORCE_INLINE_ float get_1d(uint32_t p_index, uint32_t p_pair) const {
+		return get_2d(p_index, p_pair).x;
+	}
+};
+
+#endif // RANDOM_SEQUENCE_H
@@ -0,0 +1,59 @@
+/*************************************************************************/
+/*  random_source.h                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#ifndef RANDOM_SOURCE_H
+#define RANDOM_SOURCE_H
+
+#include "core/math/math_funcs.h"
+#include "core/math/random_number_generator.h"
+
+// Adapters giving the Random:: sampling templates (bounded(), normal(), RandomAliasTable::sample()...)
+// their rand()/rand64() interface on top of a RandomNumberGenerator or of the global generator.
+// rand64() draws the high word first, in its own statement so every compiler gives the same order.
+
+struct RandomSourceRNG {
+	RandomNumberGenerator *rng;
+	_FORCE_INLINE_ uint32_t rand() { return rng->randi(); }
+	_FORCE_INLINE_ uint64_t rand64() {
+		const uint64_t high = rng->randi();
+		return (high << 32) | rng->randi();
+	}
+};
+
+struct RandomSourceGlobal {
+	_FORCE_INLINE_ uint32_t rand() { return Math::rand(); }
+	_FORCE_INLINE_ uint64_t rand64() {
+		const uint64_t high = Math::rand();
+		return (high << 32) | Math::rand();
+	}
+};
+
+#endif // RANDOM_SOURCE_H
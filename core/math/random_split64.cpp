@@ -32,12 +32,22 @@
 
 #include <core/os/os.h>
 #include <core/math/random_split64.h>
+#include <core/io/marshalls.h>
 
 RandomSPLIT64::RandomSPLIT64(uint64_t p_seed, uint64_t p_inc) :
-		split64() {
+		split64(p_seed) {
 	current_inc = p_inc;
 	current_seed = p_seed;
-	split64 = memnew(SplitMix64(p_seed));
 };
 //real_t random(int p_from, int p_to) { return (real_t)random((real_t)p_from, (real_t)p_to); }
 
+void RandomSPLIT64::write_state(uint8_t *r_bytes) const {
+	encode_uint64(current_seed, r_bytes);
+	encode_uint64(split64.GetState(), r_bytes + 8);
+	encode_uint64(0, r_bytes + 16);
+}
+
+void RandomSPLIT64::read_state(const uint8_t *p_bytes) {
+	current_seed = decode_uint64(p_bytes);
+	split64 = SplitMix64(decode_uint64(p_bytes + 8));
+}
@@ -33,33 +33,48 @@
 
 #include "core/math/random.h"
 #include <thirdparty/randomization/xorshift/xorshift.hpp>
-class RandomSPLIT64 : public virtual Random {
+class RandomSPLIT64 final : public Random {
 
-	SplitMix64* split64;
+	SplitMix64 split64; // Inline 64-bit state, reseeding is a plain state write.
 
 public:
 	RandomSPLIT64(uint64_t p_seed = DEFAULT_SEED, uint64_t p_inc = DEFAULT_INC);
 
 	_FORCE_INLINE_ virtual void seed(uint64_t p_seed){
-		split64 = memnew(SplitMix64(p_seed));
+		split64 = SplitMix64(p_seed);
 		current_seed = p_seed;
 	};
+	// The whole state is one word, so unlike the 128-bit generators this is exact.
 	_FORCE_INLINE_ virtual void set_state(uint64_t p_state) {
-		seed(p_state);
+		split64 = SplitMix64(p_state);
 	};
 	_FORCE_INLINE_ virtual uint64_t get_state() const {
-		return current_seed;
+		return split64.GetState();
+	};
+	virtual void write_state(uint8_t *r_bytes) const;
+	virtual void read_state(const uint8_t *p_bytes);
+	virtual void jump() {
+		split64.Advance(JUMP_DISTANCE_64);
+	};
+	virtual void long_jump() {
+		split64.Advance(LONG_JUMP_DISTANCE_64);
 	};
 
+	// The high bits are the strongest ones of this generator's output.
 	_FORCE_INLINE_ virtual uint32_t rand() {
-		return static_cast<uint32_t>(split64->Next());
+		return static_cast<uint32_t>(split64.Next() >> 32);
+	};
+	_FORCE_INLINE_ uint64_t rand64() {
+		return split64.Next();
 	};
 
+	// [0, 1] with the same CLZ/LDEXP technique as RandomPCG.
 	_FORCE_INLINE_ virtual double randd() {
-		return static_cast<double>(split64->Next());
+		uint64_t exponent_bits = split64.Next();
+		return clz_double(exponent_bits, split64.Next());
 	};
 	_FORCE_INLINE_ virtual float randf() {
-		return static_cast<float>(split64->Next());
+		return clz_float(split64.Next());
 	};
 
 };
@@ -32,12 +32,23 @@
 
 
 #include <core/math/random_xosh128.h>
+#include <core/io/marshalls.h>
 #include <array>
 RandomXOSH128::RandomXOSH128(uint64_t p_seed, uint64_t p_inc) :
-		xoroshiro() {
+		xoroshiro(SeedWithSm64<Xoroshiro128>(p_seed)) {
 	current_inc = p_inc;
 	current_seed = p_seed;
-	xoroshiro = memnew(Xoroshiro128(std::array<uint64_t, 2>{ p_seed, p_seed }));
 };
 //real_t random(int p_from, int p_to) { return (real_t)random((real_t)p_from, (real_t)p_to); }
 
+void RandomXOSH128::write_state(uint8_t *r_bytes) const {
+	encode_uint64(current_seed, r_bytes);
+	encode_uint64(xoroshiro.GetState()[0], r_bytes + 8);
+	encode_uint64(xoroshiro.GetState()[1], r_bytes + 16);
+}
+
+void RandomXOSH128::read_state(const uint8_t *p_bytes) {
+	current_seed = decode_uint64(p_bytes);
+	const std::array<uint64_t, 2> state = { { decode_uint64(p_bytes + 8), decode_uint64(p_bytes + 16) } };
+	xoroshiro = Xoroshiro128(state);
+}
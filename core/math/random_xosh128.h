@@ -32,17 +32,20 @@
 #define RANDOM_XOSH128_H
 
 #include "core/math/random.h"
+#include "core/math/random_engine.h"
+#include "core/math/random_lanes.h"
 #include <thirdparty/randomization/xorshift/xorshift.hpp>
 
-class RandomXOSH128 : public virtual Random {
+class RandomXOSH128 final : public Random {
 
-	Xoroshiro128* xoroshiro;
+	Xoroshiro128 xoroshiro; // Inline 128-bit state, reseeding is a plain state write.
 
 public:
 	RandomXOSH128(uint64_t p_seed = DEFAULT_SEED, uint64_t p_inc = DEFAULT_INC);
 
 	_FORCE_INLINE_ virtual void seed(uint64_t p_seed){
-		xoroshiro = memnew(Xoroshiro128(std::array<uint64_t, 2>{ p_seed, p_seed }));
+		// Expanded through SplitMix64: equal state words make the first outputs nearly zero.
+		xoroshiro = SeedWithSm64<Xoroshiro128>(p_seed);
 		current_seed = p_seed;
 	};
 	_FORCE_INLINE_ virtual void set_state(uint64_t p_state) {
@@ -51,17 +54,41 @@ public:
 	_FORCE_INLINE_ virtual uint64_t get_state() const {
 		return current_seed;
 	};
+	virtual void write_state(uint8_t *r_bytes) const;
+	virtual void read_state(const uint8_t *p_bytes);
+	virtual void jump() {
+		xoroshiro.Jump();
+	};
+	virtual void long_jump() {
+		static const uint64_t LONG_JUMP[2] = { 0x18f7c399ccebda8d, 0xf2deac28bef3bb07 }; // 2^96 draws.
+		random_lanes_jump(xoroshiro, LONG_JUMP);
+	};
 
+	// The high bits are the strongest ones of this generator's output.
 	_FORCE_INLINE_ virtual uint32_t rand() {
-		return static_cast<uint32_t>(xoroshiro->Next());
+		return static_cast<uint32_t>(xoroshiro.Next() >> 32);
 	};
+	_FORCE_INLINE_ uint64_t rand64() {
+		return xoroshiro.Next();
+	};
+
+	_FORCE_INLINE_ Xoroshiro128 &get_generator() { return xoroshiro; }
 
+	// [0, 1] with the same CLZ/LDEXP technique as RandomPCG.
 	_FORCE_INLINE_ virtual double randd() {
-		return static_cast<double>(xoroshiro->Next());
+		uint64_t exponent_bits = xoroshiro.Next();
+		return clz_double(exponent_bits, xoroshiro.Next());
 	};
 	_FORCE_INLINE_ virtual float randf() {
-		return static_cast<float>(xoroshiro->Next());
+		return clz_float(xoroshiro.Next());
 	};
 
 };
+
+template <>
+class RandomBulkSource<RandomXOSH128> : public RandomLaneBulkSource<RandomXOSH128, Xoroshiro128> {
+public:
+	RandomBulkSource(RandomXOSH128 *p_rand, int p_words) :
+			RandomLaneBulkSource<RandomXOSH128, Xoroshiro128>(p_rand, p_words) {}
+};
 #endif
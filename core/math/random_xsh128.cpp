@@ -32,12 +32,23 @@
 
 #include <core/os/os.h>
 #include <core/math/random_xsh128.h>
+#include <core/io/marshalls.h>
 
 RandomXSH128::RandomXSH128(uint64_t p_seed, uint64_t p_inc) :
-		xorshift() {
+		xorshift(SeedWithSm64<Xorshift128>(p_seed)) {
 	current_inc = p_inc;
 	current_seed = p_seed;
-	xorshift = memnew(Xorshift128(std::array<uint64_t, 2>{ p_seed, p_seed }));
 };
 //real_t random(int p_from, int p_to) { return (real_t)random((real_t)p_from, (real_t)p_to); }
 
+void RandomXSH128::write_state(uint8_t *r_bytes) const {
+	encode_uint64(current_seed, r_bytes);
+	encode_uint64(xorshift.GetState()[0], r_bytes + 8);
+	encode_uint64(xorshift.GetState()[1], r_bytes + 16);
+}
+
+void RandomXSH128::read_state(const uint8_t *p_bytes) {
+	current_seed = decode_uint64(p_bytes);
+	const std::array<uint64_t, 2> state = { { decode_uint64(p_bytes + 8), decode_uint64(p_bytes + 16) } };
+	xorshift = Xorshift128(state);
+}
@@ -32,17 +32,20 @@
 #define RANDOM_XSH128_H
 
 #include "core/math/random.h"
+#include "core/math/random_engine.h"
+#include "core/math/random_lanes.h"
 #include <thirdparty/randomization/xorshift/xorshift.hpp>
 
-class RandomXSH128 : public virtual Random {
+class RandomXSH128 final : public Random {
 
-	Xorshift128* xorshift;
+	Xorshift128 xorshift; // Inline 128-bit state, reseeding is a plain state write.
 
 public:
 	RandomXSH128(uint64_t p_seed = DEFAULT_SEED, uint64_t p_inc = DEFAULT_INC);
 
 	_FORCE_INLINE_ virtual void seed(uint64_t p_seed){
-		xorshift = memnew(Xorshift128(std::array<uint64_t, 2>{ p_seed, p_seed }));
+		// Expanded through SplitMix64: equal state words make the first outputs nearly zero.
+		xorshift = SeedWithSm64<Xorshift128>(p_seed);
 		current_seed = p_seed;
 	};
 	_FORCE_INLINE_ virtual void set_state(uint64_t p_state) {
@@ -51,17 +54,41 @@ public:
 	_FORCE_INLINE_ virtual uint64_t get_state() const {
 		return current_seed;
 	};
+	virtual void write_state(uint8_t *r_bytes) const;
+	virtual void read_state(const uint8_t *p_bytes);
+	virtual void jump() {
+		xorshift.Jump();
+	};
+	virtual void long_jump() {
+		static const uint64_t LONG_JUMP[2] = { 0xea61c9f1f13962ae, 0xa1fe50ef79cfafb2 }; // 2^96 draws.
+		random_lanes_jump(xorshift, LONG_JUMP);
+	};
 
+	// The high bits are the strongest ones of this generator's output.
 	_FORCE_INLINE_ virtual uint32_t rand() {
-		return static_cast<uint32_t>(xorshift->Next());
+		return static_cast<uint32_t>(xorshift.Next() >> 32);
 	};
+	_FORCE_INLINE_ uint64_t rand64() {
+		return xorshift.Next();
+	};
+
+	_FORCE_INLINE_ Xorshift128 &get_generator() { return xorshift; }
 
+	// [0, 1] with the same CLZ/LDEXP technique as RandomPCG.
 	_FORCE_INLINE_ virtual double randd() {
-		return static_cast<double>(xorshift->Next());
+		uint64_t exponent_bits = xorshift.Next();
+		return clz_double(exponent_bits, xorshift.Next());
 	};
 	_FORCE_INLINE_ virtual float randf() {
-		return static_cast<float>(xorshift->Next());
+		return clz_float(xorshift.Next());
 	};
 
 };
+
+template <>
+class RandomBulkSource<RandomXSH128> : public RandomLaneBulkSource<RandomXSH128, Xorshift128> {
+public:
+	RandomBulkSource(RandomXSH128 *p_rand, int p_words) :
+			RandomLaneBulkSource<RandomXSH128, Xorshift128>(p_rand, p_words) {}
+};
 #endif
@@ -0,0 +1,406 @@
+/**************************************************************************/
+/*  task_scheduler.cpp                                                    */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "task_scheduler.h"
+
+#include "core/os/os.h"
+
+// Idle polls, each yielding the CPU, before a worker goes to sleep.
+#define WORKER_SPIN_COUNT 64
+// Chunks per thread when the grain is picked automatically.
+#define AUTO_GRAIN_CHUNKS 8
+
+struct TaskScheduler::Group {
+	RangeFunction function = nullptr;
+	void *userdata = nullptr;
+	uint32_t elements = 0;
+	uint32_t grain = 1;
+	std::atomic<uint32_t> remaining;
+	// One held by the handle, one by the scheduler until completion.
+	std::atomic<uint32_t> references;
+	std::atomic<bool> done;
+	// Guarded by dependency_lock.
+	uint32_t pending_dependencies = 0;
+	LocalVector<Group *> dependents;
+	alignas(16) uint8_t payload[GROUP_PAYLOAD_SIZE];
+
+	Group() {
+		remaining.store(0);
+		references.store(0);
+		done.store(false);
+	}
+};
+
+TaskScheduler *TaskScheduler::singleton = nullptr;
+
+static thread_local TaskScheduler *current_scheduler = nullptr;
+static thread_local uint32_t current_queue = 0;
+
+void TaskScheduler::Queue::push(const Task &p_task) {
+	lock.lock();
+	if (tail - head == capacity) {
+		const uint32_t new_capacity = capacity ? capacity * 2 : 64;
+		Task *new_tasks = (Task *)memalloc(sizeof(Task) * new_capacity);
+		for (uint32_t i = head; i != tail; i++) {
+			new_tasks[i & (new_capacity - 1)] = tasks[i & (capacity - 1)];
+		}
+		if (tasks) {
+			memfree(tasks);
+		}
+		tasks = new_tasks;
+		capacity = new_capacity;
+	}
+	tasks[tail & (capacity - 1)] = p_task;
+	tail++;
+	size.store(tail - head, std::memory_order_release);
+	lock.unlock();
+}
+
+bool TaskScheduler::Queue::pop(Task &r_task) {
+	lock.lock();
+	if (tail == head) {
+		lock.unlock();
+		return false;
+	}
+	tail--;
+	r_task = tasks[tail & (capacity - 1)];
+	size.store(tail - head, std::memory_order_release);
+	lock.unlock();
+	return true;
+}
+
+bool TaskScheduler::Queue::steal(Task &r_task) {
+	lock.lock();
+	if (tail == head) {
+		lock.unlock();
+		return false;
+	}
+	r_task = tasks[head & (capacity - 1)];
+	head++;
+	size.store(tail - head, std::memory_order_release);
+	lock.unlock();
+	return true;
+}
+
+void TaskScheduler::_worker_function(void *p_worker) {
+	Worker *worker = static_cast<Worker *>(p_worker);
+	TaskScheduler *scheduler = worker->scheduler;
+	current_scheduler = scheduler;
+	current_queue = worker->index;
+
+	uint32_t idle = 0;
+	while (!scheduler->exit.load(std::memory_order_acquire)) {
+		Task task;
+		if (scheduler->_take(worker->index, task)) {
+			scheduler->_execute(task);
+			idle = 0;
+		} else if (++idle >= WORKER_SPIN_COUNT) {
+			scheduler->_sleep(nullptr);
+			idle = 0;
+		} else {
+#if !defined(NO_THREADS)
+			std::this_thread::yield();
+#endif
+		}
+	}
+}
+
+uint32_t TaskScheduler::_get_queue_index() const {
+	return current_scheduler == this ? current_queue : thread_count;
+}
+
+void TaskScheduler::_push(const Task &p_task) {
+	queues[_get_queue_index()].push(p_task);
+	_wake(false);
+}
+
+// Own queue first (newest task, likely still in cache), then the oldest task of the others.
+bool TaskScheduler::_take(uint32_t p_queue, Task &r_task) {
+	if (queues[p_queue].size.load(std::memory_order_acquire) && queues[p_queue].pop(r_task)) {
+		return true;
+	}
+	for (uint32_t i = 1; i < queue_count; i++) {
+		Queue &queue = queues[(p_queue + i) % queue_count];
+		if (queue.size.load(std::memory_order_acquire) && queue.steal(r_task)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool TaskScheduler::_has_tasks() const {
+	for (uint32_t i = 0; i < queue_count; i++) {
+		if (queues[i].size.load(std::memory_order_acquire)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void TaskScheduler::_execute(Task p_task) {
+	Group *group = p_task.group;
+	// Leave the upper halves to thieves, running the lower part here.
+	while (p_task.to - p_task.from > group->grain) {
+		Task half;
+		half.group = group;
+		half.from = p_task.from + (p_task.to - p_task.from) / 2;
+		half.to = p_task.to;
+		_push(half);
+		p_task.to = half.from;
+	}
+	group->function(group->userdata, p_task.from, p_task.to);
+
+	const uint32_t count = p_task.to - p_task.from;
+	if (group->remaining.fetch_sub(count, std::memory_order_acq_rel) == count) {
+		_complete(group);
+	}
+}
+
+void TaskScheduler::_start(Group *p_group) {
+	if (p_group->elements == 0) {
+		_complete(p_group);
+		return;
+	}
+	Task task;
+	task.group = p_group;
+	task.from = 0;
+	task.to = p_group->elements;
+	_push(task);
+}
+
+void TaskScheduler::_complete(Group *p_group) {
+	dependency_lock.lock();
+	p_group->done.store(true, std::memory_order_release);
+	// No dependents can be added once done is set, so the ready ones are compacted in place.
+	uint32_t ready = 0;
+	for (uint32_t i = 0; i < p_group->dependents.size(); i++) {
+		Group *dependent = p_group->dependents[i];
+		if (--dependent->pending_dependencies == 0) {
+			p_group->dependents[ready++] = dependent;
+		}
+	}
+	dependency_lock.unlock();
+
+	for (uint32_t i = 0; i < ready; i++) {
+		_start(p_group->dependents[i]);
+	}
+	p_group->dependents.clear();
+	_wake(true);
+	_unreference(p_group);
+}
+
+void TaskScheduler::_unreference(Group *p_group) {
+	if (p_group->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		group_lock.lock();
+		group_allocator.free(p_group);
+		group_lock.unlock();
+	}
+}
+
+void TaskScheduler::_wake(bool p_all) {
+#if !defined(NO_THREADS)
+	// Orders the caller's publishing store (queue size or done) before the sleepers load, pairing
+	// with the fence in _sleep(). Without it the store can still sit in the store buffer while
+	// both sides read the other's old value, and the sleeper never wakes.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sleepers.load(std::memory_order_relaxed) == 0) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		wake_epoch++;
+	}
+	if (p_all) {
+		sleep_condition.notify_all();
+	} else {
+		sleep_condition.notify_one();
+	}
+#endif
+}
+
+// Sleeps until a task is pushed or a group completes. The checks happen after registering as a
+// sleeper, with a fence matching the one in _wake() in between, so a concurrent _wake() either
+// sees the sleeper or the sleeper sees its work.
+void TaskScheduler::_sleep(Group *p_waiting) {
+#if !defined(NO_THREADS)
+	std::unique_lock<std::mutex> lock(sleep_mutex);
+	sleepers.fetch_add(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!_has_tasks() && !exit.load() && !(p_waiting && p_waiting->done.load())) {
+		const uint64_t epoch = wake_epoch;
+		sleep_condition.wait(lock, [&] { return wake_epoch != epoch; });
+	}
+	sleepers.fetch_sub(1);
+#endif
+}
+
+TaskScheduler::Group *TaskScheduler::_create(RangeFunction p_function, uint32_t p_elements, uint32_t p_grain, void *&r_payload) {
+	group_lock.lock();
+	Group *group = group_allocator.alloc();
+	group_lock.unlock();
+
+	group->function = p_function;
+	group->userdata = group->payload;
+	group->elements = p_elements;
+	if (p_grain == 0) {
+		const uint32_t chunks = (thread_count + 1) * AUTO_GRAIN_CHUNKS;
+		p_grain = MAX(1u, (p_elements + chunks - 1) / chunks);
+	}
+	group->grain = p_grain;
+	group->remaining.store(p_elements);
+	group->references.store(2);
+	r_payload = group->payload;
+	return group;
+}
+
+void TaskScheduler::_submit(Group *p_group, const GroupID *p_dependencies, int p_dependency_count) {
+	uint32_t pending = 0;
+	dependency_lock.lock();
+	for (int i = 0; i < p_dependency_count; i++) {
+		Group *dependency = p_dependencies[i];
+		if (dependency && !dependency->done.load(std::memory_order_acquire)) {
+			dependency->dependents.push_back(p_group);
+			pending++;
+		}
+	}
+	p_group->pending_dependencies = pending;
+	dependency_lock.unlock();
+
+	if (pending == 0) {
+		_start(p_group);
+	}
+}
+
+TaskScheduler::GroupID TaskScheduler::add_range(RangeFunction p_function, void *p_userdata, uint32_t p_elements, uint32_t p_grain, const GroupID *p_dependencies, int p_dependency_count) {
+	ERR_FAIL_COND_V_MSG(!queues, nullptr, "TaskScheduler was not initialized.");
+	ERR_FAIL_NULL_V(p_function, nullptr);
+	void *payload = nullptr;
+	Group *group = _create(p_function, p_elements, p_grain, payload);
+	group->userdata = p_userdata;
+	_submit(group, p_dependencies, p_dependency_count);
+	return group;
+}
+
+bool TaskScheduler::is_group_done(GroupID p_group) const {
+	ERR_FAIL_NULL_V(p_group, true);
+	return p_group->done.load(std::memory_order_acquire);
+}
+
+uint32_t TaskScheduler::get_group_completed_elements(GroupID p_group) const {
+	ERR_FAIL_NULL_V(p_group, 0);
+	return p_group->elements - p_group->remaining.load(std::memory_order_acquire);
+}
+
+void TaskScheduler::wait(GroupID p_group) {
+	ERR_FAIL_NULL(p_group);
+	const uint32_t queue = _get_queue_index();
+	while (!p_group->done.load(std::memory_order_acquire)) {
+		Task task;
+		if (_take(queue, task)) {
+			_execute(task);
+		} else {
+			_sleep(p_group);
+		}
+	}
+	_unreference(p_group);
+}
+
+void TaskScheduler::release(GroupID p_group) {
+	ERR_FAIL_NULL(p_group);
+	_unreference(p_group);
+}
+
+void TaskScheduler::init(int p_thread_count) {
+	ERR_FAIL_COND(queues != nullptr);
+	if (p_thread_count < 0) {
+		p_thread_count = MAX(1, OS::get_singleton()->get_default_thread_pool_size() - 1);
+	}
+#if defined(NO_THREADS)
+	// Everything runs in wait() on the calling thread.
+	p_thread_count = 0;
+#endif
+
+	thread_count = p_thread_count;
+	queue_count = thread_count + 1;
+	queues = memnew_arr(Queue, queue_count);
+	exit.store(false);
+
+	if (thread_count) {
+		workers = memnew_arr(Worker, thread_count);
+		for (uint32_t i = 0; i < thread_count; i++) {
+			workers[i].scheduler = this;
+			workers[i].index = i;
+			workers[i].thread.start(&TaskScheduler::_worker_function, &workers[i]);
+		}
+	}
+}
+
+void TaskScheduler::finish() {
+	if (queues == nullptr) {
+		return;
+	}
+
+	exit.store(true, std::memory_order_release);
+#if !defined(NO_THREADS)
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		wake_epoch++;
+	}
+	sleep_condition.notify_all();
+#endif
+	if (workers) {
+		for (uint32_t i = 0; i < thread_count; i++) {
+			workers[i].thread.wait_to_finish();
+		}
+		memdelete_arr(workers);
+		workers = nullptr;
+	}
+
+	// Released groups may still have tasks queued; run them so they free themselves.
+	Task task;
+	while (_take(thread_count, task)) {
+		_execute(task);
+	}
+
+	memdelete_arr(queues);
+	queues = nullptr;
+	thread_count = 0;
+	queue_count = 0;
+}
+
+TaskScheduler::TaskScheduler() :
+		group_allocator(256) {
+	exit.store(false);
+	sleepers.store(0);
+}
+
+TaskScheduler::~TaskScheduler() {
+	finish();
+}
@@ -0,0 +1,199 @@
+/**************************************************************************/
+/*  task_scheduler.h                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include "core/local_vector.h"
+#include "core/os/memory.h"
+#include "core/os/spin_lock.h"
+#include "core/os/thread.h"
+#include "core/paged_allocator.h"
+
+#include <atomic>
+#include <type_traits>
+
+#if !defined(NO_THREADS)
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Work-stealing scheduler for data-parallel jobs.
+//
+// Work is submitted as groups: a function called over sub-ranges of [0, elements), optionally
+// after other groups have completed. Each worker thread owns a deque; it takes its own tasks
+// from the back and steals from the front of the others', so ranges are split lazily where
+// there is idle capacity. Threads that are not workers submit through a shared queue.
+//
+// wait() runs queued tasks while the group is incomplete, so tasks may submit and wait on
+// nested groups, and several systems can keep groups in flight at the same time.
+class TaskScheduler {
+public:
+	// Called with [p_from, p_to) sub-ranges of the group's elements, never empty.
+	typedef void (*RangeFunction)(void *p_userdata, uint32_t p_from, uint32_t p_to);
+
+	struct Group;
+	typedef Group *GroupID;
+
+	// Bytes available for the callable of add_method().
+	static const int GROUP_PAYLOAD_SIZE = 64;
+
+private:
+	struct Task {
+		Group *group = nullptr;
+		uint32_t from = 0;
+		uint32_t to = 0;
+	};
+
+	// Ring buffer of tasks. The owner pushes and pops at the back, thieves take from the front.
+	struct Queue {
+		SpinLock lock;
+		Task *tasks = nullptr;
+		uint32_t capacity = 0; // Power of 2.
+		uint32_t head = 0;
+		uint32_t tail = 0;
+		std::atomic<uint32_t> size;
+
+		void push(const Task &p_task);
+		bool pop(Task &r_task);
+		bool steal(Task &r_task);
+
+		Queue() { size.store(0); }
+		~Queue() {
+			if (tasks) {
+				memfree(tasks);
+			}
+		}
+	};
+
+	struct Worker {
+		TaskScheduler *scheduler = nullptr;
+		uint32_t index = 0;
+		Thread thread;
+	};
+
+	static TaskScheduler *singleton;
+
+	Worker *workers = nullptr;
+	uint32_t thread_count = 0;
+	// One per worker, plus a last one shared by every other thread.
+	Queue *queues = nullptr;
+	uint32_t queue_count = 0;
+	std::atomic<bool> exit;
+
+	SpinLock group_lock;
+	PagedAllocator<Group> group_allocator;
+	// Guards dependency edges between groups, which are only touched on submission and completion.
+	SpinLock dependency_lock;
+
+	std::atomic<uint32_t> sleepers;
+#if !defined(NO_THREADS)
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_condition;
+	uint64_t wake_epoch = 0;
+#endif
+
+	static void _worker_function(void *p_worker);
+
+	uint32_t _get_queue_index() const;
+	void _push(const Task &p_task);
+	bool _take(uint32_t p_queue, Task &r_task);
+	bool _has_tasks() const;
+	void _execute(Task p_task);
+	void _start(Group *p_group);
+	void _complete(Group *p_group);
+	void _unreference(Group *p_group);
+	void _wake(bool p_all);
+	void _sleep(Group *p_waiting);
+
+	Group *_create(RangeFunction p_function, uint32_t p_elements, uint32_t p_grain, void *&r_payload);
+	void _submit(Group *p_group, const GroupID *p_dependencies, int p_dependency_count);
+
+	template <class C, class M, class U>
+	struct MethodCall {
+		C *instance;
+		M method;
+		U userdata;
+
+		static void call(void *p_self, uint32_t p_from, uint32_t p_to) {
+			MethodCall *self = static_cast<MethodCall *>(p_self);
+			for (uint32_t i = p_from; i < p_to; i++) {
+				(self->instance->*self->method)(i, self->userdata);
+			}
+		}
+	};
+
+public:
+	static TaskScheduler *get_singleton() { return singleton; }
+
+	// Runs p_function over [0, p_elements) once every group in p_dependencies has completed.
+	// Ranges are split down to p_grain elements; 0 picks a grain giving each thread a few chunks.
+	// The returned handle must be passed to wait() or release() exactly once.
+	GroupID add_range(RangeFunction p_function, void *p_userdata, uint32_t p_elements, uint32_t p_grain = 0, const GroupID *p_dependencies = nullptr, int p_dependency_count = 0);
+
+	// Same, calling (p_instance->*p_method)(index, p_userdata) for each element, like ThreadWorkPool.
+	template <class C, class M, class U>
+	GroupID add_method(C *p_instance, M p_method, U p_userdata, uint32_t p_elements, uint32_t p_grain = 0, const GroupID *p_dependencies = nullptr, int p_dependency_count = 0) {
+		typedef MethodCall<C, M, U> Call;
+		static_assert(sizeof(Call) <= GROUP_PAYLOAD_SIZE, "Method call too large for a task group, use add_range().");
+		static_assert(std::is_trivially_destructible<Call>::value, "Method call userdata must be trivially destructible.");
+		void *payload = nullptr;
+		Group *group = _create(&Call::call, p_elements, p_grain, payload);
+		Call *call = static_cast<Call *>(payload);
+		call->instance = p_instance;
+		call->method = p_method;
+		call->userdata = p_userdata;
+		_submit(group, p_dependencies, p_dependency_count);
+		return group;
+	}
+
+	bool is_group_done(GroupID p_group) const;
+	// Elements processed so far, for progress reporting.
+	uint32_t get_group_completed_elements(GroupID p_group) const;
+
+	// Runs queued tasks until p_group has completed, then releases it.
+	void wait(GroupID p_group);
+	// Lets p_group complete on its own.
+	void release(GroupID p_group);
+
+	_FORCE_INLINE_ int get_thread_count() const { return thread_count; }
+
+	// Starts p_thread_count workers; -1 leaves one core of the default pool size to the caller.
+	void init(int p_thread_count = -1);
+	void finish();
+
+	static void set_singleton(TaskScheduler *p_scheduler) { singleton = p_scheduler; }
+
+	TaskScheduler();
+	~TaskScheduler();
+};
+
+#endif // TASK_SCHEDULER_H
@@ -52,6 +52,11 @@ uint64_t Thread::_thread_id_hash(const std::thread::id &p_t) {
 Thread::ID Thread::main_thread_id = _thread_id_hash(std::this_thread::get_id());
 static thread_local Thread::ID caller_id = 0;
 static thread_local bool caller_id_cached = false;
+// Indices are handed out by the starting thread, so they follow start() order rather than
+// scheduling. Threads not created through Thread take one on first query.
+static SafeNumeric<uint32_t> last_thread_index;
+static thread_local uint32_t caller_index = 0;
+static thread_local bool caller_index_cached = false;
 
 void Thread::_set_platform_funcs(
 		Error (*p_set_name_func)(const String &),
@@ -64,9 +69,11 @@ void Thread::_set_platform_funcs(
 	Thread::term_func = p_term_func;
 }
 
-void Thread::callback(Thread *p_self, const Settings &p_settings, Callback p_callback, void *p_userdata) {
+void Thread::callback(Thread *p_self, uint32_t p_index, const Settings &p_settings, Callback p_callback, void *p_userdata) {
 	caller_id = _thread_id_hash(p_self->thread.get_id());
 	caller_id_cached = true;
+	caller_index = p_index;
+	caller_index_cached = true;
 
 	if (set_priority_func) {
 		set_priority_func(p_settings.priority);
@@ -91,7 +98,7 @@ void Thread::start(Thread::Callback p_callback, void *p_user, const Settings &p_
 		std::thread empty_thread;
 		thread.swap(empty_thread);
 	}
-	std::thread new_thread(&Thread::callback, this, p_settings, p_callback, p_user);
+	std::thread new_thread(&Thread::callback, this, last_thread_index.increment(), p_settings, p_callback, p_user);
 	thread.swap(new_thread);
 	id = _thread_id_hash(thread.get_id());
 }
@@ -136,5 +143,14 @@ Thread::ID Thread::get_caller_id() {
 		return caller_id;
 	}
 }
+
+uint32_t Thread::get_caller_index() {
+	if (likely(caller_index_cached)) {
+		return caller_index;
+	}
+	caller_index = get_caller_id() == main_thread_id ? 0 : last_thread_index.increment();
+	caller_index_cached = true;
+	return caller_index;
+}
 #endif
 #endif // PLATFORM_THREAD_OVERRIDE
@@ -75,7 +75,7 @@ private:
 	ID id = _thread_id_hash(std::thread::id());
 	std::thread thread;
 
-	static void callback(Thread *p_self, const Settings &p_settings, Thread::Callback p_callback, void *p_userdata);
+	static void callback(Thread *p_self, uint32_t p_index, const Settings &p_settings, Thread::Callback p_callback, void *p_userdata);
 
 	static Error (*set_name_func)(const String &);
 	static void (*set_priority_func)(Thread::Priority);
@@ -96,6 +96,8 @@ public:
 	static ID get_caller_id();
 	// get the ID of the main thread
 	_FORCE_INLINE_ static ID get_main_id() { return main_thread_id; }
+	// get a small sequential index of the caller thread: 0 for the main thread, then in start() order
+	static uint32_t get_caller_index();
 
 	static Error set_name(const String &p_name);
 
@@ -111,6 +113,8 @@ public:
 	_FORCE_INLINE_ static ID get_caller_id() { return 0; }
 	// get the ID of the main thread
 	_FORCE_INLINE_ static ID get_main_id() { return 0; }
+	// get a small sequential index of the caller thread: 0 for the main thread, then in start() order
+	_FORCE_INLINE_ static uint32_t get_caller_index() { return 0; }
 
 	static Error set_name(const String &p_name) { return ERR_UNAVAILABLE; }
 
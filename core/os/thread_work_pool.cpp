@@ -30,50 +30,31 @@
 
 #include "thread_work_pool.h"
 
-#include "core/os/os.h"
-
-void ThreadWorkPool::_thread_function(void *p_user) {
-	ThreadData *thread = static_cast<ThreadData *>(p_user);
-	while (true) {
-		thread->start.wait();
-		if (thread->exit.load()) {
-			break;
-		}
-		thread->work->work();
-		thread->completed.post();
-	}
-}
-
 void ThreadWorkPool::init(int p_thread_count) {
-	ERR_FAIL_COND(threads != nullptr);
-	if (p_thread_count < 0) {
-		p_thread_count = OS::get_singleton()->get_default_thread_pool_size();
+	ERR_FAIL_COND(scheduler != nullptr);
+	if (p_thread_count < 0 && TaskScheduler::get_singleton()) {
+		scheduler = TaskScheduler::get_singleton();
+		return;
 	}
 
-	thread_count = p_thread_count;
-	threads = memnew_arr(ThreadData, thread_count);
-
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(false);
-		threads[i].thread.start(&ThreadWorkPool::_thread_function, &threads[i]);
-	}
+	own_scheduler = memnew(TaskScheduler);
+	own_scheduler->init(p_thread_count);
+	scheduler = own_scheduler;
 }
 
 void ThreadWorkPool::finish() {
-	if (threads == nullptr) {
+	if (scheduler == nullptr) {
 		return;
 	}
 
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].exit.store(true);
-		threads[i].start.post();
+	if (current_work) {
+		end_work();
 	}
-	for (uint32_t i = 0; i < thread_count; i++) {
-		threads[i].thread.wait_to_finish();
+	if (own_scheduler) {
+		memdelete(own_scheduler);
+		own_scheduler = nullptr;
 	}
-
-	memdelete_arr(threads);
-	threads = nullptr;
+	scheduler = nullptr;
 }
 
 ThreadWorkPool::~ThreadWorkPool() {
@@ -31,76 +31,26 @@
 #ifndef THREAD_WORK_POOL_H
 #define THREAD_WORK_POOL_H
 
-#include "core/os/memory.h"
-#include "core/os/semaphore.h"
-#include "core/os/thread.h"
-
-#include <atomic>
+#include "core/os/task_scheduler.h"
 
+// Compatibility layer over TaskScheduler: one job at a time per pool, calling a method for each
+// element index. Pools initialized with the default thread count share the global scheduler,
+// so jobs from different pools run concurrently and may be started from within each other.
 class ThreadWorkPool {
-	std::atomic<uint32_t> index;
-
-	struct BaseWork {
-		std::atomic<uint32_t> *index = nullptr;
-		uint32_t max_elements = 0;
-		virtual void work() = 0;
-		virtual ~BaseWork() = default;
-	};
-
-	template <class C, class M, class U>
-	struct Work : public BaseWork {
-		C *instance;
-		M method;
-		U userdata;
-		virtual void work() override {
-			while (true) {
-				uint32_t work_index = index->fetch_add(1, std::memory_order_relaxed);
-				if (work_index >= max_elements) {
-					break;
-				}
-				(instance->*method)(work_index, userdata);
-			}
-		}
-	};
-
-	struct ThreadData {
-		Thread thread;
-		Semaphore start;
-		Semaphore completed;
-		std::atomic<bool> exit;
-		BaseWork *work = nullptr;
-	};
-
-	ThreadData *threads = nullptr;
-	uint32_t thread_count = 0;
-	uint32_t threads_working = 0;
-	BaseWork *current_work = nullptr;
-
-	static void _thread_function(void *p_user);
+	TaskScheduler *scheduler = nullptr;
+	// Only used when a specific thread count is requested.
+	TaskScheduler *own_scheduler = nullptr;
+	TaskScheduler::GroupID current_work = nullptr;
+	uint32_t current_elements = 0;
 
 public:
 	template <class C, class M, class U>
 	void begin_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-		ERR_FAIL_COND(!threads); //never initialized
+		ERR_FAIL_COND(!scheduler); //never initialized
 		ERR_FAIL_COND(current_work != nullptr);
 
-		index.store(0, std::memory_order_release);
-
-		Work<C, M, U> *w = memnew((Work<C, M, U>));
-		w->instance = p_instance;
-		w->userdata = p_userdata;
-		w->method = p_method;
-		w->index = &index;
-		w->max_elements = p_elements;
-
-		current_work = w;
-
-		threads_working = MIN(p_elements, thread_count);
-
-		for (uint32_t i = 0; i < threads_working; i++) {
-			threads[i].work = w;
-			threads[i].start.post();
-		}
+		current_elements = p_elements;
+		current_work = scheduler->add_method(p_instance, p_method, p_userdata, p_elements);
 	}
 
 	bool is_working() const {
@@ -109,24 +59,17 @@ public:
 
 	bool is_done_dispatching() const {
 		ERR_FAIL_COND_V(current_work == nullptr, true);
-		return index.load(std::memory_order_acquire) >= current_work->max_elements;
+		return scheduler->is_group_done(current_work);
 	}
 
 	uint32_t get_work_index() const {
 		ERR_FAIL_COND_V(current_work == nullptr, 0);
-		uint32_t idx = index.load(std::memory_order_acquire);
-		return MIN(idx, current_work->max_elements);
+		return scheduler->get_group_completed_elements(current_work);
 	}
 
 	void end_work() {
 		ERR_FAIL_COND(current_work == nullptr);
-		for (uint32_t i = 0; i < threads_working; i++) {
-			threads[i].completed.wait();
-			threads[i].work = nullptr;
-		}
-
-		threads_working = 0;
-		memdelete(current_work);
+		scheduler->wait(current_work);
 		current_work = nullptr;
 	}
 
@@ -148,7 +91,7 @@ public:
 		}
 	}
 
-	_FORCE_INLINE_ int get_thread_count() const { return thread_count; }
+	_FORCE_INLINE_ int get_thread_count() const { return scheduler ? scheduler->get_thread_count() : 0; }
 	void init(int p_thread_count = -1);
 	void finish();
 	~ThreadWorkPool();
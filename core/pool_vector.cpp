@@ -37,28 +37,63 @@ uint8_t *MemoryPool::pool_memory = nullptr;
 size_t *MemoryPool::pool_size = nullptr;
 
 MemoryPool::Alloc *MemoryPool::allocs = nullptr;
-MemoryPool::Alloc *MemoryPool::free_list = nullptr;
+std::atomic<uint64_t> MemoryPool::free_list(MemoryPool::NO_ALLOC);
 uint32_t MemoryPool::alloc_count = 0;
-uint32_t MemoryPool::allocs_used = 0;
-Mutex MemoryPool::alloc_mutex;
+SafeNumeric<uint32_t> MemoryPool::allocs_used;
 
-size_t MemoryPool::total_memory = 0;
-size_t MemoryPool::max_memory = 0;
+SafeNumeric<size_t> MemoryPool::total_memory;
+SafeNumeric<size_t> MemoryPool::max_memory;
+
+MemoryPool::Alloc *MemoryPool::allocate() {
+	uint64_t head = free_list.load(std::memory_order_acquire);
+	while (true) {
+		const uint32_t index = uint32_t(head);
+		if (index == NO_ALLOC) {
+			return nullptr;
+		}
+		// If another thread took this alloc meanwhile, the counter changed and the exchange fails.
+		const uint64_t next = ((head >> 32) + 1) << 32 | allocs[index].next_free.load(std::memory_order_relaxed);
+		if (free_list.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire)) {
+			allocs_used.increment();
+			return &allocs[index];
+		}
+	}
+}
+
+void MemoryPool::release(Alloc *p_alloc) {
+	const uint64_t index = p_alloc - allocs;
+	uint64_t head = free_list.load(std::memory_order_relaxed);
+	while (true) {
+		p_alloc->next_free.store(uint32_t(head), std::memory_order_relaxed);
+		if (free_list.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | index, std::memory_order_release, std::memory_order_relaxed)) {
+			break;
+		}
+	}
+	allocs_used.decrement();
+}
+
+#ifdef DEBUG_ENABLED
+void MemoryPool::track_memory(size_t p_removed, size_t p_added) {
+	size_t total = total_memory.add(p_added - p_removed);
+	max_memory.exchange_if_greater(total);
+}
+#endif
 
 void MemoryPool::setup(uint32_t p_max_allocs) {
 	allocs = memnew_arr(Alloc, p_max_allocs);
 	alloc_count = p_max_allocs;
-	allocs_used = 0;
+	allocs_used.set(0);
 
 	for (uint32_t i = 0; i < alloc_count - 1; i++) {
-		allocs[i].free_list = &allocs[i + 1];
+		allocs[i].next_free.store(i + 1, std::memory_order_relaxed);
 	}
+	allocs[alloc_count - 1].next_free.store(NO_ALLOC, std::memory_order_relaxed);
 
-	free_list = &allocs[0];
+	free_list.store(0, std::memory_order_release);
 }
 
 void MemoryPool::cleanup() {
 	memdelete_arr(allocs);
 
-	ERR_FAIL_COND_MSG(allocs_used > 0, "There are still MemoryPool allocs in use at exit!");
+	ERR_FAIL_COND_MSG(allocs_used.get() > 0, "There are still MemoryPool allocs in use at exit!");
 }
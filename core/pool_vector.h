@@ -38,6 +38,8 @@
 #include "core/safe_refcount.h"
 #include "core/ustring.h"
 
+#include <atomic>
+
 struct MemoryPool {
 	//avoid accessing these directly, must be public for template access
 
@@ -52,24 +54,35 @@ struct MemoryPool {
 		PoolAllocator::ID pool_id;
 		size_t size;
 
-		Alloc *free_list;
+		// Index of the next alloc in the free list.
+		std::atomic<uint32_t> next_free;
 
 		Alloc() :
 				lock(0),
 				mem(nullptr),
 				pool_id(POOL_ALLOCATOR_INVALID_ID),
 				size(0),
-				free_list(nullptr) {
+				next_free(0) {
 		}
 	};
 
+	static const uint32_t NO_ALLOC = 0xFFFFFFFF;
+
 	static Alloc *allocs;
-	static Alloc *free_list;
+	// Lock-free stack of unused allocs. The low 32 bits are the index of the
+	// first one, the high 32 bits count changes so a stale head never matches.
+	static std::atomic<uint64_t> free_list;
 	static uint32_t alloc_count;
-	static uint32_t allocs_used;
-	static Mutex alloc_mutex;
-	static size_t total_memory;
-	static size_t max_memory;
+	static SafeNumeric<uint32_t> allocs_used;
+	static SafeNumeric<size_t> total_memory;
+	static SafeNumeric<size_t> max_memory;
+
+	// Returns nullptr when all allocs are in use.
+	static Alloc *allocate();
+	static void release(Alloc *p_alloc);
+#ifdef DEBUG_ENABLED
+	static void track_memory(size_t p_removed, size_t p_added);
+#endif
 
 	static void setup(uint32_t p_max_allocs = (1 << 16));
 	static void cleanup();
@@ -93,19 +106,11 @@ class PoolVector {
 
 		//must allocate something
 
-		MemoryPool::alloc_mutex.lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex.unlock();
-			ERR_FAIL_MSG("All memory pool allocations are in use, can't COW.");
-		}
+		MemoryPool::Alloc *new_alloc = MemoryPool::allocate();
+		ERR_FAIL_COND_MSG(!new_alloc, "All memory pool allocations are in use, can't COW.");
 
 		MemoryPool::Alloc *old_alloc = alloc;
-
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
+		alloc = new_alloc;
 
 		//copy the alloc data
 		alloc->size = old_alloc->size;
@@ -114,14 +119,9 @@ class PoolVector {
 		alloc->lock.set(0);
 
 #ifdef DEBUG_ENABLED
-		MemoryPool::total_memory += alloc->size;
-		if (MemoryPool::total_memory > MemoryPool::max_memory) {
-			MemoryPool::max_memory = MemoryPool::total_memory;
-		}
+		MemoryPool::track_memory(0, alloc->size);
 #endif
 
-		MemoryPool::alloc_mutex.unlock();
-
 		if (MemoryPool::memory_pool) {
 		} else {
 			alloc->mem = memalloc(alloc->size);
@@ -145,9 +145,7 @@ class PoolVector {
 			//this should never happen but..
 
 #ifdef DEBUG_ENABLED
-			MemoryPool::alloc_mutex.lock();
-			MemoryPool::total_memory -= old_alloc->size;
-			MemoryPool::alloc_mutex.unlock();
+			MemoryPool::track_memory(old_alloc->size, 0);
 #endif
 
 			{
@@ -170,11 +168,7 @@ class PoolVector {
 				old_alloc->mem = nullptr;
 				old_alloc->size = 0;
 
-				MemoryPool::alloc_mutex.lock();
-				old_alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = old_alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex.unlock();
+				MemoryPool::release(old_alloc);
 			}
 		}
 	}
@@ -222,9 +216,7 @@ class PoolVector {
 		}
 
 #ifdef DEBUG_ENABLED
-		MemoryPool::alloc_mutex.lock();
-		MemoryPool::total_memory -= alloc->size;
-		MemoryPool::alloc_mutex.unlock();
+		MemoryPool::track_memory(alloc->size, 0);
 #endif
 
 		if (MemoryPool::memory_pool) {
@@ -236,11 +228,7 @@ class PoolVector {
 			alloc->mem = nullptr;
 			alloc->size = 0;
 
-			MemoryPool::alloc_mutex.lock();
-			alloc->free_list = MemoryPool::free_list;
-			MemoryPool::free_list = alloc;
-			MemoryPool::allocs_used--;
-			MemoryPool::alloc_mutex.unlock();
+			MemoryPool::release(alloc);
 		}
 
 		alloc = nullptr;
@@ -567,23 +555,13 @@ Error PoolVector<T>::resize(int p_size) {
 		}
 
 		//must allocate something
-		MemoryPool::alloc_mutex.lock();
-		if (MemoryPool::allocs_used == MemoryPool::alloc_count) {
-			MemoryPool::alloc_mutex.unlock();
-			ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "All memory pool allocations are in use.");
-		}
-
-		//take one from the free list
-		alloc = MemoryPool::free_list;
-		MemoryPool::free_list = alloc->free_list;
-		//increment the used counter
-		MemoryPool::allocs_used++;
+		alloc = MemoryPool::allocate();
+		ERR_FAIL_COND_V_MSG(!alloc, ERR_OUT_OF_MEMORY, "All memory pool allocations are in use.");
 
 		//cleanup the alloc
 		alloc->size = 0;
 		alloc->refcount.init();
 		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
-		MemoryPool::alloc_mutex.unlock();
 
 	} else {
 		ERR_FAIL_COND_V_MSG(alloc->lock.get() > 0, ERR_LOCKED, "Can't resize PoolVector if locked."); //can't resize if locked!
@@ -603,13 +581,7 @@ Error PoolVector<T>::resize(int p_size) {
 	_copy_on_write(); // make it unique
 
 #ifdef DEBUG_ENABLED
-	MemoryPool::alloc_mutex.lock();
-	MemoryPool::total_memory -= alloc->size;
-	MemoryPool::total_memory += new_size;
-	if (MemoryPool::total_memory > MemoryPool::max_memory) {
-		MemoryPool::max_memory = MemoryPool::total_memory;
-	}
-	MemoryPool::alloc_mutex.unlock();
+	MemoryPool::track_memory(alloc->size, new_size);
 #endif
 
 	int cur_elements = alloc->size / sizeof(T);
@@ -653,11 +625,7 @@ Error PoolVector<T>::resize(int p_size) {
 				alloc->mem = nullptr;
 				alloc->size = 0;
 
-				MemoryPool::alloc_mutex.lock();
-				alloc->free_list = MemoryPool::free_list;
-				MemoryPool::free_list = alloc;
-				MemoryPool::allocs_used--;
-				MemoryPool::alloc_mutex.unlock();
+				MemoryPool::release(alloc);
 
 			} else {
 				alloc->mem = memrealloc(alloc->mem, new_size);
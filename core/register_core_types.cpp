@@ -62,16 +62,20 @@
 #include "core/math/a_star.h"
 #include "core/math/expression.h"
 #include "core/math/geometry.h"
+#include "core/math/mesh_sampler.h"
+#include "core/math/random_distribution.h"
 #include "core/math/random_number_generator.h"
 #include "core/math/triangle_mesh.h"
 #include "core/os/input.h"
 #include "core/os/main_loop.h"
+#include "core/os/task_scheduler.h"
 #include "core/os/time.h"
 #include "core/packed_data_container.h"
 #include "core/path_remap.h"
 #include "core/project_settings.h"
 #include "core/translation.h"
 #include "core/undo_redo.h"
+#include "core/variant_pool.h"
 
 static Ref<ResourceFormatSaverBinary> resource_saver_binary;
 static Ref<ResourceFormatLoaderBinary> resource_loader_binary;
@@ -93,6 +97,8 @@ static IP *ip = nullptr;
 
 static _Geometry *_geometry = nullptr;
 
+static TaskScheduler *task_scheduler = nullptr;
+
 extern Mutex _global_mutex;
 
 extern void register_global_constants();
@@ -105,6 +111,10 @@ void register_core_types() {
 
 	StringName::setup();
 
+	task_scheduler = memnew(TaskScheduler);
+	task_scheduler->init();
+	TaskScheduler::set_singleton(task_scheduler);
+
 	register_global_constants();
 	register_variant_methods();
 
@@ -209,6 +219,8 @@ void register_core_types() {
 	ClassDB::register_class<AStar2D>();
 	ClassDB::register_class<EncodedObjectAsID>();
 	ClassDB::register_class<RandomNumberGenerator>();
+	ClassDB::register_class<RandomDistribution>();
+	ClassDB::register_class<MeshSampler>();
 
 	ClassDB::register_class<JSONParseResult>();
 
@@ -317,7 +329,12 @@ void unregister_core_types() {
 	ClassDB::cleanup();
 	ResourceCache::clear();
 	CoreStringNames::free();
+
+	TaskScheduler::set_singleton(nullptr);
+	memdelete(task_scheduler);
+
 	StringName::cleanup();
 
+	VariantPool::cleanup();
 	MemoryPool::cleanup();
 }
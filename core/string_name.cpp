@@ -46,7 +46,7 @@ StringName _scs_create(const char *p_chr) {
 }
 
 bool StringName::configured = false;
-Mutex StringName::lock;
+RWLock StringName::shard_locks[STRING_SHARD_LEN];
 
 void StringName::setup() {
 	ERR_FAIL_COND(configured);
@@ -57,7 +57,9 @@ void StringName::setup() {
 }
 
 void StringName::cleanup() {
-	lock.lock();
+	for (int i = 0; i < STRING_SHARD_LEN; i++) {
+		shard_locks[i].write_lock();
+	}
 
 	int lost_strings = 0;
 	for (int i = 0; i < STRING_TABLE_LEN; i++) {
@@ -79,14 +81,18 @@ void StringName::cleanup() {
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
-	lock.unlock();
+	for (int i = 0; i < STRING_SHARD_LEN; i++) {
+		shard_locks[i].write_unlock();
+	}
 }
 
 void StringName::unref() {
 	ERR_FAIL_COND(!configured);
 
 	if (_data && _data->refcount.unref()) {
-		lock.lock();
+		// Once the count is zero lookups can't take a reference anymore, they
+		// skip the entry until it's unlinked here.
+		RWLockWrite write(_get_shard_lock(_data->idx));
 
 		if (_data->prev) {
 			_data->prev->next = _data->next;
@@ -101,12 +107,91 @@ void StringName::unref() {
 			_data->next->prev = _data->prev;
 		}
 		memdelete(_data);
-		lock.unlock();
 	}
 
 	_data = nullptr;
 }
 
+static _FORCE_INLINE_ bool _name_matches(const char *p_cname, const String &p_name, const char *p_other) {
+	if (p_cname) {
+		return strcmp(p_cname, p_other) == 0;
+	}
+	return p_name == p_other;
+}
+
+static _FORCE_INLINE_ bool _name_matches(const char *p_cname, const String &p_name, const CharType *p_other) {
+	if (p_cname) {
+		while (*p_cname && CharType(*p_cname) == *p_other) {
+			p_cname++;
+			p_other++;
+		}
+		return CharType(*p_cname) == *p_other;
+	}
+	return p_name == p_other;
+}
+
+static _FORCE_INLINE_ bool _name_matches(const char *p_cname, const String &p_name, const String &p_other) {
+	if (p_cname) {
+		return p_other == p_cname;
+	}
+	return p_name == p_other;
+}
+
+// Must be called with the shard of p_idx locked. Entries whose count already
+// dropped to zero are being removed and are skipped.
+template <class T>
+StringName::_Data *StringName::_find_and_ref(uint32_t p_idx, uint32_t p_hash, const T &p_name) {
+	for (_Data *d = _table[p_idx]; d; d = d->next) {
+		// compare hash first
+		if (d->hash == p_hash && _name_matches(d->cname, d->name, p_name) && d->refcount.ref()) {
+			return d;
+		}
+	}
+	return nullptr;
+}
+
+template <class T>
+StringName::_Data *StringName::_search(uint32_t p_hash, const T &p_name) {
+	const uint32_t idx = p_hash & STRING_TABLE_MASK;
+	RWLockRead read(_get_shard_lock(idx));
+	return _find_and_ref(idx, p_hash, p_name);
+}
+
+template <class T>
+StringName::_Data *StringName::_intern(uint32_t p_hash, const T &p_name, const char *p_static_name) {
+	// Fast path, the name usually exists already.
+	_Data *d = _search(p_hash, p_name);
+	if (d) {
+		return d;
+	}
+
+	const uint32_t idx = p_hash & STRING_TABLE_MASK;
+	RWLockWrite write(_get_shard_lock(idx));
+
+	// Someone else may have added it meanwhile.
+	d = _find_and_ref(idx, p_hash, p_name);
+	if (d) {
+		return d;
+	}
+
+	d = memnew(_Data);
+	if (p_static_name) {
+		d->cname = p_static_name;
+	} else {
+		d->name = p_name;
+	}
+	d->refcount.init();
+	d->hash = p_hash;
+	d->idx = idx;
+	d->next = _table[idx];
+	d->prev = nullptr;
+	if (_table[idx]) {
+		_table[idx]->prev = d;
+	}
+	_table[idx] = d;
+	return d;
+}
+
 bool StringName::operator==(const String &p_name) const {
 	if (!_data) {
 		return (p_name.length() == 0);
@@ -164,44 +249,7 @@ StringName::StringName(const char *p_name) {
 		return; //empty, ignore
 	}
 
-	lock.lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock.unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
-
-	lock.unlock();
+	_data = _intern(String::hash(p_name), p_name, nullptr);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -211,44 +259,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock.lock();
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock.unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
-
-	lock.unlock();
+	_data = _intern(String::hash(p_static_string.ptr), p_static_string.ptr, p_static_string.ptr);
 }
 
 StringName::StringName(const String &p_name) {
@@ -260,43 +271,7 @@ StringName::StringName(const String &p_name) {
 		return;
 	}
 
-	lock.lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock.unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = nullptr;
-	_data->next = _table[idx];
-	_data->prev = nullptr;
-	if (_table[idx]) {
-		_table[idx]->prev = _data;
-	}
-	_table[idx] = _data;
-
-	lock.unlock();
+	_data = _intern(p_name.hash(), p_name, nullptr);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -307,30 +282,7 @@ StringName StringName::search(const char *p_name) {
 		return StringName();
 	}
 
-	lock.lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock.unlock();
-
-		return StringName(_data);
-	}
-
-	lock.unlock();
-	return StringName(); //does not exist
+	return StringName(_search(String::hash(p_name), p_name)); //null if it does not exist
 }
 
 StringName StringName::search(const CharType *p_name) {
@@ -341,56 +293,13 @@ StringName StringName::search(const CharType *p_name) {
 		return StringName();
 	}
 
-	lock.lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock.unlock();
-		return StringName(_data);
-	}
-
-	lock.unlock();
-	return StringName(); //does not exist
+	return StringName(_search(String::hash(p_name), p_name)); //null if it does not exist
 }
+
 StringName StringName::search(const String &p_name) {
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock.lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name()) {
-			break;
-		}
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock.unlock();
-		return StringName(_data);
-	}
-
-	lock.unlock();
-	return StringName(); //does not exist
+	return StringName(_search(p_name.hash(), p_name)); //null if it does not exist
 }
 
 StringName::StringName() {
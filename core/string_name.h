@@ -31,7 +31,7 @@
 #ifndef STRING_NAME_H
 #define STRING_NAME_H
 
-#include "core/os/mutex.h"
+#include "core/os/rw_lock.h"
 #include "core/safe_refcount.h"
 #include "core/ustring.h"
 
@@ -47,7 +47,13 @@ class StringName {
 
 		STRING_TABLE_BITS = 12,
 		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		STRING_TABLE_MASK = STRING_TABLE_LEN - 1,
+
+		// Buckets are spread over independently locked shards, so threads interning
+		// different names rarely touch the same lock.
+		STRING_SHARD_BITS = 6,
+		STRING_SHARD_LEN = 1 << STRING_SHARD_BITS,
+		STRING_SHARD_MASK = STRING_SHARD_LEN - 1
 	};
 
 	struct _Data {
@@ -81,7 +87,16 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex lock;
+	static RWLock shard_locks[STRING_SHARD_LEN];
+	_FORCE_INLINE_ static RWLock &_get_shard_lock(uint32_t p_idx) { return shard_locks[p_idx & STRING_SHARD_MASK]; }
+
+	template <class T>
+	static _Data *_find_and_ref(uint32_t p_idx, uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_search(uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_intern(uint32_t p_hash, const T &p_name, const char *p_static_name);
+
 	static void setup();
 	static void cleanup();
 	static bool configured;
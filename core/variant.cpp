@@ -37,9 +37,17 @@
 #include "core/print_string.h"
 #include "core/resource.h"
 #include "core/variant_parser.h"
+#include "core/variant_pool.h"
 #include "scene/gui/control.h"
 #include "scene/main/node.h"
 
+// Counterpart of memnew_placement(VariantPool::alloc(), ...) for the types stored out of line.
+template <class T>
+static _FORCE_INLINE_ void _pool_delete(T *p_ptr) {
+	p_ptr->~T();
+	VariantPool::free(p_ptr);
+}
+
 String Variant::get_type_name(Variant::Type p_type) {
 	switch (p_type) {
 		case NIL: {
@@ -894,7 +902,7 @@ void Variant::reference(const Variant &p_variant) {
 			memnew_placement(_data._mem, Rect2(*reinterpret_cast<const Rect2 *>(p_variant._data._mem)));
 		} break;
 		case TRANSFORM2D: {
-			_data._transform2d = memnew(Transform2D(*p_variant._data._transform2d));
+			_data._transform2d = memnew_placement(VariantPool::alloc(), Transform2D(*p_variant._data._transform2d));
 		} break;
 		case VECTOR3: {
 			memnew_placement(_data._mem, Vector3(*reinterpret_cast<const Vector3 *>(p_variant._data._mem)));
@@ -904,18 +912,18 @@ void Variant::reference(const Variant &p_variant) {
 		} break;
 
 		case AABB: {
-			_data._aabb = memnew(::AABB(*p_variant._data._aabb));
+			_data._aabb = memnew_placement(VariantPool::alloc(), ::AABB(*p_variant._data._aabb));
 		} break;
 		case QUAT: {
 			memnew_placement(_data._mem, Quat(*reinterpret_cast<const Quat *>(p_variant._data._mem)));
 
 		} break;
 		case BASIS: {
-			_data._basis = memnew(Basis(*p_variant._data._basis));
+			_data._basis = memnew_placement(VariantPool::alloc(), Basis(*p_variant._data._basis));
 
 		} break;
 		case TRANSFORM: {
-			_data._transform = memnew(Transform(*p_variant._data._transform));
+			_data._transform = memnew_placement(VariantPool::alloc(), Transform(*p_variant._data._transform));
 		} break;
 
 		// misc types
@@ -1031,16 +1039,16 @@ void Variant::clear() {
 		RECT2
 	*/
 		case TRANSFORM2D: {
-			memdelete(_data._transform2d);
+			_pool_delete(_data._transform2d);
 		} break;
 		case AABB: {
-			memdelete(_data._aabb);
+			_pool_delete(_data._aabb);
 		} break;
 		case BASIS: {
-			memdelete(_data._basis);
+			_pool_delete(_data._basis);
 		} break;
 		case TRANSFORM: {
-			memdelete(_data._transform);
+			_pool_delete(_data._transform);
 		} break;
 
 		// misc types
@@ -2116,12 +2124,12 @@ Variant::Variant(const Plane &p_plane) {
 }
 Variant::Variant(const ::AABB &p_aabb) {
 	type = AABB;
-	_data._aabb = memnew(::AABB(p_aabb));
+	_data._aabb = memnew_placement(VariantPool::alloc(), ::AABB(p_aabb));
 }
 
 Variant::Variant(const Basis &p_matrix) {
 	type = BASIS;
-	_data._basis = memnew(Basis(p_matrix));
+	_data._basis = memnew_placement(VariantPool::alloc(), Basis(p_matrix));
 }
 
 Variant::Variant(const Quat &p_quat) {
@@ -2130,12 +2138,12 @@ Variant::Variant(const Quat &p_quat) {
 }
 Variant::Variant(const Transform &p_transform) {
 	type = TRANSFORM;
-	_data._transform = memnew(Transform(p_transform));
+	_data._transform = memnew_placement(VariantPool::alloc(), Transform(p_transform));
 }
 
 Variant::Variant(const Transform2D &p_transform) {
 	type = TRANSFORM2D;
-	_data._transform2d = memnew(Transform2D(p_transform));
+	_data._transform2d = memnew_placement(VariantPool::alloc(), Transform2D(p_transform));
 }
 Variant::Variant(const Color &p_color) {
 	type = COLOR;
@@ -31,6 +31,8 @@
 #include "variant.h"
 
 #include <core/math/random_number_generator.h>
+#include "core/math/random_pool_vector.h"
+#include "core/math/random_source.h"
 #include "core/color_names.inc"
 #include "core/core_string_names.h"
 #include "core/crypto/crypto_core.h"
@@ -587,7 +589,14 @@ struct _VariantCall {
 	VCALL_LOCALMEM1(Array, erase);
 	VCALL_LOCALMEM0(Array, sort);
 	VCALL_LOCALMEM2(Array, sort_custom);
-	VCALL_LOCALMEM0(Array, shuffle);
+	static void _call_Array_shuffle(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+		reinterpret_cast<Array *>(p_self._data._mem)->shuffle(Object::cast_to<RandomNumberGenerator>(*p_args[0]));
+	}
+
+	static void _call_Array_sample(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+		r_ret = reinterpret_cast<Array *>(p_self._data._mem)->sample(*p_args[0], Object::cast_to<RandomNumberGenerator>(*p_args[1]));
+	}
+
 	VCALL_LOCALMEM2R(Array, bsearch);
 	VCALL_LOCALMEM4R(Array, bsearch_custom);
 	VCALL_LOCALMEM1R(Array, duplicate);
@@ -690,6 +699,38 @@ struct _VariantCall {
 		r_ret = s;
 	}
 
+	// Pool array shuffle() and sample() draw from the given RandomNumberGenerator, or from the global one.
+	template <class T>
+	static void _pool_shuffle(PoolVector<T> &p_array, const Variant &p_rng) {
+		RandomNumberGenerator *rng = Object::cast_to<RandomNumberGenerator>(p_rng);
+		if (rng) {
+			RandomSourceRNG source = { rng };
+			random_shuffle(p_array, source);
+		} else {
+			RandomSourceGlobal source;
+			random_shuffle(p_array, source);
+		}
+	}
+
+	template <class T>
+	static PoolVector<T> _pool_sample(const PoolVector<T> &p_array, int p_count, const Variant &p_rng) {
+		RandomNumberGenerator *rng = Object::cast_to<RandomNumberGenerator>(p_rng);
+		if (rng) {
+			RandomSourceRNG source = { rng };
+			return random_sample(p_array, p_count, source);
+		}
+		RandomSourceGlobal source;
+		return random_sample(p_array, p_count, source);
+	}
+
+#define VCALL_POOL_RANDOM(m_type)                                                                     \
+	static void _call_##m_type##_shuffle(Variant &r_ret, Variant &p_self, const Variant **p_args) {   \
+		_pool_shuffle(*reinterpret_cast<m_type *>(p_self._data._mem), *p_args[0]);                    \
+	}                                                                                                 \
+	static void _call_##m_type##_sample(Variant &r_ret, Variant &p_self, const Variant **p_args) {    \
+		r_ret = _pool_sample(*reinterpret_cast<m_type *>(p_self._data._mem), *p_args[0], *p_args[1]); \
+	}
+
 	VCALL_LOCALMEM0R(PoolByteArray, size);
 	VCALL_LOCALMEM0R(PoolByteArray, empty);
 	VCALL_LOCALMEM2(PoolByteArray, set);
@@ -708,6 +749,7 @@ struct _VariantCall {
 	VCALL_LOCALMEM1R(PoolByteArray, count);
 	VCALL_LOCALMEM1R(PoolByteArray, has);
 	VCALL_LOCALMEM0(PoolByteArray, sort);
+	VCALL_POOL_RANDOM(PoolByteArray);
 
 	VCALL_LOCALMEM0R(PoolIntArray, size);
 	VCALL_LOCALMEM0R(PoolIntArray, empty);
@@ -726,6 +768,7 @@ struct _VariantCall {
 	VCALL_LOCALMEM1R(PoolIntArray, count);
 	VCALL_LOCALMEM1R(PoolIntArray, has);
 	VCALL_LOCALMEM0(PoolIntArray, sort);
+	VCALL_POOL_RANDOM(PoolIntArray);
 
 	VCALL_LOCALMEM0R(PoolRealArray, size);
 	VCALL_LOCALMEM0R(PoolRealArray, empty);
@@ -744,6 +787,7 @@ struct _VariantCall {
 	VCALL_LOCALMEM1R(PoolRealArray, count);
 	VCALL_LOCALMEM1R(PoolRealArray, has);
 	VCALL_LOCALMEM0(PoolRealArray, sort);
+	VCALL_POOL_RANDOM(PoolRealArray);
 
 	VCALL_LOCALMEM0R(PoolStringArray, size);
 	VCALL_LOCALMEM0R(PoolStringArray, empty);
@@ -763,6 +807,7 @@ struct _VariantCall {
 	VCALL_LOCALMEM1R(PoolStringArray, count);
 	VCALL_LOCALMEM1R(PoolStringArray, has);
 	VCALL_LOCALMEM0(PoolStringArray, sort)
+	VCALL_POOL_RANDOM(PoolStringArray);
 
 	VCALL_LOCALMEM0R(PoolVector2Array, size);
 	VCALL_LOCALMEM0R(PoolVector2Array, empty);
@@ -781,6 +826,7 @@ struct _VariantCall {
 	VCALL_LOCALMEM1R(PoolVector2Array, count);
 	VCALL_LOCALMEM1R(PoolVector2Array, has);
 	VCALL_LOCALMEM0(PoolVector2Array, sort);
+	VCALL_POOL_RANDOM(PoolVector2Array);
 
 	VCALL_LOCALMEM0R(PoolVector3Array, size);
 	VCALL_LOCALMEM0R(PoolVector3Array, empty);
@@ -799,6 +845,7 @@ struct _VariantCall {
 	VCALL_LOCALMEM1R(PoolVector3Array, count);
 	VCALL_LOCALMEM1R(PoolVector3Array, has);
 	VCALL_LOCALMEM0(PoolVector3Array, sort);
+	VCALL_POOL_RANDOM(PoolVector3Array);
 
 	VCALL_LOCALMEM0R(PoolColorArray, size);
 	VCALL_LOCALMEM0R(PoolColorArray, empty);
@@ -817,6 +864,7 @@ struct _VariantCall {
 	VCALL_LOCALMEM1R(PoolColorArray, count);
 	VCALL_LOCALMEM1R(PoolColorArray, has);
 	VCALL_LOCALMEM0(PoolColorArray, sort);
+	VCALL_POOL_RANDOM(PoolColorArray);
 
 #define VCALL_PTR0(m_type, m_method) \
 	static void _call_##m_type##_##m_method(Variant &r_ret, Variant &p_self, const Variant **p_args) { reinterpret_cast<m_type *>(p_self._data._ptr)->m_method(); }
@@ -1967,7 +2015,8 @@ void register_variant_methods() {
 	ADDFUNC1RNC(ARRAY, NIL, Array, pop_at, INT, "position", varray());
 	ADDFUNC0NC(ARRAY, NIL, Array, sort, varray());
 	ADDFUNC2NC(ARRAY, NIL, Array, sort_custom, OBJECT, "obj", STRING, "func", varray());
-	ADDFUNC0NC(ARRAY, NIL, Array, shuffle, varray());
+	ADDFUNC1NC(ARRAY, NIL, Array, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(ARRAY, ARRAY, Array, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 	ADDFUNC2R(ARRAY, INT, Array, bsearch, NIL, "value", BOOL, "before", varray(true));
 	ADDFUNC4R(ARRAY, INT, Array, bsearch_custom, NIL, "value", OBJECT, "obj", STRING, "func", BOOL, "before", varray(true));
 	ADDFUNC0NC(ARRAY, NIL, Array, invert, varray());
@@ -1993,6 +2042,8 @@ void register_variant_methods() {
 	ADDFUNC1R(POOL_BYTE_ARRAY, INT, PoolByteArray, count, INT, "value", varray());
 	ADDFUNC1R(POOL_BYTE_ARRAY, BOOL, PoolByteArray, has, INT, "value", varray());
 	ADDFUNC0(POOL_BYTE_ARRAY, NIL, PoolByteArray, sort, varray());
+	ADDFUNC1(POOL_BYTE_ARRAY, NIL, PoolByteArray, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(POOL_BYTE_ARRAY, POOL_BYTE_ARRAY, PoolByteArray, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 
 	ADDFUNC0R(POOL_BYTE_ARRAY, STRING, PoolByteArray, get_string_from_ascii, varray());
 	ADDFUNC0R(POOL_BYTE_ARRAY, STRING, PoolByteArray, get_string_from_utf8, varray());
@@ -2017,6 +2068,8 @@ void register_variant_methods() {
 	ADDFUNC1R(POOL_INT_ARRAY, INT, PoolIntArray, count, INT, "value", varray());
 	ADDFUNC1R(POOL_INT_ARRAY, BOOL, PoolIntArray, has, INT, "value", varray());
 	ADDFUNC0(POOL_INT_ARRAY, NIL, PoolIntArray, sort, varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(POOL_INT_ARRAY, POOL_INT_ARRAY, PoolIntArray, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 
 	ADDFUNC0R(POOL_REAL_ARRAY, INT, PoolRealArray, size, varray());
 	ADDFUNC0R(POOL_REAL_ARRAY, BOOL, PoolRealArray, empty, varray());
@@ -2034,6 +2087,8 @@ void register_variant_methods() {
 	ADDFUNC1R(POOL_REAL_ARRAY, INT, PoolRealArray, count, REAL, "value", varray());
 	ADDFUNC1R(POOL_REAL_ARRAY, BOOL, PoolRealArray, has, REAL, "value", varray());
 	ADDFUNC0(POOL_REAL_ARRAY, NIL, PoolRealArray, sort, varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(POOL_REAL_ARRAY, POOL_REAL_ARRAY, PoolRealArray, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 
 	ADDFUNC0R(POOL_STRING_ARRAY, INT, PoolStringArray, size, varray());
 	ADDFUNC0R(POOL_STRING_ARRAY, BOOL, PoolStringArray, empty, varray());
@@ -2052,6 +2107,8 @@ void register_variant_methods() {
 	ADDFUNC1R(POOL_STRING_ARRAY, INT, PoolStringArray, count, STRING, "value", varray());
 	ADDFUNC1R(POOL_STRING_ARRAY, BOOL, PoolStringArray, has, STRING, "value", varray());
 	ADDFUNC0(POOL_STRING_ARRAY, NIL, PoolStringArray, sort, varray());
+	ADDFUNC1(POOL_STRING_ARRAY, NIL, PoolStringArray, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(POOL_STRING_ARRAY, POOL_STRING_ARRAY, PoolStringArray, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 
 	ADDFUNC0R(POOL_VECTOR2_ARRAY, INT, PoolVector2Array, size, varray());
 	ADDFUNC0R(POOL_VECTOR2_ARRAY, BOOL, PoolVector2Array, empty, varray());
@@ -2069,6 +2126,8 @@ void register_variant_methods() {
 	ADDFUNC1R(POOL_VECTOR2_ARRAY, INT, PoolVector2Array, count, VECTOR2, "value", varray());
 	ADDFUNC1R(POOL_VECTOR2_ARRAY, BOOL, PoolVector2Array, has, VECTOR2, "value", varray());
 	ADDFUNC0(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, sort, varray());
+	ADDFUNC1(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(POOL_VECTOR2_ARRAY, POOL_VECTOR2_ARRAY, PoolVector2Array, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 
 	ADDFUNC0R(POOL_VECTOR3_ARRAY, INT, PoolVector3Array, size, varray());
 	ADDFUNC0R(POOL_VECTOR3_ARRAY, BOOL, PoolVector3Array, empty, varray());
@@ -2086,6 +2145,8 @@ void register_variant_methods() {
 	ADDFUNC1R(POOL_VECTOR3_ARRAY, INT, PoolVector3Array, count, VECTOR3, "value", varray());
 	ADDFUNC1R(POOL_VECTOR3_ARRAY, BOOL, PoolVector3Array, has, VECTOR3, "value", varray());
 	ADDFUNC0(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, sort, varray());
+	ADDFUNC1(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(POOL_VECTOR3_ARRAY, POOL_VECTOR3_ARRAY, PoolVector3Array, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 
 	ADDFUNC0R(POOL_COLOR_ARRAY, INT, PoolColorArray, size, varray());
 	ADDFUNC0R(POOL_COLOR_ARRAY, BOOL, PoolColorArray, empty, varray());
@@ -2103,6 +2164,8 @@ void register_variant_methods() {
 	ADDFUNC1R(POOL_COLOR_ARRAY, INT, PoolColorArray, count, COLOR, "value", varray());
 	ADDFUNC1R(POOL_COLOR_ARRAY, BOOL, PoolColorArray, has, COLOR, "value", varray());
 	ADDFUNC0(POOL_COLOR_ARRAY, NIL, PoolColorArray, sort, varray());
+	ADDFUNC1(POOL_COLOR_ARRAY, NIL, PoolColorArray, shuffle, OBJECT, "rng", varray(Variant()));
+	ADDFUNC2R(POOL_COLOR_ARRAY, POOL_COLOR_ARRAY, PoolColorArray, sample, INT, "count", OBJECT, "rng", varray(Variant()));
 
 	//pointerbased
 
@@ -2223,6 +2286,7 @@ void register_variant_methods() {
 	_VariantCall::add_constant(Variant::RANDOM, "XORSHIFT128", Random::XORSHIFT128);
 	_VariantCall::add_constant(Variant::RANDOM, "XOROSHIRO128", Random::XOROSHIRO128);
 	_VariantCall::add_constant(Variant::RANDOM, "SPLITMIX64", Random::SPLITMIX64);
+	_VariantCall::add_constant(Variant::RANDOM, "PHILOX", Random::PHILOX);
 
 	_VariantCall::add_variant_constant(Variant::VECTOR3, "ZERO", Vector3(0, 0, 0));
 	_VariantCall::add_variant_constant(Variant::VECTOR3, "ONE", Vector3(1, 1, 1));
@@ -0,0 +1,208 @@
+/**************************************************************************/
+/*  variant_pool.cpp                                                      */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "variant_pool.h"
+
+#include "core/math/aabb.h"
+#include "core/math/transform_2d.h"
+#include "core/os/spin_lock.h"
+#include "core/paged_allocator.h"
+
+static_assert(sizeof(::AABB) <= sizeof(VariantPool::Slot), "AABB doesn't fit in a pool slot.");
+static_assert(sizeof(Basis) <= sizeof(VariantPool::Slot), "Basis doesn't fit in a pool slot.");
+static_assert(sizeof(Transform2D) <= sizeof(VariantPool::Slot), "Transform2D doesn't fit in a pool slot.");
+
+struct VariantPoolShared {
+	SpinLock lock;
+	PagedAllocator<VariantPool::Slot> allocator;
+	uint64_t trips = 0;
+	uint64_t slots_out = 0;
+
+	VariantPoolShared() :
+			allocator(VariantPool::PAGE_SIZE) {}
+};
+
+static VariantPoolShared &_get_shared() {
+	// Never destroyed, Variants may still be freed while static objects are.
+	static VariantPoolShared *shared = memnew(VariantPoolShared);
+	return *shared;
+}
+
+// No constructor or destructor: thread storage starts zeroed, and the cache stays usable after its
+// thread's destructors ran. On the main thread that happens before static objects are destroyed,
+// which can still free Variants.
+struct VariantPoolThreadCache {
+	enum State {
+		STATE_UNUSED,
+		STATE_ACTIVE,
+		STATE_RELEASED, // Returned to the shared pool, slots now bypass the cache.
+	};
+
+	VariantPool::Slot *slots[VariantPool::THREAD_CACHE_SIZE];
+	uint32_t count;
+	State state;
+
+	void activate();
+
+	bool refill() {
+		if (state != STATE_ACTIVE) {
+			if (state == STATE_RELEASED) {
+				return false;
+			}
+			activate();
+		}
+		VariantPoolShared &shared = _get_shared();
+		shared.lock.lock();
+		for (uint32_t i = 0; i < VariantPool::THREAD_CACHE_BATCH; i++) {
+			slots[count++] = shared.allocator.alloc();
+		}
+		shared.slots_out += VariantPool::THREAD_CACHE_BATCH;
+		shared.trips++;
+		shared.lock.unlock();
+		return true;
+	}
+
+	void flush(uint32_t p_amount) {
+		VariantPoolShared &shared = _get_shared();
+		shared.lock.lock();
+		for (uint32_t i = 0; i < p_amount; i++) {
+			shared.allocator.free(slots[--count]);
+		}
+		shared.slots_out -= p_amount;
+		shared.trips++;
+		shared.lock.unlock();
+	}
+
+	// Makes room for one more slot, or returns false once released.
+	bool make_room() {
+		if (state != STATE_ACTIVE) {
+			if (state == STATE_RELEASED) {
+				return false;
+			}
+			activate();
+		}
+		if (count == VariantPool::THREAD_CACHE_SIZE) {
+			flush(VariantPool::THREAD_CACHE_BATCH);
+		}
+		return true;
+	}
+
+	void release() {
+		if (count) {
+			flush(count);
+		}
+		state = STATE_RELEASED;
+	}
+};
+
+static thread_local VariantPoolThreadCache thread_cache;
+
+// Releases the thread's cache when the thread exits. Only constructed, and so only destroyed,
+// on threads that used the cache.
+struct VariantPoolThreadGuard {
+	~VariantPoolThreadGuard() {
+		thread_cache.release();
+	}
+};
+
+static thread_local VariantPoolThreadGuard thread_guard;
+
+void VariantPoolThreadCache::activate() {
+	// The first use of the guard registers its destructor for this thread.
+	(void)&thread_guard;
+	state = STATE_ACTIVE;
+}
+
+// Uncached paths, for threads whose cache was already released.
+static void *_alloc_shared() {
+	VariantPoolShared &shared = _get_shared();
+	shared.lock.lock();
+	void *slot = shared.allocator.alloc();
+	shared.slots_out++;
+	shared.trips++;
+	shared.lock.unlock();
+	return slot;
+}
+
+static void _free_shared(void *p_ptr) {
+	VariantPoolShared &shared = _get_shared();
+	shared.lock.lock();
+	shared.allocator.free((VariantPool::Slot *)p_ptr);
+	shared.slots_out--;
+	shared.trips++;
+	shared.lock.unlock();
+}
+
+void *VariantPool::alloc() {
+	VariantPoolThreadCache &cache = thread_cache;
+	if (unlikely(cache.count == 0) && !cache.refill()) {
+		return _alloc_shared();
+	}
+	return cache.slots[--cache.count];
+}
+
+void VariantPool::free(void *p_ptr) {
+	VariantPoolThreadCache &cache = thread_cache;
+	if (unlikely(cache.count == THREAD_CACHE_SIZE || cache.state != VariantPoolThreadCache::STATE_ACTIVE) && !cache.make_room()) {
+		_free_shared(p_ptr);
+		return;
+	}
+	cache.slots[cache.count++] = (Slot *)p_ptr;
+}
+
+uint64_t VariantPool::get_shared_trips() {
+	VariantPoolShared &shared = _get_shared();
+	shared.lock.lock();
+	uint64_t trips = shared.trips;
+	shared.lock.unlock();
+	return trips;
+}
+
+uint64_t VariantPool::get_slots_out() {
+	VariantPoolShared &shared = _get_shared();
+	shared.lock.lock();
+	uint64_t slots_out = shared.slots_out;
+	shared.lock.unlock();
+	return slots_out;
+}
+
+void VariantPool::cleanup() {
+	VariantPoolThreadCache &cache = thread_cache;
+	if (cache.count) {
+		cache.flush(cache.count);
+	}
+
+	VariantPoolShared &shared = _get_shared();
+	shared.lock.lock();
+	if (shared.slots_out == 0) {
+		shared.allocator.reset();
+	}
+	shared.lock.unlock();
+}
@@ -0,0 +1,68 @@
+/**************************************************************************/
+/*  variant_pool.h                                                        */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#ifndef VARIANT_POOL_H
+#define VARIANT_POOL_H
+
+#include "core/math/transform.h"
+#include "core/typedefs.h"
+
+// Storage for the types Variant keeps out of line: Transform, Basis, AABB
+// and Transform2D. Slots come from a shared PagedAllocator, with a small
+// cache per thread in front of it, so copying such Variants usually neither
+// allocates nor locks.
+class VariantPool {
+public:
+	// Big enough for the largest of them, Transform.
+	union Slot {
+		real_t align;
+		uint8_t mem[sizeof(Transform)];
+	};
+
+	enum {
+		THREAD_CACHE_SIZE = 64,
+		// Slots moved between a thread cache and the shared pool at once.
+		THREAD_CACHE_BATCH = THREAD_CACHE_SIZE / 2,
+		PAGE_SIZE = 256,
+	};
+
+	static void *alloc();
+	static void free(void *p_ptr);
+
+	// Times a thread cache had to lock the shared pool to refill or flush.
+	static uint64_t get_shared_trips();
+	// Slots handed out by the shared pool, cached or in use.
+	static uint64_t get_slots_out();
+
+	// Returns the calling thread's cache, and the pages too when every slot is back.
+	static void cleanup();
+};
+
+#endif // VARIANT_POOL_H
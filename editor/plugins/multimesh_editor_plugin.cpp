@@ -30,6 +30,7 @@
 
 #include "multimesh_editor_plugin.h"
 
+#include "core/math/mesh_sampler.h"
 #include "scene/3d/mesh_instance.h"
 #include "scene/gui/box_container.h"
 #include "spatial_editor_plugin.h"
@@ -138,21 +139,11 @@ void MultiMeshEditor::_populate() {
 	int facecount = faces.size();
 	ERR_FAIL_COND_MSG(!facecount, "Parent has no solid faces to populate.");
 
-	PoolVector<Face3>::Read r = faces.read();
+	Ref<MeshSampler> sampler;
+	sampler.instance();
+	ERR_FAIL_COND_MSG(!sampler->set_faces(faces), "Couldn't map area.");
 
-	float area_accum = 0;
-	Map<float, int> triangle_area_map;
-	for (int i = 0; i < facecount; i++) {
-		float area = r[i].get_area();
-		if (area < CMP_EPSILON) {
-			continue;
-		}
-		triangle_area_map[area_accum] = i;
-		area_accum += area;
-	}
-
-	ERR_FAIL_COND_MSG(triangle_area_map.size() == 0, "Couldn't map area.");
-	ERR_FAIL_COND_MSG(area_accum == 0, "Couldn't map area.");
+	PoolVector<Face3>::Read r = faces.read();
 
 	Ref<MultiMesh> multimesh = memnew(MultiMesh);
 	multimesh->set_mesh(mesh);
@@ -185,20 +176,18 @@ void MultiMeshEditor::_populate() {
 		axis_xform.rotate(Vector3(0, 0, 1), -Math_PI * 0.5);
 	}
 
-	for (int i = 0; i < instance_count; i++) {
-		float areapos = Math::random(0.0f, area_accum);
-
-		Map<float, int>::Element *E = triangle_area_map.find_closest(areapos);
-		ERR_FAIL_COND(!E);
-		int index = E->get();
-		ERR_FAIL_INDEX(index, facecount);
+	LocalVector<Vector3> positions;
+	LocalVector<Vector3> normals;
+	LocalVector<int> face_indices;
+	positions.resize(instance_count);
+	normals.resize(instance_count);
+	face_indices.resize(instance_count);
+	sampler->sample(instance_count, positions.ptr(), normals.ptr(), nullptr, face_indices.ptr());
 
-		// ok FINALLY get face
-		Face3 face = r[index];
-		//now compute some position inside the face...
-
-		Vector3 pos = face.get_random_point_inside();
-		Vector3 normal = face.get_plane().normal;
+	for (int i = 0; i < instance_count; i++) {
+		const Face3 &face = r[face_indices[i]];
+		Vector3 pos = positions[i];
+		Vector3 normal = normals[i];
 		Vector3 op_axis = (face.vertex[0] - face.vertex[1]).normalized();
 
 		Transform xform;
@@ -31,6 +31,7 @@
 #include "particles_editor_plugin.h"
 
 #include "core/io/resource_loader.h"
+#include "core/math/mesh_sampler.h"
 #include "editor/plugins/spatial_editor_plugin.h"
 #include "scene/3d/cpu_particles.h"
 #include "scene/resources/particles_material.h"
@@ -39,46 +40,25 @@ bool ParticlesEditorBase::_generate(PoolVector<Vector3> &points, PoolVector<Vect
 	bool use_normals = emission_fill->get_selected() == 1;
 
 	if (emission_fill->get_selected() < 2) {
-		float area_accum = 0;
-		Map<float, int> triangle_area_map;
-
-		for (int i = 0; i < geometry.size(); i++) {
-			float area = geometry[i].get_area();
-			if (area < CMP_EPSILON) {
-				continue;
-			}
-			triangle_area_map[area_accum] = i;
-			area_accum += area;
-		}
-
-		if (!triangle_area_map.size() || area_accum == 0) {
+		Ref<MeshSampler> sampler;
+		sampler.instance();
+		if (!geometry.size() || !sampler->set_faces(geometry)) {
 			EditorNode::get_singleton()->show_warning(TTR("The geometry's faces don't contain any area."));
 			return false;
 		}
 
 		int emissor_count = emission_amount->get_value();
+		points.resize(emissor_count);
+		if (use_normals) {
+			normals.resize(emissor_count);
+		}
 
-		for (int i = 0; i < emissor_count; i++) {
-			float areapos = Math::random(0.0f, area_accum);
-
-			Map<float, int>::Element *E = triangle_area_map.find_closest(areapos);
-			ERR_FAIL_COND_V(!E, false);
-			int index = E->get();
-			ERR_FAIL_INDEX_V(index, geometry.size(), false);
-
-			// ok FINALLY get face
-			Face3 face = geometry[index];
-			//now compute some position inside the face...
-
-			Vector3 pos = face.get_random_point_inside();
-
-			points.push_back(pos);
-
-			if (use_normals) {
-				Vector3 normal = face.get_plane().normal;
-				normals.push_back(normal);
-			}
+		PoolVector<Vector3>::Write wp = points.write();
+		PoolVector<Vector3>::Write wn;
+		if (use_normals) {
+			wn = normals.write();
 		}
+		sampler->sample(emissor_count, wp.ptr(), use_normals ? wn.ptr() : nullptr);
 	} else {
 		int gcount = geometry.size();
 
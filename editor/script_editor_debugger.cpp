@@ -1060,10 +1060,16 @@ void ScriptEditorDebugger::_parse_message(const String &p_msg, const Array &p_da
 				item.calls = 1;
 				item.line = 0;
 				item.name = values[j];
-				item.self = values[j + 1];
-				item.total = item.self;
 				item.signature = "categ::" + name + "::" + item.name;
-				item.name = item.name.capitalize();
+				if (values[j + 1].get_type() == Variant::INT) {
+					// A count rather than a time, e.g. random draws per call site: shown in the calls column.
+					item.calls = values[j + 1];
+					item.self = 0;
+				} else {
+					item.self = values[j + 1];
+					item.name = item.name.capitalize();
+				}
+				item.total = item.self;
 				c.total_time += item.total;
 				c.items.write[j / 2] = item;
 			}
@@ -38,6 +38,7 @@
 #include "core/io/image_loader.h"
 #include "core/io/ip.h"
 #include "core/io/resource_loader.h"
+#include "core/math/random_profiler.h"
 #include "core/message_queue.h"
 #include "core/os/dir_access.h"
 #include "core/os/os.h"
@@ -1236,6 +1237,9 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 	GLOBAL_DEF("debug/settings/stdout/verbose_stdout", false);
 
 	GLOBAL_DEF("debug/settings/physics_interpolation/enable_warnings", true);
+#ifdef DEBUG_ENABLED
+	RandomProfiler::set_active(GLOBAL_GET("debug/settings/profiler/random_draws"));
+#endif
 
 	if (!OS::get_singleton()->_verbose_stdout) { // Not manually overridden.
 		OS::get_singleton()->_verbose_stdout = GLOBAL_GET("debug/settings/stdout/verbose_stdout");
@@ -1251,6 +1255,7 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 	ProjectSettings::get_singleton()->set_custom_property_info("application/run/low_processor_mode_sleep_usec", PropertyInfo(Variant::INT, "application/run/low_processor_mode_sleep_usec", PROPERTY_HINT_RANGE, "0,33200,1,or_greater")); // No negative numbers
 
 	delta_sync_after_draw = GLOBAL_DEF("application/run/delta_sync_after_draw", false);
+	Math::set_thread_local_rand(GLOBAL_DEF("application/run/thread_local_random", false));
 	GLOBAL_DEF("application/run/delta_smoothing", true);
 	if (!delta_smoothing_override) {
 		OS::get_singleton()->set_delta_smoothing(GLOBAL_GET("application/run/delta_smoothing"));
@@ -2342,6 +2347,7 @@ bool Main::iteration() {
 	}
 
 	AudioServer::get_singleton()->update();
+	RandomProfiler::end_frame();
 
 	if (script_debugger) {
 		if (script_debugger->is_profiling()) {
@@ -30,6 +30,7 @@
 
 #include "performance.h"
 
+#include "core/math/random_profiler.h"
 #include "core/message_queue.h"
 #include "core/os/os.h"
 #include "scene/main/node.h"
@@ -75,6 +76,12 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(RANDOM_DRAWS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RANDOM_RESEEDS_IN_FRAME);
+	BIND_ENUM_CONSTANT(RANDOM_ALGORITHM_SWITCHES_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_COMMAND_QUEUE_DEPTH);
+	BIND_ENUM_CONSTANT(RENDER_COMMAND_QUEUE_STALL_TIME);
+	BIND_ENUM_CONSTANT(RENDER_COMMAND_QUEUE_SYNCS_IN_FRAME);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -123,6 +130,12 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"random/draws",
+		"random/reseeds",
+		"random/algorithm_switches",
+		"command_queue/depth",
+		"command_queue/stall_time",
+		"command_queue/syncs",
 
 	};
 
@@ -140,11 +153,11 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case MEMORY_STATIC:
 			return Memory::get_mem_usage();
 		case MEMORY_DYNAMIC:
-			return MemoryPool::total_memory;
+			return MemoryPool::total_memory.get();
 		case MEMORY_STATIC_MAX:
 			return Memory::get_mem_max_usage();
 		case MEMORY_DYNAMIC_MAX:
-			return MemoryPool::max_memory;
+			return MemoryPool::max_memory.get();
 		case MEMORY_MESSAGE_BUFFER_MAX:
 			return MessageQueue::get_singleton()->get_max_buffer_usage();
 		case OBJECT_COUNT:
@@ -193,6 +206,18 @@ float Performance::get_monitor(Monitor p_monitor) const {
 			return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY:
 			return AudioServer::get_singleton()->get_output_latency();
+		case RANDOM_DRAWS_IN_FRAME:
+			return RandomProfiler::get_frame_total(RandomProfiler::EVENT_DRAW);
+		case RANDOM_RESEEDS_IN_FRAME:
+			return RandomProfiler::get_frame_total(RandomProfiler::EVENT_RESEED);
+		case RANDOM_ALGORITHM_SWITCHES_IN_FRAME:
+			return RandomProfiler::get_frame_total(RandomProfiler::EVENT_ALGORITHM_SWITCH);
+		case RENDER_COMMAND_QUEUE_DEPTH:
+			return VS::get_singleton()->get_render_info(VS::INFO_COMMAND_QUEUE_DEPTH);
+		case RENDER_COMMAND_QUEUE_STALL_TIME:
+			return VS::get_singleton()->get_render_info(VS::INFO_COMMAND_QUEUE_STALL_USEC_IN_FRAME) / 1000000.0;
+		case RENDER_COMMAND_QUEUE_SYNCS_IN_FRAME:
+			return VS::get_singleton()->get_render_info(VS::INFO_COMMAND_QUEUE_SYNCS_IN_FRAME);
 
 		default: {
 		}
@@ -237,6 +262,12 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_MEMORY,
+		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
@@ -82,6 +82,12 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		RANDOM_DRAWS_IN_FRAME,
+		RANDOM_RESEEDS_IN_FRAME,
+		RANDOM_ALGORITHM_SWITCHES_IN_FRAME,
+		RENDER_COMMAND_QUEUE_DEPTH,
+		RENDER_COMMAND_QUEUE_STALL_TIME,
+		RENDER_COMMAND_QUEUE_SYNCS_IN_FRAME,
 		MONITOR_MAX
 	};
 
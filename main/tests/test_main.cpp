@@ -44,11 +44,16 @@
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_pool_vector.h"
 #include "test_render.h"
+#include "test_rng.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_string_name.h"
+#include "test_task_scheduler.h"
 #include "test_theme.h"
 #include "test_transform.h"
+#include "test_variant_pool.h"
 #include "test_xml_parser.h"
 
 const char **tests_get_names() {
@@ -71,6 +76,11 @@ const char **tests_get_names() {
 		"astar",
 		"xml_parser",
 		"theme",
+		"rng",
+		"task_scheduler",
+		"string_name",
+		"variant_pool",
+		"pool_vector",
 		nullptr
 	};
 
@@ -156,6 +166,26 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestTheme::test();
 	}
 
+	if (p_test == "rng") {
+		return TestRNG::test();
+	}
+
+	if (p_test == "task_scheduler") {
+		return TestTaskScheduler::test();
+	}
+
+	if (p_test == "string_name") {
+		return TestStringName::test();
+	}
+
+	if (p_test == "variant_pool") {
+		return TestVariantPool::test();
+	}
+
+	if (p_test == "pool_vector") {
+		return TestPoolVector::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return nullptr;
 }
@@ -33,6 +33,7 @@
 #include "core/math/basis.h"
 #include "core/math/camera_matrix.h"
 #include "core/math/math_funcs.h"
+#include "core/math/random_number_generator.h"
 #include "core/math/transform.h"
 #include "core/os/file_access.h"
 #include "core/os/keyboard.h"
@@ -393,7 +394,55 @@ uint32_t ihash3(uint32_t a) {
 	return a;
 }
 
+// Range and chi-square uniformity check of randf() for every algorithm and float conversion.
+static bool test_random_float_uniformity() {
+	static const char *algorithm_names[] = { "PCG", "XORSHIFT128", "XOROSHIRO128", "SPLITMIX64", "PHILOX" };
+	static const char *conversion_names[] = { "exact", "mantissa" };
+
+	const int samples = 100000;
+	const int bins = 100;
+	// 99.9th percentile of the chi-square distribution with 99 degrees of freedom.
+	const double chi_square_limit = 148.23;
+
+	bool success = true;
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		for (int conversion = 0; conversion < RandomNumberGenerator::FLOAT_CONVERSION_MAX; conversion++) {
+			RandomNumberGenerator rng;
+			rng.set_algo(algo);
+			rng.set_float_conversion((RandomNumberGenerator::FloatConversion)conversion);
+			rng.set_seed(1234);
+
+			int histogram[bins] = {};
+			bool in_range = true;
+			for (int i = 0; i < samples; i++) {
+				real_t value = rng.randf();
+				if (value < 0.0 || value > 1.0) {
+					in_range = false;
+					break;
+				}
+				histogram[MIN((int)(value * bins), bins - 1)]++;
+			}
+
+			double expected = (double)samples / bins;
+			double chi_square = 0.0;
+			for (int i = 0; i < bins; i++) {
+				double diff = histogram[i] - expected;
+				chi_square += diff * diff / expected;
+			}
+
+			bool passed = in_range && chi_square < chi_square_limit;
+			print_line(vformat("randf %s/%s: %s (chi-square %.2f)", algorithm_names[algo], conversion_names[conversion], passed ? "passed" : "FAILED", chi_square));
+			success = success && passed;
+		}
+	}
+	return success;
+}
+
 MainLoop *test() {
+	if (!test_random_float_uniformity()) {
+		print_line("Random float uniformity checks FAILED.");
+	}
+
 	{
 		float r = 1;
 		float g = 0.5;
@@ -441,9 +490,9 @@ MainLoop *test() {
 		print_line("RGBE: " + Color(rd, gd, bd));
 	}
 
-	print_line("Dvectors: " + itos(MemoryPool::allocs_used));
-	print_line("Mem used: " + itos(MemoryPool::total_memory));
-	print_line("MAx mem used: " + itos(MemoryPool::max_memory));
+	print_line("Dvectors: " + itos(MemoryPool::allocs_used.get()));
+	print_line("Mem used: " + itos(MemoryPool::total_memory.get()));
+	print_line("MAx mem used: " + itos(MemoryPool::max_memory.get()));
 
 	PoolVector<int> ints;
 	ints.resize(20);
@@ -465,9 +514,9 @@ MainLoop *test() {
 		}
 	}
 
-	print_line("later Dvectors: " + itos(MemoryPool::allocs_used));
-	print_line("later Mem used: " + itos(MemoryPool::total_memory));
-	print_line("Mlater Ax mem used: " + itos(MemoryPool::max_memory));
+	print_line("later Dvectors: " + itos(MemoryPool::allocs_used.get()));
+	print_line("later Mem used: " + itos(MemoryPool::total_memory.get()));
+	print_line("Mlater Ax mem used: " + itos(MemoryPool::max_memory.get()));
 
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
@@ -0,0 +1,123 @@
+/**************************************************************************/
+/*  test_pool_vector.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "test_pool_vector.h"
+
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+#include "core/safe_refcount.h"
+#include "main/tests/test_tools.h"
+
+namespace TestPoolVector {
+
+enum {
+	MAX_THREADS = 16,
+	SLOTS = 64,
+	SLOT_SIZE = 256,
+	THREAD_OPS = 20000,
+};
+
+static const TestReporter reporter("pool_vector");
+
+// Threads swap arrays through shared slots, so every copy-on-write,
+// resize and release races with the same on other threads.
+struct Exchange {
+	PoolVector<int> slots[SLOTS];
+	Mutex slot_locks[SLOTS];
+	SafeFlag failed;
+
+	static void work(void *p_self, uint32_t p_index) {
+		Exchange *e = (Exchange *)p_self;
+		uint32_t seed = p_index * 7919 + 1;
+		for (int i = 0; i < THREAD_OPS; i++) {
+			seed = seed * 1103515245 + 12345;
+			int slot = (seed >> 8) % SLOTS;
+
+			PoolVector<int> mine;
+			{
+				MutexLock lock(e->slot_locks[slot]);
+				mine = e->slots[slot];
+			}
+			{
+				PoolVector<int>::Read r = mine.read();
+				if (r[1] != 1 || r[SLOT_SIZE - 1] != SLOT_SIZE - 1) {
+					e->failed.set();
+				}
+			}
+			{
+				// Still shared with the slot, so this copies.
+				PoolVector<int>::Write w = mine.write();
+				w[0] = p_index;
+			}
+
+			PoolVector<int> scratch;
+			scratch.resize(SLOT_SIZE / 4);
+			scratch.resize(SLOT_SIZE / 2);
+
+			MutexLock lock(e->slot_locks[slot]);
+			e->slots[slot] = mine;
+		}
+	}
+
+	void setup() {
+		for (int i = 0; i < SLOTS; i++) {
+			slots[i].resize(SLOT_SIZE);
+			PoolVector<int>::Write w = slots[i].write();
+			for (int j = 0; j < SLOT_SIZE; j++) {
+				w[j] = j;
+			}
+		}
+	}
+};
+
+MainLoop *test() {
+	uint32_t allocs_before = MemoryPool::allocs_used.get();
+
+	Exchange *exchange = memnew(Exchange);
+	exchange->setup();
+	for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		uint64_t usec = test_run_threads(threads, &Exchange::work, exchange);
+		reporter.bench(vformat("exchange_%d_threads_mops", threads), threads * (double)THREAD_OPS / MAX(usec, (uint64_t)1));
+	}
+	bool success = reporter.check("values", !exchange->failed.is_set());
+	memdelete(exchange);
+
+	success = reporter.check("allocs_released", MemoryPool::allocs_used.get() == allocs_before) && success;
+
+	if (success) {
+		OS::get_singleton()->print("PoolVector checks passed.\n");
+	} else {
+		OS::get_singleton()->print("PoolVector checks FAILED.\n");
+	}
+	return nullptr;
+}
+
+} // namespace TestPoolVector
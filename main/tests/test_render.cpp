@@ -144,12 +144,12 @@ public:
 
 			ii.instance = vs->instance_create2(test_cube, scenario);
 
-			ii.base.translate(Math::random(-20, 20), Math::random(-20, 20), Math::random(-20, 18));
+			ii.base.translate(Math::random(-20.0, 20.0), Math::random(-20.0, 20.0), Math::random(-20.0, 18.0));
 			ii.base.rotate(Vector3(0, 1, 0), Math::randf() * Math_PI);
 			ii.base.rotate(Vector3(1, 0, 0), Math::randf() * Math_PI);
 			vs->instance_set_transform(ii.instance, ii.base);
 
-			ii.rot_axis = Vector3(Math::random(-1, 1), Math::random(-1, 1), Math::random(-1, 1)).normalized();
+			ii.rot_axis = Vector3(Math::random(-1.0, 1.0), Math::random(-1.0, 1.0), Math::random(-1.0, 1.0)).normalized();
 
 			instances.push_back(ii);
 		}
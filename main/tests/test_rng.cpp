@@ -0,0 +1,1312 @@
+/*************************************************************************/
+/*  test_rng.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2022 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2022 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_rng.h"
+
+#include "core/math/math_funcs.h"
+#include "core/math/mesh_sampler.h"
+#include "core/math/random_distribution.h"
+#include "core/math/random_lanes.h"
+#include "core/math/random_number_generator.h"
+#include "core/math/random_pool_vector.h"
+#include "core/math/random_profiler.h"
+#include "core/math/random_source.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/thread_work_pool.h"
+#include "core/sort_array.h"
+#include "core/ustring.h"
+#include "main/tests/test_tools.h"
+
+#include <stdio.h>
+
+namespace TestRNG {
+
+static const int BENCH_ITERATIONS = 10000000;
+
+static const char *algorithm_names[] = {
+	"pcg",
+	"xorshift128",
+	"xoroshiro128",
+	"splitmix64",
+	"philox",
+};
+
+// Keeps the optimizer from discarding the benchmarked draws.
+static volatile uint32_t bench_sink = 0;
+
+static double ns_per_call(uint64_t p_usec, int p_calls) {
+	return (double)p_usec * 1000.0 / (double)p_calls;
+}
+
+// Results are reported with test_report(), the suite being the algorithm (or "all").
+
+// Per-call cost through the virtual Random interface, which is what the generator did before engine tables.
+static double bench_virtual(Random *p_rand) {
+	uint32_t acc = 0;
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		acc += p_rand->rand();
+	}
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+	bench_sink = bench_sink + acc;
+	return ns_per_call(usec, BENCH_ITERATIONS);
+}
+
+// Throughput of one backend through its engine table, i.e. what RandomNumberGenerator calls.
+template <class T>
+static void bench_backend(const char *p_name) {
+	T backend;
+	Random *rand = &backend;
+	const RandomEngineFunctions &engine = RandomEngine<T>::functions;
+	engine.seed(rand, 12345);
+
+	test_report("bench", p_name, "virtual_randi_ns", bench_virtual(rand));
+
+	uint32_t acc = 0;
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		acc += engine.rand(rand);
+	}
+	test_report("bench", p_name, "randi_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	float accf = 0;
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		accf += engine.randf(rand);
+	}
+	test_report("bench", p_name, "randf_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	double accd = 0;
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		accd += engine.randd(rand);
+	}
+	test_report("bench", p_name, "randd_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	// Ranges at real_t precision against the double precision path.
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		accf += engine.random(rand, -1000.0, 1000.0);
+	}
+	test_report("bench", p_name, "randf_range_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		accd += engine.random_double(rand, -1000.0, 1000.0);
+	}
+	test_report("bench", p_name, "randd_range_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	real_t accn = 0;
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		accn += engine.randfn(rand, 0.0, 1.0);
+	}
+	test_report("bench", p_name, "randfn_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	// The Box-Muller path randfn() used before the ziggurat, as a reference.
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		accn += cos(Math_TAU * engine.randd(rand)) * sqrt(-2.0 * log(engine.randd(rand)));
+	}
+	test_report("bench", p_name, "box_muller_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS / 2; i++) {
+		real_t first, second;
+		engine.randfn_pair(rand, 0.0, 1.0, first, second);
+		accn += first + second;
+	}
+	test_report("bench", p_name, "randfn_pair_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		accn += engine.randexp(rand, 1.0);
+	}
+	test_report("bench", p_name, "randexp_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+	bench_sink = bench_sink + acc + (uint32_t)accf + (uint32_t)accd + (uint32_t)accn;
+
+	PoolIntArray ints;
+	ints.resize(BENCH_ITERATIONS);
+	{
+		PoolIntArray::Write w = ints.write();
+		from = OS::get_singleton()->get_ticks_usec();
+		engine.fill_randi(rand, w.ptr(), BENCH_ITERATIONS);
+		test_report("bench", p_name, "fill_randi_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+		bench_sink = bench_sink + w[BENCH_ITERATIONS - 1];
+	}
+
+	PoolRealArray reals;
+	reals.resize(BENCH_ITERATIONS);
+	{
+		PoolRealArray::Write w = reals.write();
+		from = OS::get_singleton()->get_ticks_usec();
+		engine.fill_randf(rand, w.ptr(), BENCH_ITERATIONS, 0.0, 1.0);
+		test_report("bench", p_name, "fill_randf_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+		from = OS::get_singleton()->get_ticks_usec();
+		engine.fill_randfn(rand, w.ptr(), BENCH_ITERATIONS, 0.0, 1.0);
+		test_report("bench", p_name, "fill_randfn_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+		bench_sink = bench_sink + (uint32_t)w[BENCH_ITERATIONS - 1];
+	}
+
+	PoolByteArray bytes;
+	bytes.resize(BENCH_ITERATIONS * 4);
+	{
+		PoolByteArray::Write w = bytes.write();
+		from = OS::get_singleton()->get_ticks_usec();
+		engine.fill_bytes(rand, w.ptr(), BENCH_ITERATIONS * 4);
+		// Per 4 bytes, comparable with the 32-bit values above.
+		test_report("bench", p_name, "fill_bytes_ns", ns_per_call(OS::get_singleton()->get_ticks_usec() - from, BENCH_ITERATIONS));
+		bench_sink = bench_sink + w[BENCH_ITERATIONS * 4 - 1];
+	}
+}
+
+template <class G>
+static bool test_lanes(const char *p_name) {
+	std::array<uint64_t, 2> seed = { { 0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL } };
+	G scalar(seed);
+	RandomLanes<G> lanes(scalar);
+
+	const int steps = 1000;
+	Vector<uint64_t> out;
+	out.resize(steps * RandomLanes<G>::LANES);
+	lanes.fill(out.ptrw(), out.size());
+
+	// Lane i must be the scalar stream jumped i times.
+	for (int lane = 0; lane < RandomLanes<G>::LANES; lane++) {
+		G ref = scalar;
+		for (int j = 0; j < lane; j++) {
+			ref.Jump();
+		}
+		for (int i = 0; i < steps; i++) {
+			if (ref.Next() != out[i * RandomLanes<G>::LANES + lane]) {
+				OS::get_singleton()->print("FAILED: %s lane %d diverges from the jumped scalar stream at step %d.\n", p_name, lane, i);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+template <class G>
+static void bench_lanes(const char *p_name) {
+	std::array<uint64_t, 2> seed = { { 0x853c49e6748fea9bULL, 0xda3e39cb94b95bdbULL } };
+	G scalar(seed);
+	RandomLanes<G> lanes(scalar);
+
+	// Small block so both paths run from cache and only generation is measured.
+	const int block = 1024;
+	const int rounds = BENCH_ITERATIONS / block;
+	uint64_t out[block];
+	uint64_t acc = 0;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < block; i++) {
+			out[i] = scalar.Next();
+		}
+		acc += out[r & (block - 1)];
+	}
+	uint64_t scalar_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int r = 0; r < rounds; r++) {
+		lanes.fill(out, block);
+		acc += out[r & (block - 1)];
+	}
+	uint64_t lanes_usec = OS::get_singleton()->get_ticks_usec() - from;
+	bench_sink = bench_sink + (uint32_t)acc;
+
+	test_report("lanes", p_name, "scalar_ns", ns_per_call(scalar_usec, rounds * block));
+	test_report("lanes", p_name, "lanes_ns", ns_per_call(lanes_usec, rounds * block));
+}
+
+// A span of 3 * 2^30 is where plain modulo is worst: 2^32 wraps over the first third of the
+// span twice, so that third would get half of all draws instead of a third.
+static bool test_randi_range_bias() {
+	RandomNumberGenerator rng;
+	rng.set_seed(99);
+	const int samples = 200000;
+	int first_third = 0;
+	for (int i = 0; i < samples; i++) {
+		if (rng.randi_range(-0x40000000, 0x7FFFFFFF) < 0) {
+			first_third++;
+		}
+	}
+	double ratio = (double)first_third / samples;
+	if (ratio < 0.32 || ratio > 0.347) {
+		OS::get_singleton()->print("FAILED: randi_range is biased, %.4f of draws in the first third.\n", ratio);
+		return false;
+	}
+	return true;
+}
+
+static void bench_randi_range() {
+	RandomNumberGenerator rng;
+	rng.set_seed(3);
+	int acc = 0;
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		acc += rng.randi_range(0, 1000);
+	}
+	uint64_t bounded_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_ITERATIONS; i++) {
+		acc += rng.randi() % 1001;
+	}
+	uint64_t modulo_usec = OS::get_singleton()->get_ticks_usec() - from;
+	bench_sink = bench_sink + acc;
+	test_report("bench", "pcg", "randi_range_ns", ns_per_call(bounded_usec, BENCH_ITERATIONS));
+	test_report("bench", "pcg", "randi_modulo_ns", ns_per_call(modulo_usec, BENCH_ITERATIONS));
+}
+
+// Per-entity usage: create a generator, reseed it, draw a few values and free it.
+static void bench_lifecycle() {
+	const int count = 100000;
+	uint32_t acc = 0;
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		Ref<RandomNumberGenerator> rng;
+		rng.instance();
+		rng->set_seed(i);
+		acc += rng->randi();
+		rng->set_seed(i * 31);
+		acc += rng->randi();
+	}
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+	bench_sink = bench_sink + acc;
+	// Create + 2 reseeds + 2 draws + free.
+	test_report("bench", "pcg", "lifecycle_ns", ns_per_call(usec, count));
+}
+
+// Scatter over a 64x64 grid of quads, per point with points, normals and face indices.
+static void bench_mesh_sampler() {
+	PoolVector<Face3> faces;
+	for (int x = 0; x < 64; x++) {
+		for (int z = 0; z < 64; z++) {
+			const Vector3 corner(x, Math::sin(x * 0.1) * z * 0.1, z);
+			faces.push_back(Face3(corner, corner + Vector3(1, 0, 0), corner + Vector3(0, 0.1, 1)));
+			faces.push_back(Face3(corner + Vector3(1, 0, 0), corner + Vector3(1, 0.1, 1), corner + Vector3(0, 0.1, 1)));
+		}
+	}
+	Ref<MeshSampler> sampler;
+	sampler.instance();
+	sampler->set_faces(faces);
+
+	const int count = 1000000;
+	LocalVector<Vector3> points;
+	LocalVector<Vector3> normals;
+	LocalVector<int> face_indices;
+	points.resize(count);
+	normals.resize(count);
+	face_indices.resize(count);
+	RandomNumberGenerator rng;
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	sampler->sample(count, points.ptr(), normals.ptr(), nullptr, face_indices.ptr(), 0, &rng);
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+	bench_sink = bench_sink + face_indices[count - 1];
+	test_report("bench", "pcg", "mesh_sampler_ns", ns_per_call(usec, count));
+}
+
+static void bench_throughput() {
+	bench_backend<RandomPCG>(algorithm_names[RandomNumberGenerator::PCG]);
+	bench_backend<RandomXSH128>(algorithm_names[RandomNumberGenerator::XORSHIFT128]);
+	bench_backend<RandomXOSH128>(algorithm_names[RandomNumberGenerator::XOROSHIRO128]);
+	bench_backend<RandomSPLIT64>(algorithm_names[RandomNumberGenerator::SPLITMIX64]);
+	bench_backend<RandomPhilox>(algorithm_names[RandomNumberGenerator::PHILOX]);
+}
+
+static bool test_determinism() {
+	bool success = true;
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		RandomNumberGenerator a;
+		RandomNumberGenerator b;
+		a.set_algo(algo);
+		b.set_algo(algo);
+		a.set_seed(42);
+		b.set_seed(42);
+		for (int i = 0; i < 1000; i++) {
+			if (a.randi() != b.randi()) {
+				OS::get_singleton()->print("FAILED: %s is not reproducible for equal seeds.\n", algorithm_names[algo]);
+				success = false;
+				break;
+			}
+		}
+	}
+	return success;
+}
+
+static bool test_fill_ranges() {
+	bool success = true;
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		RandomNumberGenerator rng;
+		rng.set_algo(algo);
+		rng.set_seed(7);
+
+		PoolRealArray values;
+		values.resize(10001);
+		rng.fill_randf(values, -2.0, 3.0);
+		PoolRealArray::Read r = values.read();
+		for (int i = 0; i < values.size(); i++) {
+			if (r[i] < -2.0 || r[i] > 3.0) {
+				OS::get_singleton()->print("FAILED: %s fill_randf value %f out of range.\n", algorithm_names[algo], (double)r[i]);
+				success = false;
+				break;
+			}
+		}
+	}
+	return success;
+}
+
+// fill_randf() follows the float conversion. With the exact one, a fill too short for the lanes
+// gives the same values as the same number of randf() calls (randd() with double real_t, except
+// for PCG). Mantissa fills stay on the 2^-24 (2^-53) grid, exact ones go below it.
+static bool test_fill_conversion() {
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		for (int conversion = 0; conversion < RandomNumberGenerator::FLOAT_CONVERSION_MAX; conversion++) {
+			const bool exact = conversion == RandomNumberGenerator::FLOAT_CONVERSION_EXACT;
+			RandomNumberGenerator filled;
+			RandomNumberGenerator drawn;
+			RandomNumberGenerator *rngs[2] = { &filled, &drawn };
+			for (int i = 0; i < 2; i++) {
+				rngs[i]->set_algo(algo);
+				rngs[i]->set_seed(17);
+				rngs[i]->set_float_conversion((RandomNumberGenerator::FloatConversion)conversion);
+			}
+
+#ifdef REAL_T_IS_DOUBLE
+			const double grid = 9007199254740992.0; // 2^53
+			const bool compare = exact && algo != RandomNumberGenerator::PCG;
+#else
+			const double grid = 16777216.0; // 2^24
+			const bool compare = exact;
+#endif
+			if (compare) {
+				// 100 values take at most 200 words, well below RANDOM_LANES_MIN_WORDS.
+				PoolRealArray head;
+				head.resize(100);
+				filled.fill_randf(head);
+				PoolRealArray::Read r = head.read();
+				for (int i = 0; i < head.size(); i++) {
+#ifdef REAL_T_IS_DOUBLE
+					const real_t single = drawn.randd();
+#else
+					const real_t single = drawn.randf();
+#endif
+					if (r[i] != single) {
+						OS::get_singleton()->print("FAILED: %s fill_randf value %d is %f, a single draw gave %f.\n", algorithm_names[algo], i, (double)r[i], (double)single);
+						return false;
+					}
+				}
+			}
+
+			PoolRealArray values;
+			values.resize(4096);
+			filled.fill_randf(values);
+			PoolRealArray::Read r = values.read();
+			int off_grid = 0;
+			for (int i = 0; i < values.size(); i++) {
+				const double scaled = (double)r[i] * grid;
+				off_grid += scaled != Math::floor(scaled);
+			}
+			if (exact ? off_grid == 0 : off_grid != 0) {
+				OS::get_singleton()->print("FAILED: %s (conversion %d) fill_randf has %d values off the mantissa grid.\n", algorithm_names[algo], conversion, off_grid);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// The double precision path must keep more bits than a float can hold, with either conversion.
+static bool test_double_precision() {
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		for (int conversion = 0; conversion < RandomNumberGenerator::FLOAT_CONVERSION_MAX; conversion++) {
+			RandomNumberGenerator rng;
+			rng.set_algo(algo);
+			rng.set_seed(11);
+			rng.set_float_conversion((RandomNumberGenerator::FloatConversion)conversion);
+			int beyond_float = 0;
+			double sum = 0.0;
+			for (int i = 0; i < 10000; i++) {
+				const double value = rng.randd_range(1e6, 2e6);
+				if (value < 1e6 || value > 2e6) {
+					OS::get_singleton()->print("FAILED: %s randd_range value %f out of range.\n", algorithm_names[algo], value);
+					return false;
+				}
+				// Floats are spaced 0.125 apart here.
+				beyond_float += value != (double)(float)value;
+				sum += rng.randdn(5.0, 2.0);
+			}
+			if (beyond_float < 9900 || Math::abs(sum / 10000 - 5.0) > 0.1) {
+				OS::get_singleton()->print("FAILED: %s (conversion %d) randd_range/randdn lack precision: %d of 10000 beyond float, mean %f.\n", algorithm_names[algo], conversion, beyond_float, sum / 10000);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Counter-based access must agree with sequential draws, including across block boundaries.
+static bool test_counter_access() {
+	const uint64_t key = 0xC0FFEE;
+	RandomNumberGenerator rng;
+	rng.set_algo(RandomNumberGenerator::PHILOX);
+	rng.set_seed(key);
+	for (uint64_t n = 0; n < 1000; n++) {
+		if (rng.randi() != rng.at(key, n)) {
+			OS::get_singleton()->print("FAILED: philox at(key, %d) differs from the sequential stream.\n", (int)n);
+			return false;
+		}
+	}
+
+	// Bulk fills continue from an unaligned counter.
+	rng.set_state(3);
+	PoolIntArray values;
+	values.resize(1001);
+	rng.fill_randi(values);
+	PoolIntArray::Read r = values.read();
+	for (int i = 0; i < values.size(); i++) {
+		if ((uint32_t)r[i] != rng.at(key, 3 + i)) {
+			OS::get_singleton()->print("FAILED: philox fill_randi differs from at() at word %d.\n", i);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Restoring a snapshot, into the same generator or a fresh one, must replay the same values.
+static bool test_state_bytes() {
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		for (int cycling = 0; cycling < 2; cycling++) {
+			Ref<RandomNumberGenerator> rng;
+			rng.instance();
+			rng->set_seed(0xBADC0DE + algo);
+			rng->set_cycling(cycling);
+			rng->set_cycling_steps(1);
+			rng->set_algo(algo);
+			for (int i = 0; i < 37; i++) {
+				rng->randi();
+			}
+			const PoolByteArray snapshot = rng->get_state_bytes();
+			Ref<RandomNumberGenerator> copy = rng->duplicate_state();
+
+			uint32_t expected[64];
+			for (int i = 0; i < 64; i++) {
+				expected[i] = rng->randi();
+			}
+
+			Ref<RandomNumberGenerator> restored;
+			restored.instance();
+			restored->set_algo((algo + 1) % RandomNumberGenerator::ALGORITHM_MAX);
+			restored->set_state_bytes(snapshot);
+			rng->set_state_bytes(snapshot);
+			for (int i = 0; i < 64; i++) {
+				if (rng->randi() != expected[i] || restored->randi() != expected[i] || copy->randi() != expected[i]) {
+					OS::get_singleton()->print("FAILED: %s (cycling %d) diverges after restoring its state, at value %d.\n", algorithm_names[algo], cycling, i);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+// Cycling advances every backend together and XORs their outputs, for single draws and fills alike.
+static bool test_cycling() {
+	const uint64_t seed = 0xC1C1E;
+	Ref<RandomNumberGenerator> cycled;
+	cycled.instance();
+	cycled->set_seed(seed);
+	cycled->set_algo(RandomNumberGenerator::SPLITMIX64);
+	cycled->set_cycling_steps(2);
+	cycled->set_cycling(true);
+	Ref<RandomNumberGenerator> plain[RandomNumberGenerator::ALGORITHM_MAX];
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		plain[algo].instance();
+		plain[algo]->set_seed(seed);
+		plain[algo]->set_algo(algo);
+	}
+
+	for (int i = 0; i < 100; i++) {
+		uint32_t expected = 0;
+		for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+			expected ^= plain[algo]->randi();
+		}
+		if (cycled->randi() != expected) {
+			OS::get_singleton()->print("FAILED: cycling randi() differs from the mixed backends at value %d.\n", i);
+			return false;
+		}
+	}
+
+	PoolIntArray values;
+	values.resize(1000);
+	cycled->fill_randi(values);
+	PoolIntArray expected;
+	expected.resize(values.size());
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		PoolIntArray part;
+		part.resize(values.size());
+		plain[algo]->fill_randi(part);
+		PoolIntArray::Read p = part.read();
+		PoolIntArray::Write w = expected.write();
+		for (int i = 0; i < values.size(); i++) {
+			w[i] = algo ? (w[i] ^ p[i]) : p[i];
+		}
+	}
+	PoolIntArray::Read r = values.read();
+	PoolIntArray::Read e = expected.read();
+	for (int i = 0; i < values.size(); i++) {
+		if (r[i] != e[i]) {
+			OS::get_singleton()->print("FAILED: cycling fill_randi() differs from the mixed backends at value %d.\n", i);
+			return false;
+		}
+	}
+	return true;
+}
+
+struct ThreadRandCheck {
+	uint32_t index = 0;
+	uint32_t values[4];
+};
+
+static void thread_rand_draw(void *p_userdata) {
+	ThreadRandCheck *check = static_cast<ThreadRandCheck *>(p_userdata);
+	check->index = Thread::get_caller_index();
+	for (int i = 0; i < 4; i++) {
+		check->values[i] = Math::rand();
+	}
+}
+
+// Worker threads get their own default generator: the global seed on the PCG stream selected by their index.
+static bool test_thread_local_rand() {
+	const bool was_enabled = Math::is_thread_local_rand();
+	Math::set_thread_local_rand(true);
+	Math::seed(42);
+
+	const int thread_count = 4;
+	Thread threads[thread_count];
+	ThreadRandCheck checks[thread_count];
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].start(thread_rand_draw, &checks[i]);
+	}
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].wait_to_finish();
+	}
+
+	RandomPCG main_rand(42);
+	const uint32_t main_value = main_rand.rand();
+	bool success = Math::rand() == main_value;
+	for (int i = 0; i < thread_count; i++) {
+		RandomPCG expected(42, checks[i].index);
+		for (int j = 0; j < 4; j++) {
+			success = success && checks[i].index != 0 && checks[i].values[j] == expected.rand();
+		}
+	}
+	if (!success) {
+		OS::get_singleton()->print("FAILED: thread-local Math::rand() does not follow the global seed and thread index.\n");
+	}
+
+	Math::set_thread_local_rand(was_enabled);
+	Math::randomize();
+	return success;
+}
+
+// Fills one chunk of the output from its own substream, the way pooled workers are meant to.
+struct StreamWork {
+	RandomNumberGenerator *parent = nullptr;
+	uint32_t *values = nullptr;
+	int chunk_size = 0;
+
+	void fill_chunk(uint32_t p_index, void *p_userdata) {
+		RandomNumberGenerator stream;
+		parent->make_stream(p_index, stream);
+		for (int i = 0; i < chunk_size; i++) {
+			values[p_index * chunk_size + i] = stream.randi();
+		}
+	}
+};
+
+static bool test_streams() {
+	const int chunks = 64;
+	const int chunk_size = 1000;
+	bool success = true;
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		RandomNumberGenerator rng;
+		rng.set_algo(algo);
+		rng.set_seed(1234);
+
+		Array streams = rng.split(8);
+		for (int i = 0; i < streams.size(); i++) {
+			Ref<RandomNumberGenerator> split = streams[i];
+			Ref<RandomNumberGenerator> spawned = rng.spawn_stream(i);
+			for (int j = 0; j < 100; j++) {
+				if (split->randi() != spawned->randi()) {
+					OS::get_singleton()->print("FAILED: %s split(8)[%d] differs from spawn_stream(%d).\n", algorithm_names[algo], i, i);
+					success = false;
+					break;
+				}
+			}
+		}
+
+		// Streams are off the jump() grid: neither the parent nor a stream reaches another stream
+		// with a single jump.
+		Ref<RandomNumberGenerator> jumped = rng.duplicate_state();
+		jumped->jump(1);
+		Ref<RandomNumberGenerator> first = rng.spawn_stream(0);
+		Ref<RandomNumberGenerator> next = rng.spawn_stream(1);
+		first->jump(1);
+		Ref<RandomNumberGenerator> stream = rng.spawn_stream(0);
+		bool same_as_jump = true;
+		bool same_as_next = true;
+		for (int j = 0; j < 4; j++) {
+			same_as_jump = stream->randi() == jumped->randi() && same_as_jump;
+			same_as_next = first->randi() == next->randi() && same_as_next;
+		}
+		if (same_as_jump || same_as_next) {
+			OS::get_singleton()->print("FAILED: %s streams sit on the jump() grid.\n", algorithm_names[algo]);
+			success = false;
+		}
+
+		// Backends materialized after the jump must land on the same substream.
+		RandomNumberGenerator late;
+		late.set_seed(1234);
+		late.jump(3);
+		late.set_algo(algo);
+		RandomNumberGenerator early;
+		early.set_algo(algo);
+		early.set_seed(1234);
+		early.jump(3);
+		if (late.randi() != early.randi()) {
+			OS::get_singleton()->print("FAILED: %s late backend missed earlier jumps.\n", algorithm_names[algo]);
+			success = false;
+		}
+
+		uint32_t *results[2];
+		const int thread_counts[2] = { 1, 4 };
+		for (int t = 0; t < 2; t++) {
+			results[t] = memnew_arr(uint32_t, chunks * chunk_size);
+			StreamWork work;
+			work.parent = &rng;
+			work.values = results[t];
+			work.chunk_size = chunk_size;
+			ThreadWorkPool pool;
+			pool.init(thread_counts[t]);
+			pool.do_work(chunks, &work, &StreamWork::fill_chunk, (void *)nullptr);
+			pool.finish();
+		}
+		if (memcmp(results[0], results[1], sizeof(uint32_t) * chunks * chunk_size) != 0) {
+			OS::get_singleton()->print("FAILED: %s streams depend on the worker count.\n", algorithm_names[algo]);
+			success = false;
+		}
+		memdelete_arr(results[0]);
+		memdelete_arr(results[1]);
+	}
+	return success;
+}
+
+// Streams sit off the 2^64 grid that bulk fill lanes use: no stream may replay a large parent fill.
+static bool test_stream_lanes() {
+	const int stream_count = 8;
+	const int draws = 256;
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		RandomNumberGenerator rng;
+		rng.set_algo(algo);
+		rng.set_seed(4321);
+
+		// 16384 values take 8192 words, so every lane contributes 1024 of them.
+		RandomNumberGenerator filled;
+		filled.set_algo(algo);
+		filled.set_seed(4321);
+		PoolIntArray values;
+		values.resize(16384);
+		filled.fill_randi(values);
+		Vector<uint32_t> sorted;
+		sorted.resize(values.size());
+		PoolIntArray::Read r = values.read();
+		for (int i = 0; i < values.size(); i++) {
+			sorted.write[i] = (uint32_t)r[i];
+		}
+		sorted.sort();
+
+		// A few chance matches are expected among 2^32 values, a replayed lane matches every draw.
+		int matches = 0;
+		Array streams = rng.split(stream_count);
+		for (int i = 0; i < stream_count; i++) {
+			Ref<RandomNumberGenerator> stream = streams[i];
+			for (int j = 0; j < draws; j++) {
+				const uint32_t value = stream->randi();
+				int low = 0;
+				int high = sorted.size();
+				while (low < high) {
+					const int mid = (low + high) / 2;
+					if (sorted[mid] < value) {
+						low = mid + 1;
+					} else {
+						high = mid;
+					}
+				}
+				matches += low < sorted.size() && sorted[low] == value;
+			}
+		}
+		if (matches > 2) {
+			OS::get_singleton()->print("FAILED: %s streams replay %d values of a parent fill.\n", algorithm_names[algo], matches);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Statistical quality checks on the raw 32-bit randi() output. They use fixed seeds, so results
+// are reproducible, and flag a generator when the p-value falls outside [QUALITY_ALPHA, 1 - QUALITY_ALPHA].
+// These catch gross defects only; use --rng-stream with PractRand or TestU01 for thorough testing.
+static const double QUALITY_ALPHA = 1e-4;
+
+// Upper tail of the standard normal distribution.
+static double normal_sf(double p_z) {
+	return 0.5 * erfc(p_z / Math_SQRT2);
+}
+
+// Upper tail of the chi-square distribution, Wilson-Hilferty approximation.
+static double chi_square_sf(double p_x, int p_dof) {
+	const double k = p_dof;
+	const double z = (pow(p_x / k, 1.0 / 3.0) - (1.0 - 2.0 / (9.0 * k))) / sqrt(2.0 / (9.0 * k));
+	return normal_sf(z);
+}
+
+static bool check_p_value(const char *p_algorithm, const char *p_test, double p_p_value) {
+	return test_report_check("quality", p_algorithm, p_test, p_p_value, p_p_value >= QUALITY_ALPHA && p_p_value <= 1.0 - QUALITY_ALPHA);
+}
+
+static double chi_square(const uint64_t *p_observed, const double *p_expected, int p_bins) {
+	double sum = 0;
+	for (int i = 0; i < p_bins; i++) {
+		const double d = p_observed[i] - p_expected[i];
+		sum += d * d / p_expected[i];
+	}
+	return sum;
+}
+
+// Equidistribution of the top byte over 256 bins.
+static double quality_chi_square(RandomNumberGenerator &p_rng) {
+	const int samples = 1 << 22;
+	uint64_t observed[256] = {};
+	double expected[256];
+	for (int i = 0; i < 256; i++) {
+		expected[i] = samples / 256.0;
+	}
+	for (int i = 0; i < samples; i++) {
+		observed[p_rng.randi() >> 24]++;
+	}
+	return chi_square_sf(chi_square(observed, expected, 256), 255);
+}
+
+// Knuth's gap test: lengths of runs between values falling in [0, 1/4).
+static double quality_gap(RandomNumberGenerator &p_rng) {
+	const int gaps = 200000;
+	const int max_gap = 24; // The last bin collects every gap >= max_gap.
+	const double p = 0.25;
+	uint64_t observed[max_gap + 1] = {};
+	double expected[max_gap + 1];
+	for (int r = 0; r < max_gap; r++) {
+		expected[r] = gaps * p * pow(1.0 - p, r);
+	}
+	expected[max_gap] = gaps * pow(1.0 - p, max_gap);
+
+	for (int g = 0; g < gaps; g++) {
+		int length = 0;
+		while (p_rng.randi() >= 0x40000000) {
+			length++;
+		}
+		observed[MIN(length, max_gap)]++;
+	}
+	return chi_square_sf(chi_square(observed, expected, max_gap + 1), max_gap);
+}
+
+// Marsaglia's birthday spacings: 512 birthdays in a year of 2^24 days. The number of repeated
+// spacings per round is Poisson with mean 512^3 / (4 * 2^24) = 2.
+static double quality_birthday_spacing(RandomNumberGenerator &p_rng) {
+	const int rounds = 4000;
+	const int birthdays = 512;
+	const double mean = 2.0 * rounds;
+	uint32_t days[birthdays];
+	uint32_t spacings[birthdays];
+	SortArray<uint32_t> sorter;
+	uint64_t repeats = 0;
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < birthdays; i++) {
+			days[i] = p_rng.randi() >> 8;
+		}
+		sorter.sort(days, birthdays);
+		spacings[0] = days[0];
+		for (int i = 1; i < birthdays; i++) {
+			spacings[i] = days[i] - days[i - 1];
+		}
+		sorter.sort(spacings, birthdays);
+		for (int i = 1; i < birthdays; i++) {
+			if (spacings[i] == spacings[i - 1]) {
+				repeats++;
+			}
+		}
+	}
+	return normal_sf((repeats - mean) / sqrt(mean));
+}
+
+// Lag-1 serial correlation of successive values as uniforms, Knuth's circular estimator.
+static double quality_serial_correlation(RandomNumberGenerator &p_rng) {
+	const int samples = 1 << 22;
+	const double first = p_rng.randi() * (1.0 / 4294967296.0);
+	double previous = first;
+	double sum = first;
+	double sum_squares = first * first;
+	double sum_products = 0;
+	for (int i = 1; i < samples; i++) {
+		const double u = p_rng.randi() * (1.0 / 4294967296.0);
+		sum += u;
+		sum_squares += u * u;
+		sum_products += previous * u;
+		previous = u;
+	}
+	sum_products += previous * first;
+	const double n = samples;
+	const double correlation = (n * sum_products - sum * sum) / (n * sum_squares - sum * sum);
+	// Under independence the estimate is approximately normal with standard deviation 1 / sqrt(n).
+	return normal_sf(correlation * sqrt(n));
+}
+
+static double normal_cdf(double p_x) {
+	return 0.5 * erfc(-p_x / Math_SQRT2);
+}
+
+// randfn() against the normal CDF, in bins of 0.25 over [-5, 5] plus both tails.
+static double quality_normal(RandomNumberGenerator &p_rng) {
+	const int samples = 1 << 21;
+	const int bins = 42;
+	uint64_t observed[bins] = {};
+	double expected[bins];
+	for (int b = 0; b < bins; b++) {
+		const double low = b == 0 ? -1e9 : -5.0 + (b - 1) * 0.25;
+		const double high = b == bins - 1 ? 1e9 : -5.0 + b * 0.25;
+		expected[b] = samples * (normal_cdf(high) - normal_cdf(low));
+	}
+	for (int i = 0; i < samples; i++) {
+		const int b = (int)Math::floor((p_rng.randfn() + 5.0) / 0.25) + 1;
+		observed[CLAMP(b, 0, bins - 1)]++;
+	}
+	return chi_square_sf(chi_square(observed, expected, bins), bins - 1);
+}
+
+// randexp() against the exponential CDF, in bins of 0.25 over [0, 10) plus the tail.
+static double quality_exponential(RandomNumberGenerator &p_rng) {
+	const int samples = 1 << 21;
+	const int bins = 41;
+	uint64_t observed[bins] = {};
+	double expected[bins];
+	for (int b = 0; b < bins; b++) {
+		expected[b] = samples * (exp(-b * 0.25) - (b == bins - 1 ? 0.0 : exp(-(b + 1) * 0.25)));
+	}
+	for (int i = 0; i < samples; i++) {
+		observed[MIN((int)(p_rng.randexp() / 0.25), bins - 1)]++;
+	}
+	return chi_square_sf(chi_square(observed, expected, bins), bins - 1);
+}
+
+static bool test_quality() {
+	bool success = true;
+	for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+		RandomNumberGenerator rng;
+		rng.set_algo(algo);
+		rng.set_seed(0x5EED0000 + algo);
+		const char *name = algorithm_names[algo];
+		success = check_p_value(name, "chi_square", quality_chi_square(rng)) && success;
+		success = check_p_value(name, "gap", quality_gap(rng)) && success;
+		success = check_p_value(name, "birthday_spacing", quality_birthday_spacing(rng)) && success;
+		success = check_p_value(name, "serial_correlation", quality_serial_correlation(rng)) && success;
+		success = check_p_value(name, "normal", quality_normal(rng)) && success;
+		success = check_p_value(name, "exponential", quality_exponential(rng)) && success;
+	}
+	return success;
+}
+
+// Alias table picks against the normalized weights; the zero weight must never come up.
+static double quality_weighted(const Ref<RandomNumberGenerator> &p_rng) {
+	const int samples = 1 << 20;
+	const real_t weights[] = { 1, 2, 3, 0, 4, 0.5, 9.5 };
+	const int bins = sizeof(weights) / sizeof(weights[0]);
+	PoolRealArray pool;
+	for (int b = 0; b < bins; b++) {
+		pool.push_back(weights[b]);
+	}
+	Ref<RandomDistribution> distribution;
+	distribution.instance();
+	distribution->set_weights(pool);
+
+	uint64_t observed[bins] = {};
+	double expected[bins];
+	for (int b = 0; b < bins; b++) {
+		expected[b] = samples * weights[b] / 20.0;
+	}
+	for (int i = 0; i < samples; i++) {
+		const int picked = distribution->sample(p_rng);
+		if (picked < 0 || picked >= bins || weights[picked] == 0) {
+			return 0.0;
+		}
+		observed[picked]++;
+	}
+	// Leave the impossible bin out of the statistic, it was checked above.
+	observed[3] = observed[bins - 1];
+	expected[3] = expected[bins - 1];
+	return chi_square_sf(chi_square(observed, expected, bins - 1), bins - 2);
+}
+
+// Sample mean against the expected mean (z-test), and the sample variance within 3%.
+static bool check_moments(const char *p_name, Ref<RandomDistribution> p_distribution, const Ref<RandomNumberGenerator> &p_rng, double p_mean, double p_variance) {
+	const int samples = 1 << 18;
+	double sum = 0;
+	double sum_squares = 0;
+	for (int i = 0; i < samples; i++) {
+		const double x = p_distribution->sample(p_rng);
+		sum += x;
+		sum_squares += x * x;
+	}
+	const double mean = sum / samples;
+	const double variance = sum_squares / samples - mean * mean;
+	const double z = (mean - p_mean) / sqrt(p_variance / samples);
+	bool success = check_p_value(p_name, "mean", 2.0 * normal_sf(Math::abs(z)));
+	success = test_report_check("quality", p_name, "variance", variance, Math::abs(variance / p_variance - 1.0) < 0.03) && success;
+	return success;
+}
+
+static bool test_distributions() {
+	Ref<RandomNumberGenerator> rng;
+	rng.instance();
+	rng->set_seed(0xD157);
+	bool success = check_p_value("pcg", "weighted", quality_weighted(rng));
+
+	Ref<RandomDistribution> distribution;
+	distribution.instance();
+	distribution->set_type(RandomDistribution::TYPE_POISSON);
+	distribution->set_mean(3.5); // Multiplication method.
+	success = check_moments("poisson_3.5", distribution, rng, 3.5, 3.5) && success;
+	distribution->set_mean(250.0); // Transformed rejection.
+	success = check_moments("poisson_250", distribution, rng, 250.0, 250.0) && success;
+
+	distribution->set_type(RandomDistribution::TYPE_BINOMIAL);
+	distribution->set_trials(20);
+	distribution->set_probability(0.8); // Inversion, mirrored.
+	success = check_moments("binomial_20", distribution, rng, 16.0, 3.2) && success;
+	distribution->set_trials(5000);
+	distribution->set_probability(0.3); // Beta splitting, then inversion.
+	success = check_moments("binomial_5000", distribution, rng, 1500.0, 1050.0) && success;
+
+	distribution->set_type(RandomDistribution::TYPE_EXPONENTIAL);
+	distribution->set_rate(4.0);
+	success = check_moments("exponential_4", distribution, rng, 0.25, 0.0625) && success;
+
+	distribution->set_type(RandomDistribution::TYPE_GAMMA);
+	distribution->set_scale(2.0);
+	distribution->set_shape(0.4); // Boosted from shape 1.4.
+	success = check_moments("gamma_0.4", distribution, rng, 0.8, 1.6) && success;
+	distribution->set_shape(7.5);
+	success = check_moments("gamma_7.5", distribution, rng, 15.0, 30.0) && success;
+	return success;
+}
+
+// Points must land on each face in proportion to its area, inside it, and respect the Poisson distance.
+static bool test_mesh_sampler() {
+	PoolVector<Face3> faces;
+	faces.push_back(Face3(Vector3(0, 0, 0), Vector3(1, 0, 0), Vector3(0, 1, 0))); // Area 0.5.
+	faces.push_back(Face3(Vector3(5, 0, 0), Vector3(5, 0, 0), Vector3(6, 1, 0))); // Degenerate.
+	faces.push_back(Face3(Vector3(0, 0, 2), Vector3(3, 0, 2), Vector3(0, 1, 2))); // Area 1.5.
+	Ref<MeshSampler> sampler;
+	sampler.instance();
+	if (!sampler->set_faces(faces)) {
+		return test_report_check("check", "pcg", "mesh_sampler", 0, false);
+	}
+
+	RandomNumberGenerator rng;
+	rng.set_seed(0xFACE);
+	const int samples = 1 << 18;
+	LocalVector<Vector3> points;
+	LocalVector<Vector3> barycentrics;
+	LocalVector<int> face_indices;
+	points.resize(samples);
+	barycentrics.resize(samples);
+	face_indices.resize(samples);
+	sampler->sample(samples, points.ptr(), nullptr, barycentrics.ptr(), face_indices.ptr(), 0, &rng);
+
+	bool inside = true;
+	uint64_t observed[2] = {};
+	for (int i = 0; i < samples; i++) {
+		const Vector3 &b = barycentrics[i];
+		const Face3 &face = faces[face_indices[i]];
+		const Vector3 expected = face.vertex[0] * b.x + face.vertex[1] * b.y + face.vertex[2] * b.z;
+		inside = inside && face_indices[i] != 1 && b.x >= 0 && b.y >= 0 && b.z >= 0 && Math::is_equal_approx(b.x + b.y + b.z, (real_t)1.0) && points[i].is_equal_approx(expected);
+		observed[face_indices[i] == 0 ? 0 : 1]++;
+	}
+	const double expected[2] = { samples * 0.25, samples * 0.75 };
+	bool success = test_report_check("check", "pcg", "mesh_sampler_inside", 0, inside);
+	success = check_p_value("pcg", "mesh_sampler_area", chi_square_sf(chi_square(observed, expected, 2), 1)) && success;
+
+	const real_t min_distance = 0.05;
+	const int written = sampler->sample(2000, points.ptr(), nullptr, nullptr, nullptr, min_distance, &rng);
+	bool spaced = written > 100;
+	for (int i = 0; i < written && spaced; i++) {
+		for (int j = i + 1; j < written; j++) {
+			if (points[i].distance_to(points[j]) < min_distance) {
+				spaced = false;
+				break;
+			}
+		}
+	}
+	success = test_report_check("check", "pcg", "mesh_sampler_poisson", written, spaced) && success;
+	return success;
+}
+
+// Every permutation of a short Array must be equally likely, and samples must hold distinct
+// elements, each picked equally often, on both the reservoir and the partial shuffle paths.
+static bool test_shuffle_sample() {
+	Ref<RandomNumberGenerator> rng;
+	rng.instance();
+	rng->set_seed(0xDEC4);
+
+	const int trials = 240000;
+	uint64_t permutations[256] = {};
+	double expected[256];
+	for (int i = 0; i < 24; i++) {
+		expected[i] = trials / 24.0;
+	}
+	for (int t = 0; t < trials; t++) {
+		Array deck;
+		for (int i = 0; i < 4; i++) {
+			deck.push_back(i);
+		}
+		deck.shuffle(rng.ptr());
+		// Lehmer code of the permutation, in [0, 24).
+		int code = 0;
+		for (int i = 0; i < 4; i++) {
+			int smaller = 0;
+			for (int j = i + 1; j < 4; j++) {
+				smaller += (int)deck[j] < (int)deck[i];
+			}
+			code = code * (4 - i) + smaller;
+		}
+		permutations[code]++;
+	}
+	bool success = check_p_value("pcg", "shuffle_permutations", chi_square_sf(chi_square(permutations, expected, 24), 23));
+
+	PoolIntArray source;
+	for (int i = 0; i < 20; i++) {
+		source.push_back(i);
+	}
+	const int counts[2] = { 3, 12 }; // Reservoir and partial shuffle paths.
+	for (int c = 0; c < 2; c++) {
+		uint64_t observed[20] = {};
+		bool distinct = true;
+		for (int t = 0; t < trials / counts[c]; t++) {
+			RandomSourceRNG random_source = { rng.ptr() };
+			const PoolIntArray picked = random_sample(source, counts[c], random_source);
+			distinct = distinct && picked.size() == counts[c];
+			uint32_t seen = 0;
+			for (int i = 0; i < picked.size(); i++) {
+				distinct = distinct && !(seen & (1 << picked[i]));
+				seen |= 1 << picked[i];
+				observed[picked[i]]++;
+			}
+		}
+		for (int i = 0; i < 20; i++) {
+			expected[i] = (trials / counts[c]) * counts[c] / 20.0;
+		}
+		success = test_report_check("check", "pcg", c == 0 ? "sample_reservoir_distinct" : "sample_partial_distinct", 0, distinct) && success;
+		success = check_p_value("pcg", c == 0 ? "sample_reservoir" : "sample_partial", chi_square_sf(chi_square(observed, expected, 20), 19)) && success;
+	}
+
+	// Equal seeds give equal shuffles.
+	Array a = Variant(source);
+	Array b = a.duplicate();
+	rng->set_seed(7);
+	a.shuffle(rng.ptr());
+	rng->set_seed(7);
+	b.shuffle(rng.ptr());
+	success = test_report_check("check", "pcg", "shuffle_determinism", 0, a.deep_equal(b)) && success;
+	return success;
+}
+
+#ifdef DEBUG_ENABLED
+// Frame totals must add up the generator and global draws, and scoped draws must be charged to their site.
+static bool test_random_profiler() {
+	const bool was_active = RandomProfiler::is_active();
+	RandomProfiler::set_active(true);
+	RandomProfiler::end_frame(); // Baseline for generators registered earlier.
+
+	RandomNumberGenerator rng;
+	for (int i = 0; i < 100; i++) {
+		rng.randi();
+	}
+	PoolIntArray values;
+	values.resize(50);
+	rng.fill_randi(values);
+	rng.set_seed(3);
+	rng.set_algo(RandomNumberGenerator::PHILOX);
+	{
+		RANDOM_PROFILE_SCOPE("test_random_profiler");
+		for (int i = 0; i < 10; i++) {
+			Math::rand();
+		}
+	}
+	RandomProfiler::end_frame();
+
+	const Array report = RandomProfiler::get_frame_report();
+	bool site_found = false;
+	for (int i = 0; i < report.size(); i += 2) {
+		site_found = site_found || (String(report[i]).find("test_random_profiler") != -1 && (int)report[i + 1] == 10);
+	}
+	bool success = test_report_check("check", "all", "profiler_draws", RandomProfiler::get_frame_total(RandomProfiler::EVENT_DRAW), RandomProfiler::get_frame_total(RandomProfiler::EVENT_DRAW) == 160);
+	success = test_report_check("check", "all", "profiler_reseeds", RandomProfiler::get_frame_total(RandomProfiler::EVENT_RESEED), RandomProfiler::get_frame_total(RandomProfiler::EVENT_RESEED) == 1) && success;
+	success = test_report_check("check", "all", "profiler_switches", RandomProfiler::get_frame_total(RandomProfiler::EVENT_ALGORITHM_SWITCH), RandomProfiler::get_frame_total(RandomProfiler::EVENT_ALGORITHM_SWITCH) == 1) && success;
+	success = test_report_check("check", "all", "profiler_site", 0, site_found) && success;
+
+	RandomProfiler::set_active(was_active);
+	return success;
+}
+#endif
+
+// Writes raw little-endian randi() output to stdout until p_bytes have been written (forever if 0),
+// for piping into external test batteries, e.g.:
+//   godot --quiet --test rng --rng-stream xoroshiro128 | RNG_test stdin32
+static void stream_output(int p_algo, uint64_t p_seed, uint64_t p_bytes) {
+	RandomNumberGenerator rng;
+	rng.set_algo(p_algo);
+	rng.set_seed(p_seed);
+
+	const int block = 16384;
+	uint8_t buffer[block * 4];
+	uint64_t written = 0;
+	while (p_bytes == 0 || written < p_bytes) {
+		for (int i = 0; i < block; i++) {
+			const uint32_t value = rng.randi();
+			buffer[i * 4 + 0] = value & 0xFF;
+			buffer[i * 4 + 1] = (value >> 8) & 0xFF;
+			buffer[i * 4 + 2] = (value >> 16) & 0xFF;
+			buffer[i * 4 + 3] = value >> 24;
+		}
+		size_t size = sizeof(buffer);
+		if (p_bytes != 0) {
+			size = MIN(size, p_bytes - written);
+		}
+		if (fwrite(buffer, 1, size, stdout) != size) {
+			break; // The reading end closed the pipe.
+		}
+		written += size;
+	}
+	fflush(stdout);
+}
+
+// Options, read from the command line after --test rng:
+//   --rng-stream <algorithm>   stream raw output to stdout instead of running the suite
+//   --rng-seed <seed>          seed for --rng-stream (default 0)
+//   --rng-bytes <count>        stop streaming after this many bytes (default: never)
+//   --rng-skip-bench           run the checks only
+MainLoop *test() {
+	List<String> args = OS::get_singleton()->get_cmdline_args();
+	String stream_algorithm;
+	uint64_t stream_seed = 0;
+	uint64_t stream_bytes = 0;
+	bool skip_bench = false;
+	for (List<String>::Element *E = args.front(); E; E = E->next()) {
+		if (E->get() == "--rng-skip-bench") {
+			skip_bench = true;
+		} else if (E->next()) {
+			if (E->get() == "--rng-stream") {
+				stream_algorithm = E->next()->get();
+			} else if (E->get() == "--rng-seed") {
+				stream_seed = E->next()->get().to_int64();
+			} else if (E->get() == "--rng-bytes") {
+				stream_bytes = E->next()->get().to_int64();
+			}
+		}
+	}
+
+	if (stream_algorithm != "") {
+		for (int algo = 0; algo < RandomNumberGenerator::ALGORITHM_MAX; algo++) {
+			if (stream_algorithm == algorithm_names[algo]) {
+				stream_output(algo, stream_seed, stream_bytes);
+				return nullptr;
+			}
+		}
+		OS::get_singleton()->printerr("Unknown RNG algorithm: %s\n", stream_algorithm.utf8().get_data());
+		return nullptr;
+	}
+
+	OS::get_singleton()->print("Start RNG checks.\n");
+
+	bool success = test_report_check("check", "all", "determinism", 0, test_determinism());
+	success = test_report_check("check", "all", "fill_ranges", 0, test_fill_ranges()) && success;
+	success = test_report_check("check", "all", "fill_conversion", 0, test_fill_conversion()) && success;
+	success = test_report_check("check", "all", "double_precision", 0, test_double_precision()) && success;
+	success = test_report_check("check", "pcg", "randi_range_bias", 0, test_randi_range_bias()) && success;
+	success = test_report_check("check", "all", "streams", 0, test_streams()) && success;
+	success = test_report_check("check", "all", "stream_lanes", 0, test_stream_lanes()) && success;
+	success = test_report_check("check", "philox", "counter_access", 0, test_counter_access()) && success;
+	success = test_report_check("check", "all", "state_bytes", 0, test_state_bytes()) && success;
+	success = test_report_check("check", "all", "cycling", 0, test_cycling()) && success;
+	success = test_report_check("check", "pcg", "thread_local_rand", 0, test_thread_local_rand()) && success;
+	success = test_report_check("check", "xoroshiro128", "lanes", 0, test_lanes<Xoroshiro128>("xoroshiro128")) && success;
+	success = test_report_check("check", "xorshift128", "lanes", 0, test_lanes<Xorshift128>("xorshift128")) && success;
+	success = test_quality() && success;
+	success = test_distributions() && success;
+	success = test_mesh_sampler() && success;
+	success = test_shuffle_sample() && success;
+#ifdef DEBUG_ENABLED
+	success = test_random_profiler() && success;
+#endif
+
+	if (!skip_bench) {
+		OS::get_singleton()->print("Throughput in ns per value, %d values each:\n", BENCH_ITERATIONS);
+		bench_throughput();
+		bench_lifecycle();
+		bench_mesh_sampler();
+		bench_randi_range();
+		bench_lanes<Xoroshiro128>("xoroshiro128");
+		bench_lanes<Xorshift128>("xorshift128");
+	}
+
+	if (success) {
+		OS::get_singleton()->print("RNG checks passed.\n");
+	} else {
+		OS::get_singleton()->print("RNG checks FAILED.\n");
+	}
+
+	return nullptr;
+}
+
+} // namespace TestRNG
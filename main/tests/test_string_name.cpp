@@ -0,0 +1,171 @@
+/**************************************************************************/
+/*  test_string_name.cpp                                                  */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "test_string_name.h"
+
+#include "core/local_vector.h"
+#include "core/os/os.h"
+#include "core/string_name.h"
+#include "main/tests/test_tools.h"
+
+namespace TestStringName {
+
+enum {
+	MAX_THREADS = 8,
+	NAME_COUNT = 1024,
+	CHECK_ROUNDS = 16,
+	BENCH_OPS = 200000,
+};
+
+static const TestReporter reporter("string_name");
+
+struct Stress {
+	LocalVector<String> names;
+	// Names that must stay interned during the run, so lookups hit existing entries.
+	LocalVector<StringName> held;
+	const void *pointers[MAX_THREADS][NAME_COUNT];
+	bool churn = false;
+
+	// Every thread interns the same names, alternating between the String and C string paths.
+	static void intern(void *p_self, uint32_t p_index) {
+		Stress *s = (Stress *)p_self;
+		for (uint32_t round = 0; round < CHECK_ROUNDS; round++) {
+			for (uint32_t i = 0; i < NAME_COUNT; i++) {
+				uint32_t n = (i + p_index * 37) % NAME_COUNT;
+				StringName name = (round + i) & 1 ? StringName(s->names[n]) : StringName(s->names[n].ascii().get_data());
+				// Entries only stay the same while someone holds a reference, which is checked afterwards.
+				const void *pointer = name.data_unique_pointer();
+				if (round == 0) {
+					s->pointers[p_index][n] = pointer;
+				} else if (s->pointers[p_index][n] != pointer) {
+					s->pointers[p_index][n] = nullptr;
+				}
+			}
+		}
+	}
+
+	// Lookups of existing names, or short lived names whose entries keep being added and removed.
+	static void bench(void *p_self, uint32_t p_index) {
+		Stress *s = (Stress *)p_self;
+		uint32_t n = p_index * 101;
+		for (uint32_t i = 0; i < BENCH_OPS; i++) {
+			n = (n + 7) % NAME_COUNT;
+			if (s->churn) {
+				StringName name(s->names[n]);
+				StringName copy = name;
+			} else {
+				StringName name(s->names[n]);
+			}
+		}
+	}
+
+	void hold() {
+		for (uint32_t i = 0; i < NAME_COUNT; i++) {
+			held.push_back(StringName(names[i]));
+		}
+	}
+
+	bool all_released() const {
+		for (uint32_t i = 0; i < NAME_COUNT; i++) {
+			if (StringName::search(names[i]) != StringName()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	Stress() {
+		for (uint32_t i = 0; i < NAME_COUNT; i++) {
+			names.push_back("string_name_stress_" + itos(i));
+		}
+	}
+};
+
+static bool test_concurrent_intern() {
+	Stress s;
+	s.hold();
+	test_run_threads(MAX_THREADS, &Stress::intern, &s);
+
+	for (uint32_t t = 0; t < MAX_THREADS; t++) {
+		for (uint32_t i = 0; i < NAME_COUNT; i++) {
+			if (s.pointers[t][i] != s.held[i].data_unique_pointer()) {
+				OS::get_singleton()->print("FAILED: thread %d got a different entry for '%ls'.\n", t, s.names[i].c_str());
+				return false;
+			}
+		}
+	}
+
+	s.held.clear();
+	return s.all_released();
+}
+
+static bool test_concurrent_release() {
+	// Nothing holds the names, so entries are constantly removed while other threads look them up.
+	Stress s;
+	test_run_threads(MAX_THREADS, &Stress::intern, &s);
+	return s.all_released();
+}
+
+static void bench() {
+	Stress s;
+	double single = 0;
+	for (uint32_t threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		s.churn = false;
+		s.hold();
+		uint64_t usec = test_run_threads(threads, &Stress::bench, &s);
+		s.held.clear();
+		double mops = threads * (double)BENCH_OPS / usec;
+		if (threads == 1) {
+			single = mops;
+		}
+		reporter.bench("lookup_mops_" + itos(threads) + "t", mops);
+		reporter.bench("lookup_scaling_" + itos(threads) + "t", mops / single);
+
+		s.churn = true;
+		usec = test_run_threads(threads, &Stress::bench, &s);
+		reporter.bench("churn_mops_" + itos(threads) + "t", threads * (double)BENCH_OPS / usec);
+	}
+}
+
+MainLoop *test() {
+	bool success = reporter.check("concurrent_intern", test_concurrent_intern());
+	success = reporter.check("concurrent_release", test_concurrent_release()) && success;
+
+	bench();
+
+	if (success) {
+		OS::get_singleton()->print("StringName checks passed.\n");
+	} else {
+		OS::get_singleton()->print("StringName checks FAILED.\n");
+	}
+	return nullptr;
+}
+
+} // namespace TestStringName
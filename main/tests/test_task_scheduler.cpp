@@ -0,0 +1,368 @@
+/**************************************************************************/
+/*  test_task_scheduler.cpp                                               */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "test_task_scheduler.h"
+
+#include "core/os/os.h"
+#include "core/os/semaphore.h"
+#include "core/os/task_scheduler.h"
+#include "core/os/thread.h"
+#include "core/os/thread_work_pool.h"
+#include "main/tests/test_tools.h"
+
+namespace TestTaskScheduler {
+
+static const TestReporter reporter("scheduler");
+
+// The previous ThreadWorkPool, kept as the benchmark baseline: one job at a time, one index per
+// fetch_add, and an allocation per dispatch.
+class LegacyWorkPool {
+	struct BaseWork {
+		std::atomic<uint32_t> *index = nullptr;
+		uint32_t max_elements = 0;
+		virtual void work() = 0;
+		virtual ~BaseWork() = default;
+	};
+
+	template <class C, class M, class U>
+	struct Work : public BaseWork {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void work() override {
+			while (true) {
+				uint32_t work_index = index->fetch_add(1, std::memory_order_relaxed);
+				if (work_index >= max_elements) {
+					break;
+				}
+				(instance->*method)(work_index, userdata);
+			}
+		}
+	};
+
+	struct ThreadData {
+		Thread thread;
+		Semaphore start;
+		Semaphore completed;
+		std::atomic<bool> exit;
+		BaseWork *work = nullptr;
+	};
+
+	std::atomic<uint32_t> index;
+	ThreadData *threads = nullptr;
+	uint32_t thread_count = 0;
+
+	static void _thread_function(void *p_user) {
+		ThreadData *thread = static_cast<ThreadData *>(p_user);
+		while (true) {
+			thread->start.wait();
+			if (thread->exit.load()) {
+				break;
+			}
+			thread->work->work();
+			thread->completed.post();
+		}
+	}
+
+public:
+	template <class C, class M, class U>
+	void do_work(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
+		index.store(0, std::memory_order_release);
+		Work<C, M, U> *w = memnew((Work<C, M, U>));
+		w->instance = p_instance;
+		w->userdata = p_userdata;
+		w->method = p_method;
+		w->index = &index;
+		w->max_elements = p_elements;
+		const uint32_t threads_working = MIN(p_elements, thread_count);
+		for (uint32_t i = 0; i < threads_working; i++) {
+			threads[i].work = w;
+			threads[i].start.post();
+		}
+		for (uint32_t i = 0; i < threads_working; i++) {
+			threads[i].completed.wait();
+		}
+		memdelete(w);
+	}
+
+	void init(int p_thread_count) {
+		thread_count = p_thread_count;
+		threads = memnew_arr(ThreadData, thread_count);
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].exit.store(false);
+			threads[i].thread.start(&LegacyWorkPool::_thread_function, &threads[i]);
+		}
+	}
+
+	void finish() {
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].exit.store(true);
+			threads[i].start.post();
+		}
+		for (uint32_t i = 0; i < thread_count; i++) {
+			threads[i].thread.wait_to_finish();
+		}
+		memdelete_arr(threads);
+	}
+};
+
+static const uint32_t SMALL_JOBS = 20000;
+static const uint32_t SMALL_JOB_ELEMENTS = 64;
+static const uint32_t NESTED_OUTER = 64;
+static const uint32_t NESTED_INNER = 4096;
+static const uint32_t WAKE_CLIENTS = 4;
+static const uint32_t WAKE_ROUNDS = 5000;
+static const uint64_t WAKE_TIMEOUT_USEC = 30000000;
+
+struct Work {
+	TaskScheduler *scheduler = nullptr;
+	uint64_t *values = nullptr;
+	std::atomic<uint64_t> total;
+
+	Work() { total.store(0); }
+
+	// A few hundred cycles, so per-element dispatch cost stays visible.
+	_FORCE_INLINE_ uint64_t element(uint32_t p_index) const {
+		uint64_t x = p_index + 1;
+		for (int i = 0; i < 16; i++) {
+			x ^= x << 13;
+			x ^= x >> 7;
+			x ^= x << 17;
+		}
+		return x;
+	}
+
+	void small(uint32_t p_index, void *p_userdata) {
+		values[p_index] = element(p_index);
+	}
+
+	static void inner_range(void *p_self, uint32_t p_from, uint32_t p_to) {
+		Work *self = static_cast<Work *>(p_self);
+		uint64_t sum = 0;
+		for (uint32_t i = p_from; i < p_to; i++) {
+			sum += self->element(i);
+		}
+		self->total += sum;
+	}
+
+	// Outer jobs starting and waiting on inner ones, which only the scheduler can overlap.
+	void nested(uint32_t p_index, void *p_userdata) {
+		TaskScheduler::GroupID inner = scheduler->add_range(&Work::inner_range, this, NESTED_INNER);
+		scheduler->wait(inner);
+	}
+
+	void nested_serial(uint32_t p_index, void *p_userdata) {
+		inner_range(this, 0, NESTED_INNER);
+	}
+};
+
+struct Stages {
+	std::atomic<uint32_t> first;
+	std::atomic<uint32_t> early;
+
+	Stages() {
+		first.store(0);
+		early.store(0);
+	}
+
+	static void run_first(void *p_self, uint32_t p_from, uint32_t p_to) {
+		static_cast<Stages *>(p_self)->first += p_to - p_from;
+	}
+	// Must only see a completed first stage.
+	static void run_second(void *p_self, uint32_t p_from, uint32_t p_to) {
+		Stages *self = static_cast<Stages *>(p_self);
+		if (self->first.load() != 1000) {
+			self->early += p_to - p_from;
+		}
+	}
+};
+
+// Client threads submit tiny groups and wait on them, pausing now and then so the workers fall
+// asleep. Every wait() depends on a worker's completion waking it: a lost wakeup leaves a client
+// stuck, which the watchdog reports before waking everyone to let the test finish.
+struct WakeStress {
+	TaskScheduler *scheduler = nullptr;
+	std::atomic<uint32_t> finished;
+	std::atomic<uint64_t> processed;
+
+	WakeStress() {
+		finished.store(0);
+		processed.store(0);
+	}
+
+	static void count_range(void *p_self, uint32_t p_from, uint32_t p_to) {
+		static_cast<WakeStress *>(p_self)->processed += p_to - p_from;
+	}
+
+	static void client(void *p_self) {
+		WakeStress *self = static_cast<WakeStress *>(p_self);
+		for (uint32_t i = 0; i < WAKE_ROUNDS; i++) {
+			self->scheduler->wait(self->scheduler->add_range(&WakeStress::count_range, self, 1 + i % 4, 1));
+			if (i % 64 == 0) {
+				OS::get_singleton()->delay_usec(200);
+			}
+		}
+		self->finished++;
+	}
+};
+
+static bool test_wakeups(TaskScheduler &p_scheduler) {
+	WakeStress stress;
+	stress.scheduler = &p_scheduler;
+	Thread clients[WAKE_CLIENTS];
+	for (uint32_t i = 0; i < WAKE_CLIENTS; i++) {
+		clients[i].start(&WakeStress::client, &stress);
+	}
+
+	bool timed_out = false;
+	const uint64_t from = OS::get_singleton()->get_ticks_usec();
+	while (stress.finished.load() < WAKE_CLIENTS) {
+		if (!timed_out && OS::get_singleton()->get_ticks_usec() - from > WAKE_TIMEOUT_USEC) {
+			OS::get_singleton()->print("FAILED: a client is still waiting after %d seconds.\n", (int)(WAKE_TIMEOUT_USEC / 1000000));
+			timed_out = true;
+		}
+		if (timed_out) {
+			// Completing a group wakes every sleeper.
+			p_scheduler.wait(p_scheduler.add_range(&WakeStress::count_range, &stress, 0));
+		}
+		OS::get_singleton()->delay_usec(10000);
+	}
+	for (uint32_t i = 0; i < WAKE_CLIENTS; i++) {
+		clients[i].wait_to_finish();
+	}
+
+	uint64_t expected = 0;
+	for (uint32_t i = 0; i < WAKE_ROUNDS; i++) {
+		expected += 1 + i % 4;
+	}
+	return !timed_out && stress.processed.load() == expected * WAKE_CLIENTS;
+}
+
+static bool test_ranges(TaskScheduler &p_scheduler) {
+	uint64_t values[1000];
+	Work work;
+	work.values = values;
+	for (uint32_t grain = 0; grain < 40; grain += 13) {
+		memset(values, 0, sizeof(values));
+		TaskScheduler::GroupID group = p_scheduler.add_method(&work, &Work::small, (void *)nullptr, 1000, grain);
+		p_scheduler.wait(group);
+		for (uint32_t i = 0; i < 1000; i++) {
+			if (values[i] != work.element(i)) {
+				OS::get_singleton()->print("FAILED: element %d not processed with grain %d.\n", i, grain);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static bool test_dependencies(TaskScheduler &p_scheduler) {
+	for (int i = 0; i < 100; i++) {
+		Stages stages;
+		TaskScheduler::GroupID first = p_scheduler.add_range(&Stages::run_first, &stages, 1000, 1);
+		TaskScheduler::GroupID second = p_scheduler.add_range(&Stages::run_second, &stages, 1000, 1, &first, 1);
+		TaskScheduler::GroupID last = p_scheduler.add_range(&Stages::run_second, &stages, 0, 0, &second, 1);
+		p_scheduler.release(first);
+		p_scheduler.release(second);
+		p_scheduler.wait(last);
+		if (stages.early.load() || stages.first.load() != 1000) {
+			OS::get_singleton()->print("FAILED: dependent group started before its dependency completed.\n");
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool test_nested(TaskScheduler &p_scheduler) {
+	Work work;
+	work.scheduler = &p_scheduler;
+	TaskScheduler::GroupID group = p_scheduler.add_method(&work, &Work::nested, (void *)nullptr, NESTED_OUTER, 1);
+	p_scheduler.wait(group);
+
+	Work serial;
+	for (uint32_t i = 0; i < NESTED_OUTER; i++) {
+		serial.nested_serial(i, nullptr);
+	}
+	return work.total.load() == serial.total.load();
+}
+
+static void bench(TaskScheduler &p_scheduler) {
+	LocalVector<uint64_t> values;
+	values.resize(SMALL_JOB_ELEMENTS);
+	Work work;
+	work.scheduler = &p_scheduler;
+	work.values = values.ptr();
+
+	LegacyWorkPool legacy;
+	legacy.init(p_scheduler.get_thread_count() + 1);
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < SMALL_JOBS; i++) {
+		legacy.do_work(SMALL_JOB_ELEMENTS, &work, &Work::small, (void *)nullptr);
+	}
+	reporter.bench("legacy_small_jobs_us", (OS::get_singleton()->get_ticks_usec() - from) / (double)SMALL_JOBS);
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < SMALL_JOBS; i++) {
+		p_scheduler.wait(p_scheduler.add_method(&work, &Work::small, (void *)nullptr, SMALL_JOB_ELEMENTS));
+	}
+	reporter.bench("small_jobs_us", (OS::get_singleton()->get_ticks_usec() - from) / (double)SMALL_JOBS);
+
+	// The legacy pool can't start jobs from its own jobs, so inner loops run serially there.
+	from = OS::get_singleton()->get_ticks_usec();
+	legacy.do_work(NESTED_OUTER, &work, &Work::nested_serial, (void *)nullptr);
+	reporter.bench("legacy_nested_ms", (OS::get_singleton()->get_ticks_usec() - from) / 1000.0);
+	legacy.finish();
+
+	from = OS::get_singleton()->get_ticks_usec();
+	p_scheduler.wait(p_scheduler.add_method(&work, &Work::nested, (void *)nullptr, NESTED_OUTER, 1));
+	reporter.bench("nested_ms", (OS::get_singleton()->get_ticks_usec() - from) / 1000.0);
+}
+
+MainLoop *test() {
+	TaskScheduler *scheduler = TaskScheduler::get_singleton();
+	ERR_FAIL_NULL_V(scheduler, nullptr);
+	OS::get_singleton()->print("Task scheduler with %d worker threads.\n", scheduler->get_thread_count());
+
+	bool success = reporter.check("ranges", test_ranges(*scheduler));
+	success = reporter.check("dependencies", test_dependencies(*scheduler)) && success;
+	success = reporter.check("nested", test_nested(*scheduler)) && success;
+	success = reporter.check("wakeups", test_wakeups(*scheduler)) && success;
+
+	bench(*scheduler);
+
+	if (success) {
+		OS::get_singleton()->print("Task scheduler checks passed.\n");
+	} else {
+		OS::get_singleton()->print("Task scheduler checks FAILED.\n");
+	}
+	return nullptr;
+}
+
+} // namespace TestTaskScheduler
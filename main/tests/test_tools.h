@@ -32,6 +32,10 @@
 #define TEST_TOOLS_H
 
 #include "core/error_macros.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
 
 struct ErrorDetector {
 	ErrorDetector() {
@@ -58,4 +62,92 @@ struct ErrorDetector {
 	bool has_error = false;
 };
 
+// Every measurement and check is reported on its own line as
+//   RESULT <section> <suite> <metric> <value> [PASS|FAIL]
+// so CI can diff runs. Human-oriented messages never start with RESULT.
+inline void test_report(const char *p_section, const char *p_suite, const char *p_metric, double p_value) {
+	OS::get_singleton()->print("RESULT %s %s %s %.4f\n", p_section, p_suite, p_metric, p_value);
+}
+
+inline bool test_report_check(const char *p_section, const char *p_suite, const char *p_metric, double p_value, bool p_pass) {
+	OS::get_singleton()->print("RESULT %s %s %s %.6f %s\n", p_section, p_suite, p_metric, p_value, p_pass ? "PASS" : "FAIL");
+	return p_pass;
+}
+
+// Reports for a suite with a single subject, e.g. TestReporter("pool_vector").bench(...).
+struct TestReporter {
+	const char *suite;
+
+	void bench(const char *p_metric, double p_value) const {
+		test_report("bench", suite, p_metric, p_value);
+	}
+	void bench(const String &p_metric, double p_value) const {
+		test_report("bench", suite, p_metric.utf8().get_data(), p_value);
+	}
+	bool check(const char *p_metric, bool p_pass) const {
+		return test_report_check("check", suite, p_metric, 0, p_pass);
+	}
+
+	explicit TestReporter(const char *p_suite) :
+			suite(p_suite) {}
+};
+
+typedef void (*TestThreadFunction)(void *p_userdata, uint32_t p_index);
+
+// Runs p_function on p_count threads, each with its index, and releases them together once all
+// have started. Returns the usec from the release until the last one finished. Threads block
+// on semaphores until released, so waiting ones don't compete with the code being measured.
+inline uint64_t test_run_threads(uint32_t p_count, TestThreadFunction p_function, void *p_userdata) {
+#ifdef NO_THREADS
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < p_count; i++) {
+		p_function(p_userdata, i);
+	}
+	return OS::get_singleton()->get_ticks_usec() - from;
+#else
+	struct Start {
+		TestThreadFunction function = nullptr;
+		void *userdata = nullptr;
+		Semaphore ready;
+		Semaphore go;
+	};
+	struct ThreadData {
+		Start *start = nullptr;
+		uint32_t index = 0;
+
+		static void run(void *p_data) {
+			ThreadData *td = (ThreadData *)p_data;
+			td->start->ready.post();
+			td->start->go.wait();
+			td->start->function(td->start->userdata, td->index);
+		}
+	};
+
+	Start start;
+	start.function = p_function;
+	start.userdata = p_userdata;
+	Thread *threads = memnew_arr(Thread, p_count);
+	ThreadData *data = memnew_arr(ThreadData, p_count);
+	for (uint32_t i = 0; i < p_count; i++) {
+		data[i].start = &start;
+		data[i].index = i;
+		threads[i].start(&ThreadData::run, &data[i]);
+	}
+	for (uint32_t i = 0; i < p_count; i++) {
+		start.ready.wait();
+	}
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (uint32_t i = 0; i < p_count; i++) {
+		start.go.post();
+	}
+	for (uint32_t i = 0; i < p_count; i++) {
+		threads[i].wait_to_finish();
+	}
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+	memdelete_arr(threads);
+	memdelete_arr(data);
+	return usec;
+#endif
+}
+
 #endif // TEST_TOOLS_H
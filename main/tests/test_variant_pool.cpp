@@ -0,0 +1,186 @@
+/**************************************************************************/
+/*  test_variant_pool.cpp                                                 */
+/**************************************************************************/
+/*                         This file is part of:                          */
+/*                             GODOT ENGINE                               */
+/*                        https://godotengine.org                         */
+/**************************************************************************/
+/* Copyright (c) 2014-present Godot Engine contributors (see AUTHORS.md). */
+/* Copyright (c) 2007-2014 Juan Linietsky, Ariel Manzur.                  */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "test_variant_pool.h"
+
+#include "core/array.h"
+#include "core/os/os.h"
+#include "core/safe_refcount.h"
+#include "core/variant.h"
+#include "core/variant_pool.h"
+#include "main/tests/test_tools.h"
+
+#include "modules/modules_enabled.gen.h" // For gdscript.
+#ifdef MODULE_GDSCRIPT_ENABLED
+#include "modules/gdscript/gdscript.h"
+#endif
+
+namespace TestVariantPool {
+
+enum {
+	THREADS = 4,
+	THREAD_VARIANTS = 4096,
+	THREAD_ROUNDS = 32,
+	BENCH_OPS = 1000000,
+	SCRIPT_ITERATIONS = 100000,
+};
+
+static const TestReporter reporter("variant_pool");
+
+static Transform make_transform(int p_i) {
+	return Transform(Basis(Vector3(0, 1, 0), p_i * 0.01), Vector3(p_i, 2 * p_i, 3 * p_i));
+}
+
+static bool test_values() {
+	Variant values[4] = { make_transform(1), Basis(Vector3(1, 0, 0), 0.5), AABB(Vector3(1, 2, 3), Vector3(4, 5, 6)), Transform2D(0.25, Vector2(7, 8)) };
+	for (int i = 0; i < 4; i++) {
+		Variant copy = values[i];
+		Variant assigned;
+		assigned = copy;
+		copy = Variant();
+		if (assigned != values[i] || assigned.get_type() != values[i].get_type()) {
+			OS::get_singleton()->print("FAILED: copy of %ls changed.\n", Variant::get_type_name(values[i].get_type()).c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+// Variants made on one thread and freed on another move slots between thread caches.
+struct CrossThread {
+	Variant variants[THREADS][THREAD_VARIANTS];
+	uint32_t round = 0;
+	SafeFlag failed;
+
+	static void work(void *p_self, uint32_t p_index) {
+		CrossThread *c = (CrossThread *)p_self;
+		// Each round a thread takes over the variants another one made.
+		Variant *mine = c->variants[(p_index + c->round) % THREADS];
+		for (int i = 0; i < THREAD_VARIANTS; i++) {
+			if (mine[i].get_type() == Variant::TRANSFORM && mine[i].operator Transform() != make_transform(i)) {
+				c->failed.set();
+			}
+			mine[i] = Variant();
+			mine[i] = make_transform(i);
+		}
+	}
+
+	bool run() {
+		for (round = 0; round < THREAD_ROUNDS; round++) {
+			test_run_threads(THREADS, &CrossThread::work, this);
+		}
+		return !failed.is_set();
+	}
+};
+
+static bool test_threads() {
+	CrossThread *cross = memnew(CrossThread);
+	bool pass = cross->run();
+	memdelete(cross);
+	return pass;
+}
+
+static void bench_alloc() {
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_OPS; i++) {
+		Transform *t = memnew(Transform);
+		memdelete(t);
+	}
+	reporter.bench("memnew_transform_ns", (OS::get_singleton()->get_ticks_usec() - from) * 1000.0 / BENCH_OPS);
+
+	Variant source = make_transform(1);
+	uint64_t trips = VariantPool::get_shared_trips();
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_OPS; i++) {
+		Variant copy = source;
+	}
+	reporter.bench("variant_copy_ns", (OS::get_singleton()->get_ticks_usec() - from) * 1000.0 / BENCH_OPS);
+	reporter.bench("variant_copy_shared_trips_per_1000", (VariantPool::get_shared_trips() - trips) * 1000.0 / BENCH_OPS);
+
+	Array array;
+	trips = VariantPool::get_shared_trips();
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < BENCH_OPS; i++) {
+		array.push_back(source);
+	}
+	array.clear();
+	reporter.bench("array_fill_ns", (OS::get_singleton()->get_ticks_usec() - from) * 1000.0 / BENCH_OPS);
+	reporter.bench("array_fill_shared_trips_per_1000", (VariantPool::get_shared_trips() - trips) * 1000.0 / BENCH_OPS);
+}
+
+#ifdef MODULE_GDSCRIPT_ENABLED
+static const char *script_source =
+		"static func bench(count):\n"
+		"\tvar step = Transform(Basis(Vector3(0, 1, 0), 0.01), Vector3(1, 2, 3))\n"
+		"\tvar acc = Transform()\n"
+		"\tvar list = []\n"
+		"\tfor i in range(count):\n"
+		"\t\tacc = acc * step\n"
+		"\t\tlist.append(acc)\n"
+		"\tvar sum = Vector3()\n"
+		"\tfor t in list:\n"
+		"\t\tsum += t.origin\n"
+		"\treturn sum\n";
+
+static void bench_script() {
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(script_source);
+	ERR_FAIL_COND(script->reload() != OK);
+
+	// Through Object, GDScript hides the other overloads.
+	Object *object = script.ptr();
+
+	uint64_t trips = VariantPool::get_shared_trips();
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	object->call("bench", SCRIPT_ITERATIONS);
+	reporter.bench("gdscript_transform_loop_ns", (OS::get_singleton()->get_ticks_usec() - from) * 1000.0 / SCRIPT_ITERATIONS);
+	reporter.bench("gdscript_shared_trips_per_1000", (VariantPool::get_shared_trips() - trips) * 1000.0 / SCRIPT_ITERATIONS);
+}
+#endif
+
+MainLoop *test() {
+	bool success = reporter.check("values", test_values());
+	success = reporter.check("threads", test_threads()) && success;
+
+	bench_alloc();
+#ifdef MODULE_GDSCRIPT_ENABLED
+	bench_script();
+#endif
+
+	if (success) {
+		OS::get_singleton()->print("Variant pool checks passed.\n");
+	} else {
+		OS::get_singleton()->print("Variant pool checks FAILED.\n");
+	}
+	return nullptr;
+}
+
+} // namespace TestVariantPool
@@ -687,21 +687,12 @@ void LightmapperCPU::_plot_triangle(const Vector2 *p_vertices, const Vector3 *p_
 			texel.alpha = c.a;
 			texel.emission = Vector3(e.r, e.g, e.b);
 			texel.area_coverage = area_coverage;
+			texel.coord = Vector2i(i, j);
 			r_lightmap.push_back(texel);
 		}
 	}
 }
 
-_ALWAYS_INLINE_ float uniform_rand() {
-	/* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
-	static thread_local uint32_t state = Math::rand();
-	state ^= state << 13;
-	state ^= state >> 17;
-	state ^= state << 5;
-	/* implicit conversion from 'unsigned int' to 'float' changes value from 4294967295 to 4294967296 */
-	return float(state) / float(UINT32_MAX);
-}
-
 float LightmapperCPU::_get_omni_attenuation(float distance, float inv_range, float decay) const {
 	float nd = distance * inv_range;
 	nd *= nd;
@@ -711,8 +702,16 @@ float LightmapperCPU::_get_omni_attenuation(float distance, float inv_range, flo
 	return nd * powf(MAX(distance, 0.0001f), -decay);
 }
 
+void LightmapperCPU::_init_sample_sequence(RandomSequence &r_sequence, const LightmapTexel &p_texel, uint32_t p_pass) const {
+	r_sequence.set_type(parameters.sample_sequence);
+	r_sequence.set_seed(((uint32_t)p_texel.coord.x | ((uint32_t)p_texel.coord.y << 16)) ^ (p_pass * 0x9E3779B9));
+	r_sequence.set_pixel(p_texel.coord.x, p_texel.coord.y);
+}
+
 void LightmapperCPU::_compute_direct_light(uint32_t p_idx, void *r_lightmap) {
 	LightmapTexel *lightmap = (LightmapTexel *)r_lightmap;
+	RandomSequence sequence;
+	_init_sample_sequence(sequence, lightmap[p_idx], 0);
 	for (unsigned int i = 0; i < lights.size(); ++i) {
 		const Light &light = lights[i];
 		Vector3 normal = lightmap[p_idx].normal;
@@ -809,8 +808,10 @@ void LightmapperCPU::_compute_direct_light(uint32_t p_idx, void *r_lightmap) {
 					}
 				}
 
-				float r = uniform_rand();
-				float a = uniform_rand() * Math_TAU;
+				// One 2D pattern per light, so shadow rays stay stratified across the disk.
+				const Vector2 u = sequence.get_2d(j, i);
+				float r = u.x;
+				float a = u.y * Math_TAU;
 				Vector2 disk_sample = (r * Vector2(Math::cos(a), Math::sin(a))) * soft_shadowing_disk_size;
 				light_disk_to_point = (light_to_point + disk_sample.x * light_to_point_tan + disk_sample.y * light_to_point_bitan).normalized();
 
@@ -846,6 +847,9 @@ void LightmapperCPU::_compute_indirect_light(uint32_t p_idx, void *r_lightmap) {
 	const Vector3 const_forward = Vector3(0, 0, 1);
 	const Vector3 const_up = Vector3(0, 1, 0);
 
+	RandomSequence sequence;
+	_init_sample_sequence(sequence, texel, 1);
+
 	for (int i = 0; i < parameters.samples; i++) {
 		Vector3 color;
 		Vector3 throughput = Vector3(1.0f, 1.0f, 1.0f);
@@ -866,8 +870,10 @@ void LightmapperCPU::_compute_indirect_light(uint32_t p_idx, void *r_lightmap) {
 			Basis normal_xform = Basis(tangent, bitangent, normal);
 			normal_xform.transpose();
 
-			float u1 = uniform_rand();
-			float u2 = uniform_rand();
+			// Each bounce samples its own 2D pattern, and Russian roulette the one after it.
+			const Vector2 u = sequence.get_2d(i, depth * 2);
+			float u1 = u.x;
+			float u2 = u.y;
 
 			float radius = Math::sqrt(u1);
 			float theta = Math_TAU * u2;
@@ -927,7 +933,7 @@ void LightmapperCPU::_compute_indirect_light(uint32_t p_idx, void *r_lightmap) {
 			// Russian Roulette
 			// https://computergraphics.stackexchange.com/questions/2316/is-russian-roulette-really-the-answer
 			const float p = throughput[throughput.max_axis()];
-			if (uniform_rand() > p) {
+			if (sequence.get_1d(i, depth * 2 + 1) > p) {
 				break;
 			}
 			throughput *= 1.0f / p;
@@ -1301,6 +1307,7 @@ LightmapperCPU::BakeError LightmapperCPU::bake(BakeQuality p_quality, bool p_use
 	parameters.bounce_indirect_energy = p_bounce_indirect_energy;
 	parameters.environment_transform = p_environment_transform;
 	parameters.environment_panorama = p_environment_panorama;
+	parameters.sample_sequence = (RandomSequence::Type)CLAMP(int(GLOBAL_GET("rendering/cpu_lightmapper/quality/sample_sequence")), 0, RandomSequence::SEQUENCE_MAX - 1);
 
 	switch (p_quality) {
 		case BAKE_QUALITY_LOW: {
@@ -32,6 +32,7 @@
 #define LIGHTMAPPER_CPU_H
 
 #include "core/local_vector.h"
+#include "core/math/random_sequence.h"
 #include "scene/3d/lightmapper.h"
 #include "scene/resources/mesh.h"
 #include "scene/resources/surface_tool.h"
@@ -77,6 +78,7 @@ class LightmapperCPU : public Lightmapper {
 		Vector3 output_light;
 
 		float area_coverage;
+		Vector2i coord; // Lightmap pixel, scrambles the sample sequences.
 	};
 
 	struct BakeParams {
@@ -84,6 +86,7 @@ class LightmapperCPU : public Lightmapper {
 		int bounces;
 		float bounce_indirect_energy;
 		int samples;
+		RandomSequence::Type sample_sequence = RandomSequence::SEQUENCE_SOBOL;
 		bool use_denoiser = true;
 		bool use_physical_light_attenuation = false;
 		Ref<Image> environment_panorama;
@@ -154,6 +157,7 @@ class LightmapperCPU : public Lightmapper {
 
 	float _get_omni_attenuation(float distance, float inv_range, float decay) const;
 
+	void _init_sample_sequence(RandomSequence &r_sequence, const LightmapTexel &p_texel, uint32_t p_pass) const;
 	void _compute_direct_light(uint32_t p_idx, void *r_lightmap);
 
 	void _compute_indirect_light(uint32_t p_idx, void *r_lightmap);
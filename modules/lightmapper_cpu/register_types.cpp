@@ -45,6 +45,8 @@ void register_lightmapper_cpu_types() {
 	GLOBAL_DEF("rendering/cpu_lightmapper/quality/medium_quality_ray_count", 256);
 	GLOBAL_DEF("rendering/cpu_lightmapper/quality/high_quality_ray_count", 512);
 	GLOBAL_DEF("rendering/cpu_lightmapper/quality/ultra_quality_ray_count", 1024);
+	GLOBAL_DEF("rendering/cpu_lightmapper/quality/sample_sequence", RandomSequence::SEQUENCE_SOBOL);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/cpu_lightmapper/quality/sample_sequence", PropertyInfo(Variant::INT, "rendering/cpu_lightmapper/quality/sample_sequence", PROPERTY_HINT_ENUM, "Random,Sobol,Halton,R2,Blue Noise"));
 #ifndef _3D_DISABLED
 	Lightmapper::create_cpu = create_lightmapper_cpu;
 #endif
@@ -31,6 +31,7 @@
 #include "open_simplex_noise.h"
 
 #include "core/core_string_names.h"
+#include "core/os/thread_work_pool.h"
 
 OpenSimplexNoise::OpenSimplexNoise() {
 	seed = 0;
@@ -102,53 +103,165 @@ void OpenSimplexNoise::set_lacunarity(float p_lacunarity) {
 	emit_changed();
 }
 
-Ref<Image> OpenSimplexNoise::get_image(int p_width, int p_height, const Vector2 &p_noise_offset) const {
-	PoolVector<uint8_t> data;
-	data.resize(p_width * p_height);
-
-	PoolVector<uint8_t>::Write wd8 = data.write();
-
-	for (int i = 0; i < p_height; i++) {
-		for (int j = 0; j < p_width; j++) {
-			float v = get_noise_2d(float(j) + p_noise_offset.x, float(i) + p_noise_offset.y);
-			v = v * 0.5 + 0.5; // Normalize [0..1]
-			wd8[(i * p_width + j)] = uint8_t(CLAMP(v * 255.0, 0, 255));
+// Points evaluated together by the batch functions, so coordinates stay on the stack.
+#define NOISE_BATCH_CHUNK 64
+// Images with fewer pixels are generated on the calling thread.
+#define NOISE_THREADED_MIN_PIXELS (256 * 256)
+
+void OpenSimplexNoise::_generate_row(uint32_t p_row, ImageRows *p_rows) const {
+	float *values = p_rows->values + p_row * p_rows->width;
+	if (p_rows->seamless_size) {
+		const float size = p_rows->seamless_size;
+		const float radius = size / (2.0 * Math_PI);
+		float ii = (float)p_row / size;
+		ii *= 2.0 * Math_PI;
+		const float z = radius * Math::sin(ii);
+		const float w = radius * Math::cos(ii);
+		float points[NOISE_BATCH_CHUNK * 4];
+		for (int from = 0; from < p_rows->width; from += NOISE_BATCH_CHUNK) {
+			const int count = MIN(NOISE_BATCH_CHUNK, p_rows->width - from);
+			for (int j = 0; j < count; j++) {
+				float jj = (float)(from + j) / size;
+				jj *= 2.0 * Math_PI;
+				points[j * 4 + 0] = radius * Math::sin(jj);
+				points[j * 4 + 1] = radius * Math::cos(jj);
+				points[j * 4 + 2] = z;
+				points[j * 4 + 3] = w;
+			}
+			fill_noise_4d(points, values + from, count);
+		}
+	} else {
+		Vector2 points[NOISE_BATCH_CHUNK];
+		for (int from = 0; from < p_rows->width; from += NOISE_BATCH_CHUNK) {
+			const int count = MIN(NOISE_BATCH_CHUNK, p_rows->width - from);
+			for (int j = 0; j < count; j++) {
+				points[j] = Vector2(float(from + j) + p_rows->offset.x, float(p_row) + p_rows->offset.y);
+			}
+			fill_noise_2d(points, values + from, count);
 		}
 	}
+}
 
-	Ref<Image> image = memnew(Image(p_width, p_height, false, Image::FORMAT_L8, data));
-	return image;
+void OpenSimplexNoise::_generate_rows(ImageRows &p_rows, int p_height) const {
+#ifndef NO_THREADS
+	if (p_rows.width * p_height >= NOISE_THREADED_MIN_PIXELS) {
+		ThreadWorkPool pool;
+		pool.init();
+		pool.do_work(p_height, this, &OpenSimplexNoise::_generate_row, &p_rows);
+		pool.finish();
+		return;
+	}
+#endif
+	for (int i = 0; i < p_height; i++) {
+		_generate_row(i, &p_rows);
+	}
 }
 
-Ref<Image> OpenSimplexNoise::get_seamless_image(int p_size) const {
+Ref<Image> OpenSimplexNoise::_values_to_image(const LocalVector<float> &p_values, int p_width, int p_height) const {
 	PoolVector<uint8_t> data;
-	data.resize(p_size * p_size);
-
+	data.resize(p_width * p_height);
 	PoolVector<uint8_t>::Write wd8 = data.write();
+	for (int i = 0; i < p_width * p_height; i++) {
+		float v = p_values[i] * 0.5 + 0.5; // Normalize [0..1]
+		wd8[i] = uint8_t(CLAMP(v * 255.0, 0, 255));
+	}
+	wd8.release();
+	Ref<Image> image = memnew(Image(p_width, p_height, false, Image::FORMAT_L8, data));
+	return image;
+}
 
-	for (int i = 0; i < p_size; i++) {
-		for (int j = 0; j < p_size; j++) {
-			float ii = (float)i / (float)p_size;
-			float jj = (float)j / (float)p_size;
+Ref<Image> OpenSimplexNoise::get_image(int p_width, int p_height, const Vector2 &p_noise_offset) const {
+	LocalVector<float> values;
+	values.resize(p_width * p_height);
+	ImageRows rows = { values.ptr(), p_width, p_noise_offset, 0 };
+	_generate_rows(rows, p_height);
+	return _values_to_image(values, p_width, p_height);
+}
 
-			ii *= 2.0 * Math_PI;
-			jj *= 2.0 * Math_PI;
+Ref<Image> OpenSimplexNoise::get_seamless_image(int p_size) const {
+	LocalVector<float> values;
+	values.resize(p_size * p_size);
+	ImageRows rows = { values.ptr(), p_size, Vector2(), p_size };
+	_generate_rows(rows, p_size);
+	return _values_to_image(values, p_size, p_size);
+}
 
-			float radius = p_size / (2.0 * Math_PI);
+void OpenSimplexNoise::fill_image_2d(const Ref<Image> &p_image, const Rect2 &p_rect, const Vector2 &p_noise_offset) const {
+	ERR_FAIL_COND(p_image.is_null());
+	Ref<Image> image = p_image;
+	ERR_FAIL_COND_MSG(image->is_compressed(), "Can't fill a compressed image with noise.");
+	const Rect2 image_rect = Rect2(Vector2(), image->get_size());
+	const Rect2 rect = p_rect.has_no_area() ? image_rect : image_rect.clip(Rect2(p_rect.position.floor(), p_rect.size.floor()));
+	const int width = rect.size.x;
+	const int height = rect.size.y;
+	if (width <= 0 || height <= 0) {
+		return;
+	}
 
-			float x = radius * Math::sin(jj);
-			float y = radius * Math::cos(jj);
-			float z = radius * Math::sin(ii);
-			float w = radius * Math::cos(ii);
-			float v = get_noise_4d(x, y, z, w);
+	LocalVector<float> values;
+	values.resize(width * height);
+	ImageRows rows = { values.ptr(), width, rect.position + p_noise_offset, 0 };
+	_generate_rows(rows, height);
+
+	// Values are normalized to [0..1] like get_image(), for every format.
+	const int image_width = image->get_width();
+	const int x0 = rect.position.x;
+	const int y0 = rect.position.y;
+	if (image->get_format() == Image::FORMAT_L8 || image->get_format() == Image::FORMAT_R8) {
+		PoolVector<uint8_t> data = image->get_data();
+		{
+			PoolVector<uint8_t>::Write w = data.write();
+			for (int i = 0; i < height; i++) {
+				for (int j = 0; j < width; j++) {
+					const float v = values[i * width + j] * 0.5 + 0.5;
+					w[(y0 + i) * image_width + x0 + j] = uint8_t(CLAMP(v * 255.0, 0, 255));
+				}
+			}
+		}
+		image->create(image->get_width(), image->get_height(), image->has_mipmaps(), image->get_format(), data);
+		return;
+	}
+	image->lock();
+	for (int i = 0; i < height; i++) {
+		for (int j = 0; j < width; j++) {
+			const float v = values[i * width + j] * 0.5 + 0.5;
+			image->set_pixel(x0 + j, y0 + i, Color(v, v, v, 1.0));
+		}
+	}
+	image->unlock();
+}
 
-			v = v * 0.5 + 0.5; // Normalize [0..1]
-			wd8[(i * p_size + j)] = uint8_t(CLAMP(v * 255.0, 0, 255));
+PoolRealArray OpenSimplexNoise::get_noise_2d_batch(const PoolVector2Array &p_points) const {
+	PoolRealArray values;
+	values.resize(p_points.size());
+	PoolVector2Array::Read r = p_points.read();
+	PoolRealArray::Write w = values.write();
+	// PoolRealArray holds doubles in real_t=double builds.
+	float out[NOISE_BATCH_CHUNK];
+	for (int from = 0; from < p_points.size(); from += NOISE_BATCH_CHUNK) {
+		const int count = MIN(NOISE_BATCH_CHUNK, p_points.size() - from);
+		fill_noise_2d(r.ptr() + from, out, count);
+		for (int j = 0; j < count; j++) {
+			w[from + j] = out[j];
 		}
 	}
+	return values;
+}
 
-	Ref<Image> image = memnew(Image(p_size, p_size, false, Image::FORMAT_L8, data));
-	return image;
+PoolRealArray OpenSimplexNoise::get_noise_3d_batch(const PoolVector3Array &p_points) const {
+	PoolRealArray values;
+	values.resize(p_points.size());
+	PoolVector3Array::Read r = p_points.read();
+	PoolRealArray::Write w = values.write();
+	float out[NOISE_BATCH_CHUNK];
+	for (int from = 0; from < p_points.size(); from += NOISE_BATCH_CHUNK) {
+		const int count = MIN(NOISE_BATCH_CHUNK, p_points.size() - from);
+		fill_noise_3d(r.ptr() + from, out, count);
+		for (int j = 0; j < count; j++) {
+			w[from + j] = out[j];
+		}
+	}
+	return values;
 }
 
 void OpenSimplexNoise::_bind_methods() {
@@ -169,6 +282,7 @@ void OpenSimplexNoise::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_image", "width", "height", "noise_offset"), &OpenSimplexNoise::get_image, DEFVAL(Vector2()));
 	ClassDB::bind_method(D_METHOD("get_seamless_image", "size"), &OpenSimplexNoise::get_seamless_image);
+	ClassDB::bind_method(D_METHOD("fill_image_2d", "image", "rect", "noise_offset"), &OpenSimplexNoise::fill_image_2d, DEFVAL(Rect2()), DEFVAL(Vector2()));
 
 	ClassDB::bind_method(D_METHOD("get_noise_1d", "x"), &OpenSimplexNoise::get_noise_1d);
 	ClassDB::bind_method(D_METHOD("get_noise_2d", "x", "y"), &OpenSimplexNoise::get_noise_2d);
@@ -177,6 +291,8 @@ void OpenSimplexNoise::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("get_noise_2dv", "pos"), &OpenSimplexNoise::get_noise_2dv);
 	ClassDB::bind_method(D_METHOD("get_noise_3dv", "pos"), &OpenSimplexNoise::get_noise_3dv);
+	ClassDB::bind_method(D_METHOD("get_noise_2d_batch", "points"), &OpenSimplexNoise::get_noise_2d_batch);
+	ClassDB::bind_method(D_METHOD("get_noise_3d_batch", "points"), &OpenSimplexNoise::get_noise_3d_batch);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "seed"), "set_seed", "get_seed");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "octaves", PROPERTY_HINT_RANGE, vformat("1,%d,1", MAX_OCTAVES)), "set_octaves", "get_octaves");
@@ -254,3 +370,94 @@ float OpenSimplexNoise::get_noise_4d(float x, float y, float z, float w) const {
 
 	return sum / max;
 }
+
+void OpenSimplexNoise::fill_noise_2d(const Vector2 *p_points, float *r_values, int p_count) const {
+	float x[NOISE_BATCH_CHUNK];
+	float y[NOISE_BATCH_CHUNK];
+	for (int from = 0; from < p_count; from += NOISE_BATCH_CHUNK) {
+		const int count = MIN(NOISE_BATCH_CHUNK, p_count - from);
+		const Vector2 *points = p_points + from;
+		float *values = r_values + from;
+		for (int j = 0; j < count; j++) {
+			x[j] = points[j].x / period;
+			y[j] = points[j].y / period;
+			values[j] = _get_octave_noise_2d(0, x[j], y[j]);
+		}
+		float amp = 1.0;
+		float max = 1.0;
+		for (int i = 1; i < octaves; i++) {
+			amp *= persistence;
+			max += amp;
+			for (int j = 0; j < count; j++) {
+				x[j] *= lacunarity;
+				y[j] *= lacunarity;
+				values[j] += _get_octave_noise_2d(i, x[j], y[j]) * amp;
+			}
+		}
+		for (int j = 0; j < count; j++) {
+			values[j] /= max;
+		}
+	}
+}
+
+void OpenSimplexNoise::fill_noise_3d(const Vector3 *p_points, float *r_values, int p_count) const {
+	float x[NOISE_BATCH_CHUNK];
+	float y[NOISE_BATCH_CHUNK];
+	float z[NOISE_BATCH_CHUNK];
+	for (int from = 0; from < p_count; from += NOISE_BATCH_CHUNK) {
+		const int count = MIN(NOISE_BATCH_CHUNK, p_count - from);
+		const Vector3 *points = p_points + from;
+		float *values = r_values + from;
+		for (int j = 0; j < count; j++) {
+			x[j] = points[j].x / period;
+			y[j] = points[j].y / period;
+			z[j] = points[j].z / period;
+			values[j] = _get_octave_noise_3d(0, x[j], y[j], z[j]);
+		}
+		float amp = 1.0;
+		float max = 1.0;
+		for (int i = 1; i < octaves; i++) {
+			amp *= persistence;
+			max += amp;
+			for (int j = 0; j < count; j++) {
+				x[j] *= lacunarity;
+				y[j] *= lacunarity;
+				z[j] *= lacunarity;
+				values[j] += _get_octave_noise_3d(i, x[j], y[j], z[j]) * amp;
+			}
+		}
+		for (int j = 0; j < count; j++) {
+			values[j] /= max;
+		}
+	}
+}
+
+void OpenSimplexNoise::fill_noise_4d(const float *p_points, float *r_values, int p_count) const {
+	float x[NOISE_BATCH_CHUNK * 4];
+	for (int from = 0; from < p_count; from += NOISE_BATCH_CHUNK) {
+		const int count = MIN(NOISE_BATCH_CHUNK, p_count - from);
+		const float *points = p_points + from * 4;
+		float *values = r_values + from;
+		for (int j = 0; j < count * 4; j++) {
+			x[j] = points[j] / period;
+		}
+		for (int j = 0; j < count; j++) {
+			values[j] = _get_octave_noise_4d(0, x[j * 4], x[j * 4 + 1], x[j * 4 + 2], x[j * 4 + 3]);
+		}
+		float amp = 1.0;
+		float max = 1.0;
+		for (int i = 1; i < octaves; i++) {
+			amp *= persistence;
+			max += amp;
+			for (int j = 0; j < count * 4; j++) {
+				x[j] *= lacunarity;
+			}
+			for (int j = 0; j < count; j++) {
+				values[j] += _get_octave_noise_4d(i, x[j * 4], x[j * 4 + 1], x[j * 4 + 2], x[j * 4 + 3]) * amp;
+			}
+		}
+		for (int j = 0; j < count; j++) {
+			values[j] /= max;
+		}
+	}
+}
@@ -32,6 +32,7 @@
 #define OPEN_SIMPLEX_NOISE_H
 
 #include "core/image.h"
+#include "core/local_vector.h"
 #include "core/reference.h"
 #include "scene/resources/texture.h"
 
@@ -54,6 +55,17 @@ class OpenSimplexNoise : public Resource {
 	float period; // Distance above which we start to see similarities. The higher, the longer "hills" will be on a terrain.
 	float lacunarity; // Controls period change across octaves. 2 is usually a good value to address all detail levels.
 
+	// Image rows are generated independently, on a ThreadWorkPool for large images.
+	struct ImageRows {
+		float *values;
+		int width;
+		Vector2 offset; // Noise coordinates of the first pixel.
+		int seamless_size; // 0 for plain 2D noise.
+	};
+	void _generate_row(uint32_t p_row, ImageRows *p_rows) const;
+	void _generate_rows(ImageRows &p_rows, int p_height) const;
+	Ref<Image> _values_to_image(const LocalVector<float> &p_values, int p_width, int p_height) const;
+
 public:
 	OpenSimplexNoise();
 	~OpenSimplexNoise();
@@ -77,12 +89,22 @@ public:
 
 	Ref<Image> get_image(int p_width, int p_height, const Vector2 &p_noise_offset = Vector2()) const;
 	Ref<Image> get_seamless_image(int p_size) const;
+	void fill_image_2d(const Ref<Image> &p_image, const Rect2 &p_rect = Rect2(), const Vector2 &p_noise_offset = Vector2()) const;
 
 	float get_noise_1d(float x) const;
 	float get_noise_2d(float x, float y) const;
 	float get_noise_3d(float x, float y, float z) const;
 	float get_noise_4d(float x, float y, float z, float w) const;
 
+	// Batch evaluation, bit-identical to the per-point calls. Octaves are the outer loop, so
+	// each octave's permutation tables stay in cache across the batch and the independent
+	// per-point evaluations overlap instead of running one after the other.
+	void fill_noise_2d(const Vector2 *p_points, float *r_values, int p_count) const;
+	void fill_noise_3d(const Vector3 *p_points, float *r_values, int p_count) const;
+	void fill_noise_4d(const float *p_points, float *r_values, int p_count) const; // 4 floats per point.
+	PoolRealArray get_noise_2d_batch(const PoolVector2Array &p_points) const;
+	PoolRealArray get_noise_3d_batch(const PoolVector3Array &p_points) const;
+
 	_FORCE_INLINE_ float _get_octave_noise_2d(int octave, float x, float y) const { return open_simplex_noise2(&(contexts[octave]), x, y); }
 	_FORCE_INLINE_ float _get_octave_noise_3d(int octave, float x, float y, float z) const { return open_simplex_noise3(&(contexts[octave]), x, y, z); }
 	_FORCE_INLINE_ float _get_octave_noise_4d(int octave, float x, float y, float z, float w) const { return open_simplex_noise4(&(contexts[octave]), x, y, z, w); }
@@ -30,6 +30,7 @@
 
 #include "cpu_particles_2d.h"
 #include "core/core_string_names.h"
+#include "core/math/random_profiler.h"
 #include "core/os/os.h"
 #include "scene/2d/canvas_item.h"
 #include "scene/2d/particles_2d.h"
@@ -587,6 +588,7 @@ void CPUParticles2D::_update_internal() {
 }
 
 void CPUParticles2D::_particles_process(float p_delta) {
+	RANDOM_PROFILE_SCOPE("CPUParticles2D");
 	p_delta *= speed_scale;
 
 	int pcount = particles.size();
@@ -30,6 +30,7 @@
 
 #include "cpu_particles.h"
 
+#include "core/math/random_profiler.h"
 #include "core/os/os.h"
 #include "scene/3d/camera.h"
 #include "scene/3d/particles.h"
@@ -618,6 +619,7 @@ void CPUParticles::_update_internal(bool p_on_physics_tick) {
 }
 
 void CPUParticles::_particles_process(float p_delta) {
+	RANDOM_PROFILE_SCOPE("CPUParticles");
 	p_delta *= speed_scale;
 
 	int pcount = particles.size();
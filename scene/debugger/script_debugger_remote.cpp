@@ -33,6 +33,7 @@
 #include "core/engine.h"
 #include "core/io/ip.h"
 #include "core/io/marshalls.h"
+#include "core/math/random_profiler.h"
 #include "core/os/input.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
@@ -755,6 +756,7 @@ void ScriptDebuggerRemote::_poll_events() {
 			max_frame_functions = cmd[1];
 			profiler_function_signature_map.clear();
 			profiling = true;
+			RandomProfiler::set_active(true);
 			frame_time = 0;
 			process_time = 0;
 			physics_time = 0;
@@ -767,6 +769,7 @@ void ScriptDebuggerRemote::_poll_events() {
 				ScriptServer::get_language(i)->profiling_stop();
 			}
 			profiling = false;
+			RandomProfiler::set_active(GLOBAL_GET("debug/settings/profiler/random_draws"));
 			_send_profiling_data(false);
 			print_verbose("Ending profiling.");
 		} else if (command == "start_network_profiling") {
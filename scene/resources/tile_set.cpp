@@ -80,6 +80,7 @@ bool TileSet::_set(const StringName &p_name, const Variant &p_value) {
 			autotile_set_spacing(id, p_value);
 		} else if (what == "bitmask_flags") {
 			tile_map[id].autotile_data.flags.clear();
+			_clear_subtile_choices(id);
 			if (p_value.is_array()) {
 				Array p = p_value;
 				Vector2 last_coord;
@@ -118,6 +119,7 @@ bool TileSet::_set(const StringName &p_name, const Variant &p_value) {
 			}
 		} else if (what == "priority_map") {
 			tile_map[id].autotile_data.priority_map.clear();
+			_clear_subtile_choices(id);
 			Array p = p_value;
 			Vector3 val;
 			Vector2 v;
@@ -379,6 +381,7 @@ void TileSet::create_tile(int p_id) {
 void TileSet::autotile_set_bitmask_mode(int p_id, BitmaskMode p_mode) {
 	ERR_FAIL_COND_MSG(!tile_map.has(p_id), vformat("The TileSet doesn't have a tile with ID '%d'.", p_id));
 	tile_map[p_id].autotile_data.bitmask_mode = p_mode;
+	_clear_subtile_choices(p_id);
 	_change_notify("");
 	emit_changed();
 }
@@ -448,6 +451,7 @@ Vector2 TileSet::tile_get_texture_offset(int p_id) const {
 void TileSet::tile_set_region(int p_id, const Rect2 &p_region) {
 	ERR_FAIL_COND_MSG(!tile_map.has(p_id), vformat("The TileSet doesn't have a tile with ID '%d'.", p_id));
 	tile_map[p_id].region = p_region;
+	_clear_subtile_choices(p_id);
 	emit_changed();
 	_change_notify("region");
 }
@@ -484,6 +488,7 @@ void TileSet::autotile_set_spacing(int p_id, int p_spacing) {
 	ERR_FAIL_COND_MSG(!tile_map.has(p_id), vformat("The TileSet doesn't have a tile with ID '%d'.", p_id));
 	ERR_FAIL_COND(p_spacing < 0);
 	tile_map[p_id].autotile_data.spacing = p_spacing;
+	_clear_subtile_choices(p_id);
 	emit_changed();
 }
 
@@ -496,6 +501,7 @@ void TileSet::autotile_set_size(int p_id, const Size2 &p_size) {
 	ERR_FAIL_COND_MSG(!tile_map.has(p_id), vformat("The TileSet doesn't have a tile with ID '%d'.", p_id));
 	ERR_FAIL_COND(p_size.x <= 0 || p_size.y <= 0);
 	tile_map[p_id].autotile_data.size = p_size;
+	_clear_subtile_choices(p_id);
 }
 
 Size2 TileSet::autotile_get_size(int p_id) const {
@@ -506,12 +512,14 @@ Size2 TileSet::autotile_get_size(int p_id) const {
 void TileSet::autotile_clear_bitmask_map(int p_id) {
 	ERR_FAIL_COND_MSG(!tile_map.has(p_id), vformat("The TileSet doesn't have a tile with ID '%d'.", p_id));
 	tile_map[p_id].autotile_data.flags.clear();
+	_clear_subtile_choices(p_id);
 }
 
 void TileSet::autotile_set_subtile_priority(int p_id, const Vector2 &p_coord, int p_priority) {
 	ERR_FAIL_COND_MSG(!tile_map.has(p_id), vformat("The TileSet doesn't have a tile with ID '%d'.", p_id));
 	ERR_FAIL_COND(p_priority <= 0);
 	tile_map[p_id].autotile_data.priority_map[p_coord] = p_priority;
+	_clear_subtile_choices(p_id);
 }
 
 int TileSet::autotile_get_subtile_priority(int p_id, const Vector2 &p_coord) {
@@ -559,6 +567,7 @@ void TileSet::autotile_set_bitmask(int p_id, const Vector2 &p_coord, uint32_t p_
 	} else {
 		tile_map[p_id].autotile_data.flags[p_coord] = p_flag;
 	}
+	_clear_subtile_choices(p_id);
 }
 
 uint32_t TileSet::autotile_get_bitmask(int p_id, const Vector2 &p_coord) {
@@ -603,51 +612,44 @@ Vector2 TileSet::autotile_get_subtile_for_bitmask(int p_id, uint16_t p_bitmask,
 		}
 	}
 
-	List<Vector2> coords;
-	List<uint32_t> priorities;
-	uint32_t priority_sum = 0;
-	uint32_t mask;
-	uint16_t mask_;
-	uint16_t mask_ignore;
-	for (Map<Vector2, uint32_t>::Element *E = tile_map[p_id].autotile_data.flags.front(); E; E = E->next()) {
-		mask = E->get();
-		if (tile_map[p_id].autotile_data.bitmask_mode == BITMASK_2X2) {
-			mask |= (BIND_IGNORE_TOP | BIND_IGNORE_LEFT | BIND_IGNORE_CENTER | BIND_IGNORE_RIGHT | BIND_IGNORE_BOTTOM);
-		}
+	TileData &tile = tile_map[p_id];
+	Map<uint32_t, SubtileChoice>::Element *choice = tile.subtile_choices.find(p_bitmask);
+	if (!choice) {
+		Vector<Vector2> coords;
+		Vector<real_t> priorities;
+		uint32_t mask;
+		uint16_t mask_;
+		uint16_t mask_ignore;
+		for (Map<Vector2, uint32_t>::Element *E = tile.autotile_data.flags.front(); E; E = E->next()) {
+			mask = E->get();
+			if (tile.autotile_data.bitmask_mode == BITMASK_2X2) {
+				mask |= (BIND_IGNORE_TOP | BIND_IGNORE_LEFT | BIND_IGNORE_CENTER | BIND_IGNORE_RIGHT | BIND_IGNORE_BOTTOM);
+			}
 
-		mask_ = mask & 0xFFFF;
-		mask_ignore = mask >> 16;
+			mask_ = mask & 0xFFFF;
+			mask_ignore = mask >> 16;
 
-		if (((mask_ & (~mask_ignore)) == (p_bitmask & (~mask_ignore))) && (((~mask_) | mask_ignore) == ((~p_bitmask) | mask_ignore))) {
-			uint32_t priority = autotile_get_subtile_priority(p_id, E->key());
-			priority_sum += priority;
-			priorities.push_back(priority);
-			coords.push_back(E->key());
+			if (((mask_ & (~mask_ignore)) == (p_bitmask & (~mask_ignore))) && (((~mask_) | mask_ignore) == ((~p_bitmask) | mask_ignore))) {
+				// Subtiles without a positive priority are never picked.
+				const int priority = autotile_get_subtile_priority(p_id, E->key());
+				if (priority > 0) {
+					priorities.push_back(priority);
+					coords.push_back(E->key());
+				}
+			}
 		}
-	}
 
-	if (coords.size() == 0) {
-		return autotile_get_icon_coordinate(p_id);
-	} else {
-		uint32_t picked_value = Math::rand() % priority_sum;
-		uint32_t upper_bound;
-		uint32_t lower_bound = 0;
-		Vector2 result = coords.front()->get();
-		List<Vector2>::Element *coords_E = coords.front();
-		List<uint32_t>::Element *priorities_E = priorities.front();
-		while (priorities_E) {
-			upper_bound = lower_bound + priorities_E->get();
-			if (lower_bound <= picked_value && picked_value < upper_bound) {
-				result = coords_E->get();
-				break;
-			}
-			lower_bound = upper_bound;
-			priorities_E = priorities_E->next();
-			coords_E = coords_E->next();
+		choice = tile.subtile_choices.insert(p_bitmask, SubtileChoice());
+		// An empty table (no candidate, or a build failure) falls back to the icon below.
+		if (coords.size() && choice->get().table.build(priorities.ptr(), priorities.size())) {
+			choice->get().coords = coords;
 		}
+	}
 
-		return result;
+	if (choice->get().table.empty()) {
+		return autotile_get_icon_coordinate(p_id);
 	}
+	return _pick_subtile(choice->get());
 }
 
 Vector2 TileSet::atlastile_get_subtile_by_priority(int p_id, const Node *p_tilemap_node, const Vector2 &p_tile_location) {
@@ -662,22 +664,46 @@ Vector2 TileSet::atlastile_get_subtile_by_priority(int p_id, const Node *p_tilem
 		}
 	}
 
-	const Vector2 spacing(autotile_get_spacing(p_id), autotile_get_spacing(p_id));
-	const Vector2 coord = tile_get_region(p_id).size / (autotile_get_size(p_id) + spacing);
-
-	List<Vector2> coords;
-	for (int x = 0; x < coord.x; x++) {
-		for (int y = 0; y < coord.y; y++) {
-			for (int i = 0; i < autotile_get_subtile_priority(p_id, Vector2(x, y)); i++) {
-				coords.push_back(Vector2(x, y));
+	TileData &tile = tile_map[p_id];
+	Map<uint32_t, SubtileChoice>::Element *choice = tile.subtile_choices.find(SUBTILE_CHOICE_ATLAS);
+	if (!choice) {
+		const Vector2 spacing(autotile_get_spacing(p_id), autotile_get_spacing(p_id));
+		const Vector2 coord = tile_get_region(p_id).size / (autotile_get_size(p_id) + spacing);
+
+		Vector<Vector2> coords;
+		Vector<real_t> priorities;
+		for (int x = 0; x < coord.x; x++) {
+			for (int y = 0; y < coord.y; y++) {
+				const int priority = autotile_get_subtile_priority(p_id, Vector2(x, y));
+				if (priority > 0) {
+					priorities.push_back(priority);
+					coords.push_back(Vector2(x, y));
+				}
 			}
 		}
+
+		choice = tile.subtile_choices.insert(SUBTILE_CHOICE_ATLAS, SubtileChoice());
+		// An empty table (no candidate, or a build failure) falls back to the icon below.
+		if (coords.size() && choice->get().table.build(priorities.ptr(), priorities.size())) {
+			choice->get().coords = coords;
+		}
 	}
-	if (coords.size() == 0) {
+
+	if (choice->get().table.empty()) {
 		return autotile_get_icon_coordinate(p_id);
-	} else {
-		return coords[Math::random(0, (int)coords.size())];
 	}
+	return _pick_subtile(choice->get());
+}
+
+void TileSet::_clear_subtile_choices(int p_id) {
+	tile_map[p_id].subtile_choices.clear();
+}
+
+Vector2 TileSet::_pick_subtile(const SubtileChoice &p_choice) const {
+	// Alias table pick: O(1) whatever the number of candidates and their priorities.
+	ERR_FAIL_COND_V(p_choice.table.empty(), Vector2());
+	const uint32_t column = Math::rand_bounded(p_choice.table.size());
+	return p_choice.coords[p_choice.table.pick(column, Math::rand())];
 }
 
 void TileSet::tile_set_name(int p_id, const String &p_name) {
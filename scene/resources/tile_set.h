@@ -32,6 +32,7 @@
 #define TILE_SET_H
 
 #include "core/array.h"
+#include "core/math/random_alias_table.h"
 #include "core/resource.h"
 #include "scene/2d/light_occluder_2d.h"
 #include "scene/2d/navigation_polygon.h"
@@ -110,6 +111,15 @@ public:
 	};
 
 private:
+	// Subtiles a random pick can land on and their priorities, built on first use.
+	struct SubtileChoice {
+		Vector<Vector2> coords;
+		RandomAliasTable table;
+	};
+	enum {
+		SUBTILE_CHOICE_ATLAS = 1 << 16 // Past any 16-bit autotile bitmask.
+	};
+
 	struct TileData {
 		String name;
 		Ref<Texture> texture;
@@ -126,6 +136,7 @@ private:
 		Color modulate;
 		AutotileData autotile_data;
 		int z_index;
+		Map<uint32_t, SubtileChoice> subtile_choices; // Keyed by bitmask, or SUBTILE_CHOICE_ATLAS.
 
 		// Default modulate for back-compat
 		explicit TileData() :
@@ -136,6 +147,9 @@ private:
 
 	Map<int, TileData> tile_map;
 
+	void _clear_subtile_choices(int p_id);
+	Vector2 _pick_subtile(const SubtileChoice &p_choice) const;
+
 protected:
 	bool _set(const StringName &p_name, const Variant &p_value);
 	bool _get(const StringName &p_name, Variant &r_ret) const;
@@ -89,6 +89,34 @@ void VisualServerWrapMT::draw(bool p_swap_buffers, double frame_step) {
 	} else {
 		visual_server->draw(p_swap_buffers, frame_step);
 	}
+
+	_update_queue_info();
+}
+
+void VisualServerWrapMT::_update_queue_info() {
+	// Depth is sampled when the frame is handed over, which is how far behind the render thread is.
+	queue_depth = command_queue.get_pending_bytes();
+
+	uint64_t stall_usec = command_queue.get_stall_usec();
+	queue_stall_usec_in_frame = stall_usec - queue_stall_usec;
+	queue_stall_usec = stall_usec;
+
+	uint64_t syncs = command_queue.get_sync_count();
+	queue_syncs_in_frame = syncs - queue_syncs;
+	queue_syncs = syncs;
+}
+
+uint64_t VisualServerWrapMT::get_render_info(RenderInfo p_info) {
+	switch (p_info) {
+		case INFO_COMMAND_QUEUE_DEPTH:
+			return queue_depth;
+		case INFO_COMMAND_QUEUE_STALL_USEC_IN_FRAME:
+			return queue_stall_usec_in_frame;
+		case INFO_COMMAND_QUEUE_SYNCS_IN_FRAME:
+			return queue_syncs_in_frame;
+		default:
+			return visual_server->get_render_info(p_info);
+	}
 }
 
 void VisualServerWrapMT::init() {
@@ -163,6 +191,12 @@ VisualServerWrapMT::VisualServerWrapMT(VisualServer *p_contained, bool p_create_
 	create_thread = p_create_thread;
 	pool_max_size = GLOBAL_GET("memory/limits/multithreaded_server/rid_pool_prealloc");
 
+	queue_depth = 0;
+	queue_stall_usec = 0;
+	queue_syncs = 0;
+	queue_stall_usec_in_frame = 0;
+	queue_syncs_in_frame = 0;
+
 	if (!p_create_thread) {
 		server_thread = Thread::get_caller_id();
 	} else {
@@ -57,6 +57,14 @@ class VisualServerWrapMT : public VisualServer {
 
 	void thread_exit();
 
+	// Command queue statistics of the previous frame, updated in draw().
+	uint32_t queue_depth;
+	uint64_t queue_stall_usec;
+	uint64_t queue_syncs;
+	uint64_t queue_stall_usec_in_frame;
+	uint64_t queue_syncs_in_frame;
+	void _update_queue_info();
+
 	Mutex alloc_mutex;
 
 	int pool_max_size;
@@ -689,9 +697,7 @@ public:
 	/* RENDER INFO */
 
 	//this passes directly to avoid stalling
-	virtual uint64_t get_render_info(RenderInfo p_info) {
-		return visual_server->get_render_info(p_info);
-	}
+	virtual uint64_t get_render_info(RenderInfo p_info);
 
 	virtual String get_video_adapter_name() const {
 		return visual_server->get_video_adapter_name();
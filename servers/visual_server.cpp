@@ -2475,6 +2475,9 @@ void VisualServer::_bind_methods() {
 	BIND_ENUM_CONSTANT(INFO_VIDEO_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_TEXTURE_MEM_USED);
 	BIND_ENUM_CONSTANT(INFO_VERTEX_MEM_USED);
+	BIND_ENUM_CONSTANT(INFO_COMMAND_QUEUE_DEPTH);
+	BIND_ENUM_CONSTANT(INFO_COMMAND_QUEUE_STALL_USEC_IN_FRAME);
+	BIND_ENUM_CONSTANT(INFO_COMMAND_QUEUE_SYNCS_IN_FRAME);
 
 	BIND_ENUM_CONSTANT(FEATURE_SHADERS);
 	BIND_ENUM_CONSTANT(FEATURE_MULTITHREADED);
@@ -1157,6 +1157,9 @@ public:
 		INFO_VIDEO_MEM_USED,
 		INFO_TEXTURE_MEM_USED,
 		INFO_VERTEX_MEM_USED,
+		INFO_COMMAND_QUEUE_DEPTH,
+		INFO_COMMAND_QUEUE_STALL_USEC_IN_FRAME,
+		INFO_COMMAND_QUEUE_SYNCS_IN_FRAME,
 	};
 
 	virtual uint64_t get_render_info(RenderInfo p_info) = 0;
@@ -11,7 +11,7 @@ class SplitMix64 {
 
  public:
   explicit SplitMix64(uint64_t seed) : x(seed) {}
-  explicit SplitMix64(std::array<uint64_t, 1> &seed) : x(seed[0]) {}
+  explicit SplitMix64(const std::array<uint64_t, 1> &seed) : x(seed[0]) {}
 
   uint64_t Next() {
     uint64_t z = (x += static_cast<uint64_t>(0x9E3779B97F4A7C15));
@@ -20,6 +20,12 @@ class SplitMix64 {
     return z ^ (z >> 31);
   }
 
+  uint64_t GetState() const { return x; }
+
+  void Advance(uint64_t delta) {
+    x += delta * static_cast<uint64_t>(0x9E3779B97F4A7C15);
+  }
+
   static const size_t STATE_SIZE = 1;
 };
 
@@ -33,7 +39,9 @@ class Xoroshiro128 {
   }
 
  public:
-  explicit Xoroshiro128(std::array<uint64_t, 2> &seed) : s(seed) {}
+  explicit Xoroshiro128(const std::array<uint64_t, 2> &seed) : s(seed) {}
+
+  const std::array<uint64_t, 2> &GetState() const { return s; }
 
   template <typename T>
   static Xoroshiro128 SeedFromRng(T &rng) {
@@ -83,7 +91,9 @@ class Xorshift128 {
   std::array<uint64_t, 2> s;
 
  public:
-  explicit Xorshift128(std::array<uint64_t, 2> &seed) : s(seed) {}
+  explicit Xorshift128(const std::array<uint64_t, 2> &seed) : s(seed) {}
+
+  const std::array<uint64_t, 2> &GetState() const { return s; }
 
   template <typename T>
   static Xorshift128 SeedFromRng(T &rng) {